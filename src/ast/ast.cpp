@@ -30,7 +30,11 @@ Revision History:
 #include "ast/arith_decl_plugin.h"
 #include "ast/ast_translation.h"
 #include "util/z3_version.h"
+#include "util/mutex.h"
 #include <iostream>
+#ifndef SINGLE_THREAD
+#include <mutex>
+#endif
 
 
 // -----------------------------------
@@ -1366,6 +1370,7 @@ static void mark_array_ref(ast_mark& mark, unsigned sz, parameter const * a) {
 
 ast_manager::~ast_manager() {
     SASSERT(is_format_manager() || !m_family_manager.has_family(symbol("format")));
+    set_concurrent(false);
 
     dec_ref(m_bool_sort);
     dec_ref(m_proof_sort);
@@ -1449,6 +1454,7 @@ ast_manager::~ast_manager() {
 }
 
 void ast_manager::compact_memory() {
+    SASSERT(!m_concurrent);
     m_alloc.consolidate();
     unsigned capacity = m_ast_table.capacity();
     if (capacity > 4*m_ast_table.size()) {
@@ -1465,6 +1471,7 @@ void ast_manager::compact_memory() {
 }
 
 void ast_manager::compress_ids() {
+    SASSERT(!m_concurrent);
     ptr_vector<ast> asts;
     m_expr_id_gen.cleanup();
     m_decl_id_gen.cleanup(c_first_decl_id);
@@ -1682,6 +1689,8 @@ static void track_id(ast_manager& m, ast* n, unsigned id) {
 ast * ast_manager::register_node_core(ast * n) {
     unsigned h = get_node_hash(n);
     n->m_hash = h;
+    if (m_concurrent)
+        return register_node_concurrent(n);
 #ifdef Z3DEBUG
     bool contains = m_ast_table.contains(n);
     CASSERT("nondet_bug", contains || slow_not_contains(n));
@@ -1713,7 +1722,15 @@ ast * ast_manager::register_node_core(ast * n) {
     
 //    TRACE("ast", tout << (s_count++) << " Object " << n->m_id << " was created.\n";);
     TRACE("mk_var_bug", tout << "mk_ast: " << n->m_id << "\n";);
-    // increment reference counters
+    init_node(n);
+    return n;
+}
+
+/**
+   \brief Initialize a node that was just inserted in the table:
+   increment the reference counters of its children and compute its flags.
+*/
+void ast_manager::init_node(ast * n) {
     switch (n->get_kind()) {
     case AST_SORT:
         if (to_sort(n)->m_info != nullptr) {
@@ -1793,9 +1810,156 @@ ast * ast_manager::register_node_core(ast * n) {
     default:
         break;
     }
+}
+
+#ifdef SINGLE_THREAD
+
+struct ast_manager::concurrent_state {};
+
+void ast_manager::set_concurrent(bool flag) {}
+ast * ast_manager::register_node_concurrent(ast * n) { UNREACHABLE(); return n; }
+bool ast_manager::concurrent_contains(ast * n) const { return false; }
+unsigned ast_manager::concurrent_num_asts() const { return 0; }
+void ast_manager::defer_delete(ast * n) { UNREACHABLE(); }
+void * ast_manager::allocate_node_concurrent(unsigned size) { UNREACHABLE(); return nullptr; }
+void ast_manager::deallocate_node_concurrent(ast * n, unsigned sz) { UNREACHABLE(); }
+
+#else
+
+struct ast_manager::concurrent_state {
+    static const unsigned c_num_shards = 64;
+    struct shard {
+        mutable mutex m_mux;
+        ast_table     m_table;
+        shard(): m_table(4 * 1024, 256) {}
+    };
+    shard                m_shards[c_num_shards];
+    mutex                m_alloc_mux;     // allocator and id generators
+    std::recursive_mutex m_plugin_mux;    // decl plugins and fresh ids
+    mutex                m_deferred_mux;
+    ptr_vector<ast>      m_deferred;      // nodes whose reference count dropped to zero
+
+    // chashtable uses the low bits of the hash, use the high bits for the shard.
+    shard & get_shard(unsigned h) { return m_shards[(h * 0x9E3779B1u) >> 26]; }
+    shard const & get_shard(unsigned h) const { return m_shards[(h * 0x9E3779B1u) >> 26]; }
+};
+
+void ast_manager::set_concurrent(bool flag) {
+    if (flag) {
+        if (!m_concurrent)
+            m_concurrent = alloc(concurrent_state);
+        return;
+    }
+    if (!m_concurrent)
+        return;
+    concurrent_state * cs = m_concurrent;
+    m_concurrent = nullptr;
+    for (auto & sh : cs->m_shards)
+        for (ast * n : sh.m_table)
+            m_ast_table.insert(n);
+    // Nodes may have been revived after their count dropped to zero, or be listed more than once.
+    // Pin the dead ones first, so that deleting one of them does not free another one that is still listed.
+    ptr_addr_hashtable<ast> seen;
+    ptr_vector<ast> dead;
+    for (ast * n : cs->m_deferred) {
+        if (n->get_ref_count() == 0 && !seen.contains(n)) {
+            seen.insert(n);
+            dead.push_back(n);
+        }
+    }
+    dealloc(cs);
+    for (ast * n : dead)
+        n->inc_ref();
+    for (ast * n : dead)
+        dec_ref(n);
+}
+
+ast * ast_manager::register_node_concurrent(ast * n) {
+    concurrent_state & cs = *m_concurrent;
+    auto check_range = [&](ast * r) {
+        if (is_func_decl(r) && to_func_decl(r)->get_range() != to_func_decl(n)->get_range()) {
+            std::ostringstream buffer;
+            buffer << "Recycling of declaration for the same name '" << to_func_decl(r)->get_name().str()
+                   << "' and domain, but different range type is not permitted";
+            throw ast_exception(buffer.str());
+        }
+    };
+    // the main table is not modified in concurrent mode
+    ast * const * e = m_ast_table.find_core(n);
+    if (e) {
+        check_range(*e);
+        deallocate_node(n, ::get_node_size(n));
+        return *e;
+    }
+    auto & sh = cs.get_shard(n->m_hash);
+    lock_guard lock(sh.m_mux);
+    ast * r = sh.m_table.insert_if_not_there(n);
+    if (r != n) {
+        check_range(r);
+        deallocate_node(n, ::get_node_size(n));
+        return r;
+    }
+    {
+        lock_guard lock2(cs.m_alloc_mux);
+        n->m_id = is_decl(n) ? m_decl_id_gen.mk() : m_expr_id_gen.mk();
+    }
+    // other threads find n in the shard only after it is initialized
+    init_node(n);
     return n;
 }
 
+bool ast_manager::concurrent_contains(ast * n) const {
+    auto const & sh = m_concurrent->get_shard(n->hash());
+    lock_guard lock(sh.m_mux);
+    return sh.m_table.contains(n);
+}
+
+unsigned ast_manager::concurrent_num_asts() const {
+    unsigned r = 0;
+    for (auto const & sh : m_concurrent->m_shards) {
+        lock_guard lock(sh.m_mux);
+        r += sh.m_table.size();
+    }
+    return r;
+}
+
+void ast_manager::defer_delete(ast * n) {
+    lock_guard lock(m_concurrent->m_deferred_mux);
+    m_concurrent->m_deferred.push_back(n);
+}
+
+void * ast_manager::allocate_node_concurrent(unsigned size) {
+    lock_guard lock(m_concurrent->m_alloc_mux);
+    return m_alloc.allocate(size);
+}
+
+void ast_manager::deallocate_node_concurrent(ast * n, unsigned sz) {
+    lock_guard lock(m_concurrent->m_alloc_mux);
+    m_alloc.deallocate(sz, n);
+}
+
+#endif
+
+/**
+   \brief Serialize calls into decl plugins and updates of the fresh id
+   when the manager is in concurrent mode.
+*/
+struct ast_manager::plugin_lock {
+#ifndef SINGLE_THREAD
+    std::recursive_mutex * m_mux;
+    plugin_lock(ast_manager & m): m_mux(m.m_concurrent ? &m.m_concurrent->m_plugin_mux : nullptr) {
+        if (m_mux)
+            m_mux->lock();
+    }
+    ~plugin_lock() {
+        if (m_mux)
+            m_mux->unlock();
+    }
+#else
+    plugin_lock(ast_manager & m) {}
+#endif
+};
+
 
 void ast_manager::delete_node(ast * n) {
     TRACE("delete_node_bug", tout << mk_ll_pp(n, *this) << "\n";);
@@ -1875,6 +2039,7 @@ void ast_manager::delete_node(ast * n) {
 
 sort * ast_manager::mk_sort(family_id fid, decl_kind k, unsigned num_parameters, parameter const * parameters) {
     decl_plugin * p = get_plugin(fid);
+    plugin_lock lock(*this);
     if (p)
         return p->mk_sort(k, num_parameters, parameters);
     return nullptr;
@@ -1883,6 +2048,7 @@ sort * ast_manager::mk_sort(family_id fid, decl_kind k, unsigned num_parameters,
 func_decl * ast_manager::mk_func_decl(family_id fid, decl_kind k, unsigned num_parameters, parameter const * parameters,
                                       unsigned arity, sort * const * domain, sort * range) {
     decl_plugin * p = get_plugin(fid);
+    plugin_lock lock(*this);
     if (p)
         return p->mk_func_decl(k, num_parameters, parameters, arity, domain, range);
     return nullptr;
@@ -1891,6 +2057,7 @@ func_decl * ast_manager::mk_func_decl(family_id fid, decl_kind k, unsigned num_p
 func_decl * ast_manager::mk_func_decl(family_id fid, decl_kind k, unsigned num_parameters, parameter const * parameters,
                                       unsigned num_args, expr * const * args, sort * range) {
     decl_plugin * p = get_plugin(fid);
+    plugin_lock lock(*this);
     if (p)
         return p->mk_func_decl(k, num_parameters, parameters, num_args, args, range);
     return nullptr;
@@ -2272,6 +2439,7 @@ func_decl * ast_manager::mk_fresh_func_decl(symbol const & prefix, symbol const
     SASSERT(skolem == info.is_skolem());
     func_decl_info* infop = skolem ? &info : nullptr;
     func_decl * d;
+    plugin_lock lock(*this);
     if (prefix == symbol::null && suffix == symbol::null) {
         d = mk_func_decl(symbol(m_fresh_id), arity, domain, range, infop);
     }
@@ -2303,6 +2471,7 @@ bool ast_manager::is_parametric_function(func_decl* f, func_decl *& g) const {
 
 sort * ast_manager::mk_fresh_sort(char const * prefix) {
     string_buffer<32> buffer;
+    plugin_lock lock(*this);
     buffer << prefix << "!" << m_fresh_id;
     m_fresh_id++;
     return mk_uninterpreted_sort(symbol(buffer.c_str()));
@@ -2310,6 +2479,7 @@ sort * ast_manager::mk_fresh_sort(char const * prefix) {
 
 symbol ast_manager::mk_fresh_var_name(char const * prefix) {
     string_buffer<32> buffer;
+    plugin_lock lock(*this);
     buffer << (prefix ? prefix : "var") << "!" << m_fresh_id;
     m_fresh_id++;
     return symbol(buffer.c_str());
@@ -48,6 +48,7 @@ Revision History:
 #include "util/dependency.h"
 #include "util/rlimit.h"
 #include <variant>
+#include <atomic>
 
 #define RECYCLE_FREE_AST_INDICES
 
@@ -497,6 +498,20 @@ protected:
         --m_ref_count;
     }
 
+    // reference counting for managers in concurrent mode
+    std::atomic<unsigned> & atomic_ref_count() {
+        static_assert(sizeof(std::atomic<unsigned>) == sizeof(unsigned), "atomic reference count must overlay m_ref_count");
+        return *reinterpret_cast<std::atomic<unsigned>*>(&m_ref_count);
+    }
+
+    void inc_ref_atomic() {
+        atomic_ref_count().fetch_add(1, std::memory_order_relaxed);
+    }
+
+    unsigned dec_ref_atomic() {
+        return atomic_ref_count().fetch_sub(1, std::memory_order_acq_rel) - 1;
+    }
+
     ast(ast_kind k):m_id(UINT_MAX), m_kind(k), m_mark1(false), m_mark2(false), m_mark_shared_occs(false), m_ref_count(0) {
         DEBUG_CODE({
             m_mark1_owner = 0;
@@ -982,7 +997,7 @@ class ast_translation;
 
 class ast_table : public chashtable<ast*, obj_ptr_hash<ast>, ast_eq_proc> {
 public:
-    ast_table() : chashtable({}, {}, 512 * 1024, 8 * 1024) {}
+    ast_table(unsigned init_slots = 512 * 1024, unsigned init_cellar = 8 * 1024) : chashtable({}, {}, init_slots, init_cellar) {}
     void push_erase(ast * n);
     ast* pop_erase();
 };
@@ -1517,6 +1532,8 @@ protected:
     bool slow_not_contains(ast const * n);
 #endif
     ast_manager *             m_format_manager; // hack for isolating format objects in a different manager.
+    struct concurrent_state;
+    concurrent_state *        m_concurrent = nullptr; // set in concurrent mode, see set_concurrent
     symbol                    m_lambda_def = symbol(":lambda-def");
     obj_map<func_decl, func_decl*> m_poly_roots;
 
@@ -1628,7 +1645,30 @@ public:
 
     bool are_distinct(expr * a, expr * b) const;
 
-    bool contains(ast * a) const { return m_ast_table.contains(a); }
+    bool contains(ast * a) const { return m_ast_table.contains(a) || (m_concurrent && concurrent_contains(a)); }
+
+    /**
+       \brief Enter (flag = true) or leave (flag = false) the concurrent mode.
+
+       In concurrent mode several threads may create terms in this manager and
+       update reference counts at the same time, so they can share one term DAG
+       instead of translating terms into private managers:
+
+       - terms created before entering the mode are looked up without locking;
+       - new terms are hash-consed into a sharded table, one lock per shard;
+       - reference counts are updated atomically;
+       - terms whose reference count drops to zero are only reclaimed when the
+         mode is left, because another thread may still find them in the table;
+       - calls into decl plugins through the manager are serialized.
+
+       Helper classes that update the caches of a decl plugin directly are not
+       synchronized, and neither are marks, the dependency and array managers,
+       or trace streams. The mode must be switched when no other thread uses
+       the manager. It is not available in single threaded builds.
+    */
+    void set_concurrent(bool flag);
+
+    bool is_concurrent() const { return m_concurrent != nullptr; }
     
     bool is_lambda_def(quantifier* q) const { return q->get_qid() == m_lambda_def; }
     void add_lambda_def(func_decl* f, quantifier* q);
@@ -1638,20 +1678,30 @@ public:
 
     symbol const& lambda_def_qid() const { return m_lambda_def; }
 
-    unsigned get_num_asts() const { return m_ast_table.size(); }
+    unsigned get_num_asts() const { return m_ast_table.size() + (m_concurrent ? concurrent_num_asts() : 0); }
 
     void debug_ref_count() { m_debug_ref_count = true; }
 
     void inc_ref(ast* n) {
-        if (n) 
-            n->inc_ref();
+        if (n) {
+            if (m_concurrent)
+                n->inc_ref_atomic();
+            else
+                n->inc_ref();
+        }
     }
     
     void dec_ref(ast* n) {
         if (n) {
-            n->dec_ref();
-            if (n->get_ref_count() == 0)
-                delete_node(n);
+            if (m_concurrent) {
+                if (n->dec_ref_atomic() == 0)
+                    defer_delete(n);
+            }
+            else {
+                n->dec_ref();
+                if (n->get_ref_count() == 0)
+                    delete_node(n);
+            }
         }
     }
 
@@ -1679,6 +1729,14 @@ public:
 
 protected:
     ast * register_node_core(ast * n);
+    ast * register_node_concurrent(ast * n);
+    void init_node(ast * n);
+    bool concurrent_contains(ast * n) const;
+    unsigned concurrent_num_asts() const;
+    void defer_delete(ast * n);
+    void * allocate_node_concurrent(unsigned size);
+    struct plugin_lock;
+    void deallocate_node_concurrent(ast * n, unsigned sz);
 
     template<typename T>
     T * register_node(T * n) {
@@ -1688,11 +1746,16 @@ protected:
     void delete_node(ast * n);
 
     void * allocate_node(unsigned size) {
+        if (m_concurrent)
+            return allocate_node_concurrent(size);
         return m_alloc.allocate(size);
     }
 
     void deallocate_node(ast * n, unsigned sz) {
-        m_alloc.deallocate(sz, n);
+        if (m_concurrent)
+            deallocate_node_concurrent(n, sz);
+        else
+            m_alloc.deallocate(sz, n);
     }
 
 public:
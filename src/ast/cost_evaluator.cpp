@@ -98,3 +98,210 @@ float cost_evaluator::operator()(expr * f, unsigned num_args, float const * args
 
 
 
+compiled_cost::compiled_cost(ast_manager & m):
+    m(m),
+    m_util(m) {
+}
+
+float compiled_cost::num_value(expr * f) const {
+    rational r = to_app(f)->get_decl()->get_parameter(0).get_rational();
+    return static_cast<float>(numerator(r).get_int64())/static_cast<float>(denominator(r).get_int64());
+}
+
+/**
+   \brief accumulate coeff * f into m_const and m_coeffs.
+   Return false if f is not an affine function of the arguments.
+   As in cost_evaluator, only the first two arguments of + and * are used.
+*/
+bool compiled_cost::linearize(expr * f, float coeff) {
+    if (is_var(f)) {
+        unsigned idx = to_var(f)->get_idx();
+        for (auto & [v, c] : m_coeffs) {
+            if (v == idx) {
+                c += coeff;
+                return true;
+            }
+        }
+        m_coeffs.push_back({ idx, coeff });
+        return true;
+    }
+    if (!is_app(f) || to_app(f)->get_family_id() != m_util.get_family_id())
+        return false;
+    app * a = to_app(f);
+    switch (a->get_decl_kind()) {
+    case OP_NUM:
+        m_const += coeff * num_value(f);
+        return true;
+    case OP_ADD:
+        return a->get_num_args() >= 2 && linearize(a->get_arg(0), coeff) && linearize(a->get_arg(1), coeff);
+    case OP_SUB:
+        return a->get_num_args() >= 2 && linearize(a->get_arg(0), coeff) && linearize(a->get_arg(1), -coeff);
+    case OP_UMINUS:
+        return a->get_num_args() >= 1 && linearize(a->get_arg(0), -coeff);
+    case OP_MUL:
+        if (a->get_num_args() < 2)
+            return false;
+        if (m_util.is_numeral(a->get_arg(0)))
+            return linearize(a->get_arg(1), coeff * num_value(a->get_arg(0)));
+        if (m_util.is_numeral(a->get_arg(1)))
+            return linearize(a->get_arg(0), coeff * num_value(a->get_arg(1)));
+        return false;
+    default:
+        return false;
+    }
+}
+
+void compiled_cost::compile_core(expr * f) {
+#define ARGS(N) if (to_app(f)->get_num_args() < N) break; for (unsigned i = 0; i < N; ++i) compile_core(to_app(f)->get_arg(i))
+    if (is_var(f)) {
+        emit(CC_VAR, to_var(f)->get_idx());
+        return;
+    }
+    if (is_app(f)) {
+        app * a = to_app(f);
+        family_id fid = a->get_family_id();
+        if (fid == m.get_basic_family_id()) {
+            switch (a->get_decl_kind()) {
+            case OP_TRUE:    emit(CC_CONST, 0, 1.0f); return;
+            case OP_FALSE:   emit(CC_CONST, 0, 0.0f); return;
+            case OP_NOT:     ARGS(1); emit(CC_NOT); return;
+            case OP_AND:
+                for (expr * arg : *a)
+                    compile_core(arg);
+                emit(CC_AND, a->get_num_args());
+                return;
+            case OP_OR:
+                for (expr * arg : *a)
+                    compile_core(arg);
+                emit(CC_OR, a->get_num_args());
+                return;
+            case OP_ITE:     ARGS(3); emit(CC_ITE); return;
+            case OP_EQ:      ARGS(2); emit(CC_EQ); return;
+            case OP_XOR:     ARGS(2); emit(CC_XOR); return;
+            case OP_IMPLIES: ARGS(2); emit(CC_IMPLIES); return;
+            default:
+                break;
+            }
+        }
+        else if (fid == m_util.get_family_id()) {
+            switch (a->get_decl_kind()) {
+            case OP_NUM:     emit(CC_CONST, 0, num_value(f)); return;
+            case OP_LE:      ARGS(2); emit(CC_LE); return;
+            case OP_GE:      ARGS(2); emit(CC_GE); return;
+            case OP_LT:      ARGS(2); emit(CC_LT); return;
+            case OP_GT:      ARGS(2); emit(CC_GT); return;
+            case OP_ADD:     ARGS(2); emit(CC_ADD); return;
+            case OP_SUB:     ARGS(2); emit(CC_SUB); return;
+            case OP_UMINUS:  ARGS(1); emit(CC_UMINUS); return;
+            case OP_MUL:     ARGS(2); emit(CC_MUL); return;
+            case OP_DIV:     ARGS(2); emit(CC_DIV); return;
+            default:
+                break;
+            }
+        }
+    }
+#undef ARGS
+    emit(CC_ERROR);
+}
+
+void compiled_cost::compile(expr * f) {
+    m_code.reset();
+    m_coeffs.reset();
+    m_const = 0.0f;
+    m_affine = linearize(f, 1.0f);
+    if (m_affine)
+        return;
+    m_coeffs.reset();
+    m_const = 0.0f;
+    compile_core(f);
+}
+
+float compiled_cost::operator()(unsigned num_args, float const * args) const {
+    if (m_affine) {
+        float r = m_const;
+        for (auto const& [v, c] : m_coeffs) {
+            if (v >= num_args) {
+                warning_msg("cost function evaluation error");
+                r += c;
+            }
+            else
+                r += c * args[num_args - v - 1];
+        }
+        return r;
+    }
+    m_stack.reset();
+#define POP(X) float X = m_stack.back(); m_stack.pop_back()
+#define BIN(EXPR) { POP(b); POP(a); m_stack.push_back(EXPR); break; }
+    for (instr const& i : m_code) {
+        switch (i.m_op) {
+        case CC_CONST:
+            m_stack.push_back(i.m_val);
+            break;
+        case CC_VAR:
+            if (i.m_arg < num_args)
+                m_stack.push_back(args[num_args - i.m_arg - 1]);
+            else {
+                warning_msg("cost function evaluation error");
+                m_stack.push_back(1.0f);
+            }
+            break;
+        case CC_NOT: {
+            POP(a);
+            m_stack.push_back(a == 0.0f ? 1.0f : 0.0f);
+            break;
+        }
+        case CC_AND:
+        case CC_OR: {
+            bool is_and = i.m_op == CC_AND;
+            float r = is_and ? 1.0f : 0.0f;
+            for (unsigned k = 0; k < i.m_arg; ++k) {
+                POP(a);
+                if (is_and && a == 0.0f)
+                    r = 0.0f;
+                if (!is_and && a != 0.0f)
+                    r = 1.0f;
+            }
+            m_stack.push_back(r);
+            break;
+        }
+        case CC_ITE: {
+            POP(e); POP(t); POP(c);
+            m_stack.push_back(c != 0.0f ? t : e);
+            break;
+        }
+        case CC_EQ:      BIN(a == b ? 1.0f : 0.0f);
+        case CC_XOR:     BIN(a != b ? 1.0f : 0.0f);
+        case CC_IMPLIES: BIN(a == 0.0f || b != 0.0f ? 1.0f : 0.0f);
+        case CC_LE:      BIN(a <= b ? 1.0f : 0.0f);
+        case CC_GE:      BIN(a >= b ? 1.0f : 0.0f);
+        case CC_LT:      BIN(a < b ? 1.0f : 0.0f);
+        case CC_GT:      BIN(a > b ? 1.0f : 0.0f);
+        case CC_ADD:     BIN(a + b);
+        case CC_SUB:     BIN(a - b);
+        case CC_MUL:     BIN(a * b);
+        case CC_UMINUS: {
+            POP(a);
+            m_stack.push_back(-a);
+            break;
+        }
+        case CC_DIV: {
+            POP(b); POP(a);
+            if (b == 0.0f) {
+                warning_msg("cost function division by zero");
+                m_stack.push_back(1.0f);
+            }
+            else
+                m_stack.push_back(a / b);
+            break;
+        }
+        case CC_ERROR:
+            warning_msg("cost function evaluation error");
+            m_stack.push_back(1.0f);
+            break;
+        }
+    }
+#undef BIN
+#undef POP
+    SASSERT(m_stack.size() == 1);
+    return m_stack.back();
+}
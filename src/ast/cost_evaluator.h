@@ -38,4 +38,43 @@ public:
     float operator()(expr * f, unsigned num_args, float const * args);
 };
 
+/**
+   \brief Cost function compiled into a sequence of stack instructions.
+   It computes the same values as cost_evaluator without traversing the
+   expression, and it evaluates all arguments of Boolean connectives.
+   Affine functions of the arguments, such as the default
+   (+ weight generation), are evaluated as a weighted sum.
+*/
+class compiled_cost {
+    enum opcode : unsigned char {
+        CC_CONST, CC_VAR, CC_NOT, CC_AND, CC_OR, CC_ITE, CC_EQ, CC_XOR, CC_IMPLIES,
+        CC_LE, CC_GE, CC_LT, CC_GT, CC_ADD, CC_SUB, CC_UMINUS, CC_MUL, CC_DIV, CC_ERROR
+    };
+    struct instr {
+        opcode   m_op;
+        unsigned m_arg;  // variable index, or number of arguments of CC_AND and CC_OR
+        float    m_val;
+    };
+    ast_manager &        m;
+    arith_util           m_util;
+    svector<instr>       m_code;
+    bool                 m_affine = false;
+    float                m_const = 0.0f;
+    svector<std::pair<unsigned, float>> m_coeffs; // (variable index, coefficient)
+    mutable svector<float> m_stack;
+
+    void emit(opcode op, unsigned arg = 0, float val = 0.0f) { m_code.push_back({ op, arg, val }); }
+    void compile_core(expr * f);
+    bool linearize(expr * f, float coeff);
+    float num_value(expr * f) const;
+public:
+    compiled_cost(ast_manager & m);
+    void compile(expr * f);
+    bool is_affine() const { return m_affine; }
+    /**
+       \brief evaluate the compiled function, with the arguments stored as in cost_evaluator.
+    */
+    float operator()(unsigned num_args, float const * args) const;
+};
+
 
@@ -42,6 +42,9 @@ namespace q {
         unsigned m_num_instances_curr_branch; //!< only updated if QI_TRACK_INSTANCES is true
         unsigned m_max_generation; //!< max. generation of an instance
         float    m_max_cost;
+        unsigned m_num_match_attempts; //!< number of candidates run through code trees with a pattern of the quantifier.
+        unsigned m_num_matches;
+        double   m_match_time;         //!< seconds spent in code trees with a pattern of the quantifier.
 
         friend class quantifier_stat_gen;
 
@@ -124,6 +127,27 @@ namespace q {
         float get_max_cost() const {
             return m_max_cost;
         }
+
+        void update_match_profile(unsigned num_attempts, double seconds) {
+            m_num_match_attempts += num_attempts;
+            m_match_time += seconds;
+        }
+
+        void inc_num_matches() {
+            m_num_matches++;
+        }
+
+        unsigned get_num_match_attempts() const {
+            return m_num_match_attempts;
+        }
+
+        unsigned get_num_matches() const {
+            return m_num_matches;
+        }
+
+        double get_match_time() const {
+            return m_match_time;
+        }
     };
 
     /**
@@ -16,6 +16,7 @@ Notes:
 #include "math/simplex/bit_matrix.h"
 #include "util/stopwatch.h"
 #include "util/trace.h"
+#include "util/bit_util.h"
 #include <cstring>
 
 
@@ -43,6 +44,18 @@ bool bit_matrix::row::operator[](unsigned i) const {
 }
 
 
+unsigned bit_matrix::row::first() const {
+    for (unsigned i = 0; i < m.m_num_chunks; ++i) {
+        uint64_t w = r[i];
+        if (w == 0)
+            continue;
+        unsigned lo = static_cast<unsigned>(w);
+        unsigned col = 64 * i + (lo != 0 ? ntz_core(lo) : 32 + ntz_core(static_cast<unsigned>(w >> 32)));
+        return std::min(col, m.m_num_columns);
+    }
+    return m.m_num_columns;
+}
+
 std::ostream& bit_matrix::row::display(std::ostream& out) const {
     for (unsigned i = 0; i < m.m_num_columns; ++i) {
         out << ((*this)[i]?"1":"0");
@@ -85,16 +98,25 @@ void bit_matrix::solve() {
     basic_solve();
 }
 
+/**
+   Gauss-Jordan elimination. The pivot c of a row is its first column,
+   so the row has no bits in the words before the word of c and
+   other rows only need to be updated from that word onwards.
+*/
 void bit_matrix::basic_solve() {
     report _report(*this);
     for (row& r : *this) {
-        auto ci = r.begin();
-        if (ci != r.end()) {
-            unsigned c = *ci;
-            for (row& r2 : *this) {
-                if (r2 != r && r2[c]) r2 += r;
-            }
-        }        
+        unsigned c = r.first();
+        if (c == m_num_columns) 
+            continue;
+        unsigned chunk = c >> 6;
+        uint64_t bit = 1ull << static_cast<uint64_t>(c & 63);
+        for (uint64_t* r2 : m_rows) {
+            if (r2 == r.r || !(r2[chunk] & bit))
+                continue;
+            for (unsigned i = chunk; i < m_num_chunks; ++i) 
+                r2[i] ^= r.r[i];
+        }
     }
 }
 
@@ -16,7 +16,8 @@ Author:
 Notes:
 
     Exposes Gauss-Jordan simplification.
-    Uses extremely basic implementation, can be tuned by 4R method.
+    Rows are eliminated a 64-bit word at a time, starting at the word
+    of the pivot column. Can be tuned further by the 4R method.
 
 --*/
 
@@ -53,6 +54,12 @@ public:
         void unset(unsigned i) { SASSERT((i >> 6) < m.m_num_chunks); r[i >> 6] &= ~(1ull << (i & 63)); }
         row& operator+=(row const& other);
 
+        /**
+           \brief first column with a bit set, num_columns() if the row is zero.
+        */
+        unsigned first() const;
+        bool is_zero() const { return first() == m.m_num_columns; }
+
         // using pointer equality:
         bool operator==(row const& other) const { return r == other.r; }
         bool operator!=(row const& other) const { return r != other.r; }
@@ -93,6 +100,8 @@ public:
     };
 
     void reset(unsigned num_columns);
+    unsigned num_columns() const { return m_num_columns; }
+    unsigned num_rows() const { return m_rows.size(); }
     
     row_iterator begin() { return row_iterator(*this, true); }
     row_iterator end() { return row_iterator(*this, false); }
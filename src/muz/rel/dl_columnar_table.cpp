@@ -0,0 +1,461 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    dl_columnar_table.cpp
+
+Abstract:
+
+    Column oriented table.
+
+--*/
+
+#include <algorithm>
+#include "muz/base/dl_util.h"
+#include "muz/rel/dl_columnar_table.h"
+#include "muz/rel/dl_relation_manager.h"
+
+namespace datalog {
+
+    // -----------------------------------
+    //
+    // columnar_table
+    //
+    // -----------------------------------
+
+    columnar_table::columnar_table(columnar_table_plugin & plugin, const table_signature & sig)
+        : table_base(plugin, sig) {
+        SASSERT(plugin.can_handle_signature(sig));
+        m_columns.resize(sig.size());
+        m_sorted.resize(sig.size());
+        m_sorted_valid.resize(sig.size(), false);
+        m_slots.resize(8, NO_ROW);
+    }
+
+    unsigned columnar_table::fact_hash(const table_element * f) const {
+        unsigned h = 17;
+        for (unsigned c = 0; c < num_cols(); ++c)
+            h = combine(h, f[c]);
+        return h;
+    }
+
+    bool columnar_table::row_eq(unsigned r, const table_element * f) const {
+        for (unsigned c = 0; c < num_cols(); ++c)
+            if (m_columns[c][r] != f[c])
+                return false;
+        return true;
+    }
+
+    unsigned columnar_table::find_slot(const table_element * f) const {
+        unsigned mask = m_slots.size() - 1;
+        unsigned h = fact_hash(f);
+        for (unsigned s = h & mask; m_slots[s] != NO_ROW; s = (s + 1) & mask) {
+            unsigned r = m_slots[s];
+            if (m_hashes[r] == h && row_eq(r, f))
+                return s;
+        }
+        return UINT_MAX;
+    }
+
+    void columnar_table::insert_slot(unsigned r, unsigned h) {
+        unsigned mask = m_slots.size() - 1;
+        unsigned s = h & mask;
+        while (m_slots[s] != NO_ROW)
+            s = (s + 1) & mask;
+        m_slots[s] = r;
+    }
+
+    /**
+       \brief Free slot \c s, moving later entries of the probe sequence
+       back so that lookups need no tombstones.
+    */
+    void columnar_table::erase_slot(unsigned s) {
+        unsigned mask = m_slots.size() - 1;
+        unsigned i = s;
+        for (unsigned j = (i + 1) & mask; m_slots[j] != NO_ROW; j = (j + 1) & mask) {
+            unsigned home = m_hashes[m_slots[j]] & mask;
+            bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+            if (stays)
+                continue;
+            m_slots[i] = m_slots[j];
+            i = j;
+        }
+        m_slots[i] = NO_ROW;
+    }
+
+    void columnar_table::grow_slots() {
+        m_slots.reset();
+        m_slots.resize(2 * std::max(8u, next_power_of_two(m_num_rows + 1)), NO_ROW);
+        for (unsigned r = 0; r < m_num_rows; ++r)
+            insert_slot(r, m_hashes[r]);
+    }
+
+    void columnar_table::invalidate_indexes() {
+        for (unsigned c = 0; c < num_cols(); ++c)
+            m_sorted_valid[c] = false;
+    }
+
+    void columnar_table::get_row(unsigned r, table_element * f) const {
+        for (unsigned c = 0; c < num_cols(); ++c)
+            f[c] = m_columns[c][r];
+    }
+
+    bool columnar_table::add_row(const table_element * f) {
+        if (2 * (m_num_rows + 1) > m_slots.size())
+            grow_slots();
+        unsigned mask = m_slots.size() - 1;
+        unsigned h = fact_hash(f);
+        unsigned s = h & mask;
+        for (; m_slots[s] != NO_ROW; s = (s + 1) & mask) {
+            unsigned r = m_slots[s];
+            if (m_hashes[r] == h && row_eq(r, f))
+                return false;
+        }
+        m_slots[s] = m_num_rows++;
+        m_hashes.push_back(h);
+        for (unsigned c = 0; c < num_cols(); ++c)
+            m_columns[c].push_back(f[c]);
+        invalidate_indexes();
+        return true;
+    }
+
+    void columnar_table::remove_fact(const table_element * fact) {
+        unsigned s = find_slot(fact);
+        if (s == UINT_MAX)
+            return;
+        unsigned r = m_slots[s];
+        erase_slot(s);
+        unsigned last = m_num_rows - 1;
+        if (r != last) {
+            // move the last row into the freed position
+            unsigned mask = m_slots.size() - 1;
+            unsigned t = m_hashes[last] & mask;
+            while (m_slots[t] != last)
+                t = (t + 1) & mask;
+            m_slots[t] = r;
+            m_hashes[r] = m_hashes[last];
+            for (unsigned c = 0; c < num_cols(); ++c)
+                m_columns[c][r] = m_columns[c][last];
+        }
+        m_hashes.pop_back();
+        for (unsigned c = 0; c < num_cols(); ++c)
+            m_columns[c].pop_back();
+        --m_num_rows;
+        invalidate_indexes();
+    }
+
+    bool columnar_table::contains_fact(const table_fact & f) const {
+        SASSERT(f.size() == num_cols());
+        return find_slot(f.data()) != UINT_MAX;
+    }
+
+    void columnar_table::reset() {
+        for (unsigned c = 0; c < num_cols(); ++c)
+            m_columns[c].reset();
+        m_hashes.reset();
+        m_num_rows = 0;
+        m_slots.reset();
+        m_slots.resize(8, NO_ROW);
+        invalidate_indexes();
+    }
+
+    table_base * columnar_table::clone() const {
+        columnar_table * res = get_plugin().get(get_plugin().mk_empty(get_signature()));
+        res->m_columns = m_columns;
+        res->m_hashes = m_hashes;
+        res->m_slots = m_slots;
+        res->m_num_rows = m_num_rows;
+        return res;
+    }
+
+    unsigned_vector const & columnar_table::get_sorted(unsigned col) const {
+        unsigned_vector & rows = m_sorted[col];
+        if (!m_sorted_valid[col]) {
+            rows.reset();
+            for (unsigned r = 0; r < m_num_rows; ++r)
+                rows.push_back(r);
+            column const & vals = m_columns[col];
+            std::sort(rows.begin(), rows.end(), [&](unsigned a, unsigned b) { return vals[a] < vals[b]; });
+            m_sorted_valid[col] = true;
+        }
+        return rows;
+    }
+
+    unsigned columnar_table::get_size_estimate_bytes() const {
+        unsigned sz = m_num_rows * (num_cols() * sizeof(table_element) + sizeof(unsigned));
+        sz += m_slots.size() * sizeof(unsigned);
+        return sz;
+    }
+
+    class columnar_table::our_iterator_core : public iterator_core {
+        const columnar_table & m_parent;
+        unsigned m_row;
+
+        class our_row : public row_interface {
+            const our_iterator_core & m_parent;
+        public:
+            our_row(const our_iterator_core & parent) : row_interface(parent.m_parent), m_parent(parent) {}
+
+            void get_fact(table_fact & result) const override {
+                result.resize(size());
+                m_parent.m_parent.get_row(m_parent.m_row, result.data());
+            }
+            table_element operator[](unsigned col) const override {
+                return m_parent.m_parent.get(m_parent.m_row, col);
+            }
+        };
+
+        our_row m_row_obj;
+
+    public:
+        our_iterator_core(const columnar_table & t, bool finished) :
+            m_parent(t), m_row(finished ? t.m_num_rows : 0), m_row_obj(*this) {}
+
+        bool is_finished() const override {
+            return m_row == m_parent.m_num_rows;
+        }
+
+        row_interface & operator*() override {
+            SASSERT(!is_finished());
+            return m_row_obj;
+        }
+        void operator++() override {
+            SASSERT(!is_finished());
+            ++m_row;
+        }
+    };
+
+    table_base::iterator columnar_table::begin() const {
+        return mk_iterator(alloc(our_iterator_core, *this, false));
+    }
+
+    table_base::iterator columnar_table::end() const {
+        return mk_iterator(alloc(our_iterator_core, *this, true));
+    }
+
+    // -----------------------------------
+    //
+    // columnar_table_plugin
+    //
+    // -----------------------------------
+
+    columnar_table const & columnar_table_plugin::get(table_base const & t) { return dynamic_cast<columnar_table const &>(t); }
+    columnar_table & columnar_table_plugin::get(table_base & t) { return dynamic_cast<columnar_table &>(t); }
+    columnar_table * columnar_table_plugin::get(table_base * t) { return dynamic_cast<columnar_table *>(t); }
+
+    table_base * columnar_table_plugin::mk_empty(const table_signature & s) {
+        SASSERT(can_handle_signature(s));
+        return alloc(columnar_table, *this, s);
+    }
+
+    /**
+       \brief Join with optional projection.
+
+       Matching row pairs are collected in blocks; the result rows of a
+       block are then gathered one output column at a time.
+    */
+    class columnar_table_plugin::join_project_fn : public convenient_table_join_project_fn {
+        static const unsigned BLOCK = 1024;
+
+        unsigned_vector m_out_cols;   // column of the source table for each output column
+        bool_vector     m_out_second; // whether the output column comes from the second table
+        unsigned_vector m_pairs1, m_pairs2;
+        unsigned_vector m_hashes;
+        unsigned_vector m_probe_hashes;
+        unsigned_vector m_bucket_start;
+        unsigned_vector m_bucket_rows;
+        svector<table_element> m_block;
+
+        void flush(columnar_table const & t1, columnar_table const & t2, columnar_table & res) {
+            unsigned n = m_pairs1.size();
+            unsigned out_sz = m_out_cols.size();
+            m_block.resize(n * out_sz);
+            for (unsigned k = 0; k < out_sz; ++k) {
+                unsigned_vector const & rows = m_out_second[k] ? m_pairs2 : m_pairs1;
+                columnar_table::column const & col = (m_out_second[k] ? t2 : t1).m_columns[m_out_cols[k]];
+                for (unsigned i = 0; i < n; ++i)
+                    m_block[i * out_sz + k] = col[rows[i]];
+            }
+            for (unsigned i = 0; i < n; ++i)
+                res.add_row(m_block.data() + i * out_sz);
+            m_pairs1.reset();
+            m_pairs2.reset();
+        }
+
+        void add_pair(unsigned r1, unsigned r2, columnar_table const & t1, columnar_table const & t2, columnar_table & res) {
+            m_pairs1.push_back(r1);
+            m_pairs2.push_back(r2);
+            if (m_pairs1.size() == BLOCK)
+                flush(t1, t2, res);
+        }
+
+        void merge_join(columnar_table const & t1, columnar_table const & t2, columnar_table & res) {
+            unsigned_vector const & s1 = t1.get_sorted(m_cols1[0]);
+            unsigned_vector const & s2 = t2.get_sorted(m_cols2[0]);
+            columnar_table::column const & c1 = t1.m_columns[m_cols1[0]];
+            columnar_table::column const & c2 = t2.m_columns[m_cols2[0]];
+            unsigned i = 0, j = 0, n1 = s1.size(), n2 = s2.size();
+            while (i < n1 && j < n2) {
+                table_element v1 = c1[s1[i]], v2 = c2[s2[j]];
+                if (v1 < v2) {
+                    ++i;
+                    continue;
+                }
+                if (v2 < v1) {
+                    ++j;
+                    continue;
+                }
+                unsigned i_end = i + 1, j_end = j + 1;
+                while (i_end < n1 && c1[s1[i_end]] == v1)
+                    ++i_end;
+                while (j_end < n2 && c2[s2[j_end]] == v1)
+                    ++j_end;
+                for (unsigned a = i; a < i_end; ++a)
+                    for (unsigned b = j; b < j_end; ++b)
+                        add_pair(s1[a], s2[b], t1, t2, res);
+                i = i_end;
+                j = j_end;
+            }
+        }
+
+        static void hash_keys(columnar_table const & t, unsigned_vector const & keys, unsigned begin, unsigned end, unsigned_vector & hashes) {
+            hashes.reset();
+            hashes.resize(end - begin, 17);
+            for (unsigned key : keys) {
+                table_element const * col = t.m_columns[key].data() + begin;
+                unsigned * h = hashes.data();
+                for (unsigned i = 0, n = end - begin; i < n; ++i)
+                    h[i] = columnar_table::combine(h[i], col[i]);
+            }
+        }
+
+        void hash_join(columnar_table const & t1, columnar_table const & t2, columnar_table & res) {
+            // build on the smaller table, probe with the larger one
+            bool build_first = t1.row_count() <= t2.row_count();
+            columnar_table const & b = build_first ? t1 : t2;
+            columnar_table const & p = build_first ? t2 : t1;
+            unsigned_vector const & bkeys = build_first ? m_cols1 : m_cols2;
+            unsigned_vector const & pkeys = build_first ? m_cols2 : m_cols1;
+            unsigned nb = b.row_count();
+            unsigned mask = std::max(1u, next_power_of_two(nb)) - 1;
+
+            hash_keys(b, bkeys, 0, nb, m_hashes);
+            m_bucket_start.reset();
+            m_bucket_start.resize(mask + 2, 0);
+            for (unsigned r = 0; r < nb; ++r)
+                ++m_bucket_start[(m_hashes[r] & mask) + 1];
+            for (unsigned i = 1; i < m_bucket_start.size(); ++i)
+                m_bucket_start[i] += m_bucket_start[i - 1];
+            m_bucket_rows.reset();
+            m_bucket_rows.resize(nb, 0);
+            {
+                unsigned_vector fill(m_bucket_start);
+                for (unsigned r = 0; r < nb; ++r)
+                    m_bucket_rows[fill[m_hashes[r] & mask]++] = r;
+            }
+
+            unsigned np = p.row_count();
+            for (unsigned begin = 0; begin < np; begin += BLOCK) {
+                unsigned end = std::min(np, begin + BLOCK);
+                hash_keys(p, pkeys, begin, end, m_probe_hashes);
+                for (unsigned rp = begin; rp < end; ++rp) {
+                    unsigned h = m_probe_hashes[rp - begin];
+                    unsigned bucket = h & mask;
+                    for (unsigned k = m_bucket_start[bucket]; k < m_bucket_start[bucket + 1]; ++k) {
+                        unsigned rb = m_bucket_rows[k];
+                        if (m_hashes[rb] != h)
+                            continue;
+                        bool match = true;
+                        for (unsigned i = 0; match && i < bkeys.size(); ++i)
+                            match = b.m_columns[bkeys[i]][rb] == p.m_columns[pkeys[i]][rp];
+                        if (!match)
+                            continue;
+                        if (build_first)
+                            add_pair(rb, rp, t1, t2, res);
+                        else
+                            add_pair(rp, rb, t1, t2, res);
+                    }
+                }
+            }
+        }
+
+    public:
+        join_project_fn(const table_signature & t1_sig, const table_signature & t2_sig, unsigned col_cnt,
+                        const unsigned * cols1, const unsigned * cols2, unsigned removed_col_cnt,
+                        const unsigned * removed_cols)
+            : convenient_table_join_project_fn(t1_sig, t2_sig, col_cnt, cols1, cols2,
+                                               removed_col_cnt, removed_cols) {
+            unsigned n1 = t1_sig.size(), n2 = t2_sig.size();
+            unsigned r = 0;
+            for (unsigned i = 0; i < n1 + n2; ++i) {
+                if (r < m_removed_cols.size() && m_removed_cols[r] == i) {
+                    ++r;
+                    continue;
+                }
+                m_out_second.push_back(i >= n1);
+                m_out_cols.push_back(i >= n1 ? i - n1 : i);
+            }
+        }
+
+        table_base * operator()(const table_base & tb1, const table_base & tb2) override {
+            verbose_action _va("columnar join");
+            columnar_table const & t1 = get(tb1);
+            columnar_table const & t2 = get(tb2);
+            columnar_table & res = get(*t1.get_plugin().mk_empty(get_result_signature()));
+            if (m_cols1.size() == 1)
+                merge_join(t1, t2, res);
+            else
+                hash_join(t1, t2, res);
+            flush(t1, t2, res);
+            TRACE("dl_table_relation", tb1.display(tout); tb2.display(tout); res.display(tout); );
+            return &res;
+        }
+    };
+
+    table_join_fn * columnar_table_plugin::mk_join_fn(const table_base & t1, const table_base & t2,
+            unsigned col_cnt, const unsigned * cols1, const unsigned * cols2) {
+        return mk_join_project_fn(t1, t2, col_cnt, cols1, cols2, 0, static_cast<unsigned*>(nullptr));
+    }
+
+    table_join_fn * columnar_table_plugin::mk_join_project_fn(const table_base & t1, const table_base & t2,
+            unsigned col_cnt, const unsigned * cols1, const unsigned * cols2, unsigned removed_col_cnt,
+            const unsigned * removed_cols) {
+        if (!check_kind(t1) || !check_kind(t2)
+            || removed_col_cnt == t1.get_signature().size() + t2.get_signature().size()) {
+            // projecting all columns away gives an empty signature, which we do not handle
+            return nullptr;
+        }
+        return alloc(join_project_fn, t1.get_signature(), t2.get_signature(), col_cnt, cols1, cols2,
+                     removed_col_cnt, removed_cols);
+    }
+
+    class columnar_table_plugin::union_fn : public table_union_fn {
+        table_fact m_row;
+    public:
+        void operator()(table_base & tgt0, const table_base & src0, table_base * delta0) override {
+            verbose_action _va("columnar union");
+            columnar_table & tgt = get(tgt0);
+            columnar_table const & src = get(src0);
+            columnar_table * delta = delta0 ? get(delta0) : nullptr;
+            m_row.resize(src.num_cols());
+            for (unsigned r = 0; r < src.row_count(); ++r) {
+                src.get_row(r, m_row.data());
+                if (tgt.add_row(m_row.data()) && delta)
+                    delta->add_row(m_row.data());
+            }
+        }
+    };
+
+    table_union_fn * columnar_table_plugin::mk_union_fn(const table_base & tgt, const table_base & src,
+            const table_base * delta) {
+        if (!check_kind(tgt) || !check_kind(src) || (delta && !check_kind(*delta))
+            || tgt.get_signature() != src.get_signature()
+            || (delta && delta->get_signature() != tgt.get_signature())) {
+            return nullptr;
+        }
+        return alloc(union_fn);
+    }
+
+};
+
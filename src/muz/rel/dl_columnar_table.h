@@ -0,0 +1,141 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    dl_columnar_table.h
+
+Abstract:
+
+    Column oriented table.
+
+    Each column of the table is stored in its own vector, so that
+    operations touching only a few columns (hashing join keys, sorting
+    by a column, checking a selection) stream over contiguous memory.
+    Rows are deduplicated by an open addressing index over row ids.
+
+    Joins are evaluated in bulk:
+    - a join on a single column is a merge join over sorted column
+      indexes, which are cached in the tables until they change;
+    - other joins build a bucketed hash index on the smaller table and
+      probe it with key hashes computed a block of rows at a time.
+
+    The table is selected with datalog.default_table=columnar.
+    Signatures with functional columns are left to other plugins.
+
+--*/
+#pragma once
+
+#include "util/vector.h"
+#include "muz/rel/dl_base.h"
+
+namespace datalog {
+
+    class columnar_table;
+
+    class columnar_table_plugin : public table_plugin {
+        friend class columnar_table;
+    protected:
+        class join_project_fn;
+        class union_fn;
+    public:
+        typedef columnar_table table;
+
+        columnar_table_plugin(relation_manager & manager)
+            : table_plugin(symbol("columnar"), manager) {}
+
+        bool can_handle_signature(const table_signature & s) override {
+            return !s.empty() && s.functional_columns() == 0;
+        }
+
+        table_base * mk_empty(const table_signature & s) override;
+
+    protected:
+        table_join_fn * mk_join_fn(const table_base & t1, const table_base & t2,
+            unsigned col_cnt, const unsigned * cols1, const unsigned * cols2) override;
+        table_join_fn * mk_join_project_fn(const table_base & t1, const table_base & t2,
+            unsigned col_cnt, const unsigned * cols1, const unsigned * cols2, unsigned removed_col_cnt,
+            const unsigned * removed_cols) override;
+        table_union_fn * mk_union_fn(const table_base & tgt, const table_base & src,
+            const table_base * delta) override;
+
+        static columnar_table const & get(table_base const & t);
+        static columnar_table & get(table_base & t);
+        static columnar_table * get(table_base * t);
+    };
+
+    class columnar_table : public table_base {
+        friend class columnar_table_plugin;
+        friend class columnar_table_plugin::join_project_fn;
+        friend class columnar_table_plugin::union_fn;
+
+        class our_iterator_core;
+
+        typedef svector<table_element> column;
+
+        static const unsigned NO_ROW = UINT_MAX;
+
+        vector<column>                  m_columns;
+        unsigned                        m_num_rows = 0;
+        unsigned_vector                 m_hashes;        // hash of each row
+        unsigned_vector                 m_slots;         // row index, NO_ROW marks a free slot
+        mutable vector<unsigned_vector> m_sorted;        // rows ordered by the value of a column
+        mutable bool_vector             m_sorted_valid;
+
+        columnar_table(columnar_table_plugin & plugin, const table_signature & sig);
+
+        unsigned num_cols() const { return m_columns.size(); }
+
+        static unsigned hash_element(table_element v) {
+            return static_cast<unsigned>((v * 0x9E3779B97F4A7C15ull) >> 32);
+        }
+        static unsigned combine(unsigned h, table_element v) {
+            return (h * 0x01000193u) ^ hash_element(v);
+        }
+
+        unsigned fact_hash(const table_element * f) const;
+        bool row_eq(unsigned r, const table_element * f) const;
+
+        unsigned find_slot(const table_element * f) const;
+        void insert_slot(unsigned r, unsigned h);
+        void erase_slot(unsigned s);
+        void grow_slots();
+        void invalidate_indexes();
+
+        void get_row(unsigned r, table_element * f) const;
+
+        /**
+           \brief Add the row \c f, return false if it was already present.
+        */
+        bool add_row(const table_element * f);
+
+        /**
+           \brief Row ids ordered by the value of column \c col.
+        */
+        unsigned_vector const & get_sorted(unsigned col) const;
+
+    public:
+        columnar_table_plugin & get_plugin() const {
+            return static_cast<columnar_table_plugin &>(table_base::get_plugin());
+        }
+
+        unsigned row_count() const { return m_num_rows; }
+        table_element get(unsigned r, unsigned col) const { return m_columns[col][r]; }
+
+        bool empty() const override { return m_num_rows == 0; }
+        void add_fact(const table_fact & f) override { add_row(f.data()); }
+        void remove_fact(const table_element * fact) override;
+        bool contains_fact(const table_fact & f) const override;
+        void reset() override;
+        table_base * clone() const override;
+
+        iterator begin() const override;
+        iterator end() const override;
+
+        unsigned get_size_estimate_rows() const override { return m_num_rows; }
+        unsigned get_size_estimate_bytes() const override;
+        bool knows_exact_size() const override { return true; }
+    };
+
+};
+
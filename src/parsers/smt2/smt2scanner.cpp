@@ -26,7 +26,13 @@ namespace smt2 {
             m_cache.push_back(m_curr);
         if (m_at_eof)
             throw scanner_exception("unexpected end of file");
-        if (m_interactive) {
+        if (m_mem_end) {
+            if (m_mem_curr < m_mem_end)
+                m_curr = *m_mem_curr++;
+            else
+                m_at_eof = true;
+        }
+        else if (m_interactive) {
             m_curr = m_stream->get();
             if (m_stream->eof())
                 m_at_eof = true;
@@ -50,8 +56,30 @@ namespace smt2 {
         m_spos++;
     }
 
+    /**
+       \brief Advance an in-memory scanner so that the current character is *p.
+       The characters in between must not contain new lines.
+    */
+    void scanner::skip_to(char const * p) {
+        SASSERT(m_mem_curr - 1 <= p && p <= m_mem_end);
+        m_spos += static_cast<int>(p - m_mem_curr);
+        m_mem_curr = p;
+        next();
+    }
+
     void scanner::read_comment() {
         SASSERT(curr() == ';');
+        if (in_memory()) {
+            char const * p = static_cast<char const *>(memchr(m_mem_curr, '\n', m_mem_end - m_mem_curr));
+            if (!p) {
+                skip_to(m_mem_end);
+                return;
+            }
+            skip_to(p);
+            new_line();
+            next();
+            return;
+        }
         next();
         while (true) {
             char c = curr();
@@ -120,8 +148,7 @@ namespace smt2 {
     scanner::token scanner::read_symbol_core() {
         while (!m_at_eof) {
             char c = curr();
-            signed char n = m_normalized[static_cast<unsigned char>(c)];
-            if (n == 'a' || n == '0' || n == '-') {
+            if (is_symbol_char(c)) {
                 m_string.push_back(c);
                 next();
             }
@@ -142,6 +169,16 @@ namespace smt2 {
 
     scanner::token scanner::read_symbol() {
         SASSERT(m_normalized[static_cast<unsigned>(curr())] == 'a' || curr() == ':' || curr() == '-');
+        if (in_memory()) {
+            char const * begin = m_mem_curr - 1;
+            char const * p = m_mem_curr;
+            while (p < m_mem_end && is_symbol_char(*p))
+                ++p;
+            m_id = symbol(begin, static_cast<unsigned>(p - begin));
+            TRACE("scanner", tout << "new symbol: " << m_id << "\n";);
+            skip_to(p);
+            return SYMBOL_TOKEN;
+        }
         m_string.reset();
         m_string.push_back(curr());
         next();
@@ -150,31 +187,73 @@ namespace smt2 {
 
     scanner::token scanner::read_number() {
         SASSERT('0' <= curr() && curr() <= '9');
-        rational q(1);
-        m_number = rational(curr() - '0');
-        next();
+        // Digits are collected in a machine word and only folded into m_number
+        // once the word is full, instead of one rational operation per digit.
+        static const uint64_t pow10[19] = {
+            1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+            100000000ull, 1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull,
+            10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+            100000000000000000ull, 1000000000000000000ull };
+        uint64_t chunk = 0;
+        unsigned chunk_digits = 0;
+        unsigned frac_digits = 0;
         bool is_float = false;
+        bool is_small = true;
+        m_number.reset();
+        auto flush = [&]() {
+            if (is_small)
+                m_number = rational(chunk, rational::ui64());
+            else
+                m_number = m_number * rational(pow10[chunk_digits], rational::ui64()) + rational(chunk, rational::ui64());
+            is_small = false;
+            chunk = 0;
+            chunk_digits = 0;
+        };
+        auto add_digit = [&](char c) {
+            if (chunk_digits == 18)
+                flush();
+            chunk = 10 * chunk + (c - '0');
+            ++chunk_digits;
+            if (is_float)
+                ++frac_digits;
+        };
 
-        while (!m_at_eof) {
-            char c = curr();
-            if ('0' <= c && c <= '9') {
-                m_number = rational(10)*m_number + rational(c - '0');
-                if (is_float)
-                    q *= rational(10);
-                next();
-            }
-            else if (c == '.') {
-                if (is_float)
+        if (in_memory()) {
+            char const * p = m_mem_curr - 1;
+            for (; p < m_mem_end; ++p) {
+                char c = *p;
+                if ('0' <= c && c <= '9')
+                    add_digit(c);
+                else if (c == '.' && !is_float)
+                    is_float = true;
+                else
                     break;
-                is_float = true;
-                next();
             }
-            else {
-                break;
+            skip_to(p);
+        }
+        else {
+            add_digit(curr());
+            next();
+            while (!m_at_eof) {
+                char c = curr();
+                if ('0' <= c && c <= '9') {
+                    add_digit(c);
+                    next();
+                }
+                else if (c == '.') {
+                    if (is_float)
+                        break;
+                    is_float = true;
+                    next();
+                }
+                else {
+                    break;
+                }
             }
         }
-        if (is_float)
-            m_number /= q;
+        flush();
+        if (is_float && frac_digits > 0)
+            m_number /= power(rational(10), frac_digits);
         TRACE("scanner", tout << "new number: " << m_number << "\n";);
         return is_float ? FLOAT_TOKEN : INT_TOKEN;
     }
@@ -276,6 +355,14 @@ namespace smt2 {
     }
 
     scanner::scanner(cmd_context & ctx, std::istream& stream, bool interactive) :
+        scanner(ctx, &stream, nullptr, nullptr, interactive) {
+    }
+
+    scanner::scanner(cmd_context & ctx, char const * begin, char const * end) :
+        scanner(ctx, nullptr, begin, end, false) {
+    }
+
+    scanner::scanner(cmd_context & ctx, std::istream * stream, char const * begin, char const * end, bool interactive) :
         ctx(ctx),
         m_interactive(interactive),
         m_spos(0),
@@ -286,9 +373,13 @@ namespace smt2 {
         m_bv_size(UINT_MAX),
         m_bpos(0),
         m_bend(0),
-        m_stream(&stream),
+        m_stream(stream),
+        m_mem_curr(begin),
+        m_mem_end(end),
         m_cache_input(false) {
-
+        SASSERT(stream || begin <= end);
+        if (!stream && !begin)
+            m_mem_curr = m_mem_end = ""; // empty buffer
 
         for (int i = 0; i < 256; ++i) {
             m_normalized[i] = (signed char) i;
@@ -397,11 +488,22 @@ namespace smt2 {
 
     void scanner::reset_input(std::istream & stream, bool interactive) {
         m_stream = &stream;
+        m_mem_curr = nullptr;
+        m_mem_end = nullptr;
         m_interactive = interactive;
         m_at_eof = false;
         m_bpos = 0;
         m_bend = 0;
         next();
     }
-};
 
+    void scanner::reset_input(char const * begin, char const * end) {
+        SASSERT(begin <= end);
+        m_stream = nullptr;
+        m_mem_curr = begin ? begin : "";
+        m_mem_end = begin ? end : m_mem_curr;
+        m_interactive = false;
+        m_at_eof = false;
+        next();
+    }
+};
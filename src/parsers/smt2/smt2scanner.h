@@ -50,6 +50,10 @@ namespace smt2 {
         unsigned           m_bend;
         svector<char>      m_string;
         std::istream*      m_stream;
+        // in-memory input: when m_mem_end is set, characters are taken from
+        // [m_mem_curr, m_mem_end) instead of m_stream.
+        char const *       m_mem_curr;
+        char const *       m_mem_end;
         
         bool               m_cache_input;
         svector<char>      m_cache;
@@ -59,6 +63,12 @@ namespace smt2 {
         char curr() const { return m_curr; }
         void new_line() { m_line++; m_spos = 0; }
         void next();
+        bool is_symbol_char(char c) const {
+            signed char n = m_normalized[static_cast<unsigned char>(c)];
+            return n == 'a' || n == '0' || n == '-';
+        }
+        bool in_memory() const { return m_mem_end != nullptr && !m_cache_input; }
+        void skip_to(char const * p);
         
     public:
         
@@ -76,6 +86,13 @@ namespace smt2 {
         };
         
         scanner(cmd_context & ctx, std::istream& stream, bool interactive = false);  
+        /**
+           \brief Scan the characters in [begin, end), e.g., the contents of a memory mapped file.
+           The buffer must stay alive while the scanner is used. Symbols and numerals are
+           extracted directly from the buffer.
+        */
+        scanner(cmd_context & ctx, char const * begin, char const * end);
+        scanner(cmd_context & ctx, std::istream * stream, char const * begin, char const * end, bool interactive);
         
         int get_line() const { return m_line; }
         int get_pos() const { return m_pos; }
@@ -100,6 +117,7 @@ namespace smt2 {
         unsigned cache_size() const { return m_cache.size(); }
         void reset_cache() { m_cache.reset(); }
         void reset_input(std::istream & stream, bool interactive = false);
+        void reset_input(char const * begin, char const * end);
 
         char const * cached_str(unsigned begin, unsigned end);
     };
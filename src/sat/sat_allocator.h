@@ -9,6 +9,10 @@ Abstract:
 
     Small object allocator suitable for clauses
 
+    Small objects are carved out of 64K chunks. Released objects are kept
+    on free lists by size. The bytes on free lists are tracked, so that
+    the fragmentation of the chunks can be measured.
+
 Author:
 
     Nikolaj bjorner (nbjorner) 2018-04-26.
@@ -33,6 +37,7 @@ class sat_allocator {
     };
     char const *              m_id;
     size_t                    m_alloc_size;
+    size_t                    m_free_size;     // bytes of small objects on free lists
     ptr_vector<chunk>         m_chunks;
     void *                    m_chunk_ptr;
     ptr_vector<void>          m_free[NUM_FREE];
@@ -44,13 +49,14 @@ class sat_allocator {
         return (static_cast<unsigned>(size >> PTR_ALIGNMENT) + ((0 != (size & MASK)) ? 1u : 0u));
     }
 public:
-    sat_allocator(char const * id = "unknown"): m_id(id), m_alloc_size(0), m_chunk_ptr(nullptr) {}
+    sat_allocator(char const * id = "unknown"): m_id(id), m_alloc_size(0), m_free_size(0), m_chunk_ptr(nullptr) {}
     ~sat_allocator() { reset(); }
     void reset() {
         for (chunk * ch : m_chunks) dealloc(ch);
         m_chunks.reset();
         for (unsigned i = 0; i < NUM_FREE; ++i) m_free[i].reset();
         m_alloc_size = 0;
+        m_free_size = 0;
         m_chunk_ptr = nullptr;
     }
     void * allocate(size_t size) {
@@ -62,6 +68,7 @@ public:
         if (!m_free[slot_id].empty()) {
             void* result = m_free[slot_id].back();
             m_free[slot_id].pop_back();
+            m_free_size -= align_size(size);
             return result;
         }
         if (m_chunks.empty()) {
@@ -86,9 +93,19 @@ public:
         }
         else {
             m_free[free_slot_id(size)].push_back(p);
+            m_free_size += align_size(size);
         }
     }
     size_t get_allocation_size() const { return m_alloc_size; }
+    size_t get_free_size() const { return m_free_size; }
+    size_t get_chunk_size() const { return m_chunks.size() * sizeof(chunk); }
+
+    /**
+       \brief fraction of chunk memory that is on free lists.
+    */
+    double fragmentation() const { 
+        return m_chunks.empty() ? 0.0 : static_cast<double>(m_free_size) / get_chunk_size(); 
+    }
 
     char const* id() const { return m_id; }
 };
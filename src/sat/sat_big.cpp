@@ -18,6 +18,7 @@ Revision History:
 --*/
 #include "sat/sat_big.h"
 #include "sat/sat_solver.h"
+#include "sat/sat_parallel_for.h"
 
 namespace sat {
 
@@ -177,14 +178,35 @@ namespace sat {
         m_del_bin[u.index()].push_back(v);
     }
 
-    unsigned big::reduce_tr(solver& s) {
+    unsigned big::reduce_tr(solver& s, unsigned num_threads) {
         unsigned idx = 0;
         unsigned elim = 0;
         m_del_bin.reset();
         m_del_bin.reserve(s.m_watches.size());
+        // the dfs intervals do not change while edges are removed, 
+        // so watch lists without a reachable edge can be skipped.
+        svector<char> has_candidate(s.m_watches.size(), false);
+        parallel_for(num_threads, s.m_watches.size(), [&](unsigned begin, unsigned end) {
+            for (unsigned i = begin; i < end; ++i) {
+                literal u = to_literal(i);
+                for (watched const& w : s.m_watches[i]) {
+                    if (learned() ? w.is_binary_learned_clause() : w.is_binary_clause()) {
+                        literal v = w.get_literal();
+                        if (u != get_parent(v) && ~u != get_parent(v) && reaches(u, v)) {
+                            has_candidate[i] = true;
+                            break;
+                        }
+                    }
+                }
+            }
+        });
         for (watch_list & wlist : s.m_watches) {
             if (s.inconsistent()) 
                 break;
+            if (!has_candidate[idx]) {
+                ++idx;
+                continue;
+            }
             literal u = to_literal(idx++);
             unsigned j = 0, sz = wlist.size();            
             for (unsigned i = 0; i < sz; ++i) {
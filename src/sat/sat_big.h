@@ -73,7 +73,11 @@ namespace sat {
 
         void ensure_big(solver& s, bool learned) { if (m_left.empty()) init(s, learned); }
 
-        unsigned reduce_tr(solver& s);
+        /**
+           \brief remove binary clauses that are implied by other binary clauses.
+           The scan for candidate edges is split over num_threads threads.
+        */
+        unsigned reduce_tr(solver& s, unsigned num_threads = 1);
 
         // does it include learned binaries?
         bool learned() const { return m_learned; }
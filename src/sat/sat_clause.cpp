@@ -30,6 +30,7 @@ namespace sat {
         m_removed(false),
         m_learned(learned),
         m_used(false),
+        m_conflict_used(false),
         m_frozen(false),
         m_reinit_stack(false),
         m_inact_rounds(0),
@@ -115,23 +116,11 @@ namespace sat {
     }
 
     clause_offset clause::get_new_offset() const {
-        unsigned o1 = m_lits[0].index();
-#if defined(__LP64__) || defined(_WIN64)
-        if (sizeof(clause_offset) == 8) {
-            unsigned o2 = m_lits[1].index();
-            return (clause_offset)o1 + (((clause_offset)o2) << 32);
-        }        
-#endif
-        return (clause_offset)o1;
+        return m_lits[0].index();
     }
 
     void clause::set_new_offset(clause_offset offset) {
-        m_lits[0] = to_literal(static_cast<unsigned>(offset));
-#if defined(__LP64__) || defined(_WIN64)
-        if (sizeof(offset) == 8) {
-            m_lits[1] = to_literal(static_cast<unsigned>(offset >> 32));
-        }
-#endif
+        m_lits[0] = to_literal(offset);
     }
 
 
@@ -157,27 +146,78 @@ namespace sat {
     }
 
     clause_allocator::clause_allocator():
-        m_allocator("clause-allocator") {
+        m_allocator("clause-allocator"),
+        m_num_segments(0) {
     }
 
     void clause_allocator::finalize() {
         m_allocator.reset();
+        m_num_segments = 0;
+        m_far.reset();
+        m_far_free.reset();
+        m_far_idx.reset();
     }
 
     clause * clause_allocator::get_clause(clause_offset cls_off) const {
-        SASSERT(cls_off == reinterpret_cast<clause_offset>(reinterpret_cast<clause*>(cls_off)));
+#if defined(__LP64__) || defined(_WIN64)
+        unsigned segment = cls_off & c_segment_mask;
+        if (segment == c_far)
+            return m_far[cls_off >> 3];
+        return reinterpret_cast<clause *>(m_segments[segment] + (static_cast<size_t>(cls_off) & ~c_segment_mask));
+#else
         return reinterpret_cast<clause *>(cls_off);
+#endif
     }
 
     clause_offset clause_allocator::get_offset(clause const * cls) const {
-        SASSERT(cls == reinterpret_cast<clause *>(reinterpret_cast<size_t>(cls)));
+#if defined(__LP64__) || defined(_WIN64)
+        size_t ptr = reinterpret_cast<size_t>(cls);
+        SASSERT((ptr & c_segment_mask) == 0);
+        size_t segment = ptr & ~static_cast<size_t>(0xFFFFFFFF); // keep only the high part
+        for (unsigned i = 0; i < m_num_segments; ++i)
+            if (m_segments[i] == segment)
+                return static_cast<clause_offset>(ptr) + i;
+        unsigned idx = 0;
+        VERIFY(m_far_idx.find(cls->id(), idx));
+        return (idx << 3) + c_far;
+#else
         return reinterpret_cast<size_t>(cls);
+#endif
+    }
+
+    /**
+       \brief make the offset of a new clause available to get_offset.
+       The high part of its address is added to the segment table, or
+       the clause is added to the far clauses if the table is full.
+    */
+    void clause_allocator::register_clause(clause * cls) {
+#if defined(__LP64__) || defined(_WIN64)
+        size_t segment = reinterpret_cast<size_t>(cls) & ~static_cast<size_t>(0xFFFFFFFF);
+        for (unsigned i = 0; i < m_num_segments; ++i)
+            if (m_segments[i] == segment)
+                return;
+        if (m_num_segments < c_max_segments) {
+            m_segments[m_num_segments++] = segment;
+            return;
+        }
+        unsigned idx = m_far.size();
+        if (m_far_free.empty())
+            m_far.push_back(cls);
+        else {
+            idx = m_far_free.back();
+            m_far_free.pop_back();
+            m_far[idx] = cls;
+        }
+        SASSERT(idx < (1u << 29));
+        m_far_idx.insert(cls->id(), idx);
+#endif
     }
 
     clause * clause_allocator::mk_clause(unsigned num_lits, literal const * lits, bool learned) {
         size_t size = clause::get_obj_size(num_lits);
         void * mem = m_allocator.allocate(size);
         clause * cls = new (mem) clause(m_id_gen.mk(), num_lits, lits, learned);
+        register_clause(cls);
         TRACE("sat_clause", tout << "alloc: " << cls->id() << " " << *cls << " " << (learned?"l":"a") << "\n";);
         SASSERT(!learned || cls->is_learned());
         return cls;
@@ -192,11 +232,18 @@ namespace sat {
         cls->m_psm    = other.psm();
         cls->m_frozen = other.frozen();
         cls->m_approx = other.approx();
+        register_clause(cls);
         return cls;
     }
 
     void clause_allocator::del_clause(clause * cls) {
         TRACE("sat_clause", tout << "delete: " << cls->id() << " " << *cls << "\n";);
+        unsigned idx = 0;
+        if (!m_far.empty() && m_far_idx.find(cls->id(), idx)) {
+            m_far[idx] = nullptr;
+            m_far_free.push_back(idx);
+            m_far_idx.remove(cls->id());
+        }
         m_id_gen.recycle(cls->id());
         size_t size = clause::get_obj_size(cls->m_capacity);
         cls->~clause();
@@ -48,6 +48,7 @@ namespace sat {
         unsigned           m_removed:1;
         unsigned           m_learned:1;
         unsigned           m_used:1;
+        unsigned           m_conflict_used:1; // resolved with during conflict analysis since the last gc
         unsigned           m_frozen:1;
         unsigned           m_reinit_stack:1;
         unsigned           m_inact_rounds:8;
@@ -87,6 +88,9 @@ namespace sat {
         void mark_used() { m_used = true; }
         void unmark_used() { m_used = false; }
         bool was_used() const { return m_used; }
+        void mark_used_in_conflict() { m_conflict_used = true; }
+        void unmark_used_in_conflict() { m_conflict_used = false; }
+        bool was_used_in_conflict() const { return m_conflict_used; }
         void inc_inact_rounds() { m_inact_rounds++; }
         void reset_inact_rounds() { m_inact_rounds = 0; }
         unsigned inact_rounds() const { return m_inact_rounds; }
@@ -134,14 +138,30 @@ namespace sat {
 
     /**
        \brief Simple clause allocator that allows uint (32bit integers) to be used to reference clauses (even in 64bit machines).
+
+       On 64bit machines a clause offset is the low 32 bits of the clause address. 
+       Clauses are 8 byte aligned, so the low 3 bits of the offset index a small table 
+       of segments that stores the high 32 bits of the addresses handed out by the allocator.
+       Clauses allocated after the segment table is full are far clauses. They are kept in 
+       a growing table of pointers and their offset is the index in this table tagged with c_far.
     */
     class clause_allocator {
+        static const unsigned c_far = 7;
+        static const unsigned c_max_segments = c_far;
+        static const size_t   c_segment_mask = 7;
         sat_allocator    m_allocator;
         id_gen           m_id_gen;
+        size_t           m_segments[c_max_segments];
+        unsigned         m_num_segments;
+        ptr_vector<clause> m_far;          // far clauses indexed by offset >> 3
+        unsigned_vector  m_far_free;
+        u_map<unsigned>  m_far_idx;        // clause id -> index in m_far
+        void register_clause(clause * cls);
     public:
         clause_allocator();
         void          finalize();
         size_t        get_allocation_size() const { return m_allocator.get_allocation_size(); }
+        double        fragmentation() const { return m_allocator.fragmentation(); }
         clause *      get_clause(clause_offset cls_off) const;
         clause_offset get_offset(clause const * ptr) const;
         clause *      mk_clause(unsigned num_lits, literal const * lits, bool learned);
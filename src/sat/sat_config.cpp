@@ -52,6 +52,7 @@ namespace sat {
         m_slow_glue_avg = p.restart_emaslowglue();
         m_restart_margin = p.restart_margin();
         m_restart_fast = p.restart_fast();
+        m_restart_reuse_trail = p.restart_reuse_trail();
         s = p.phase();
         if (s == symbol("always_false")) 
             m_phase = PS_ALWAYS_FALSE;
@@ -111,6 +112,10 @@ namespace sat {
         m_anf_simplify      = p.anf();
         m_anf_delay         = p.anf_delay();
         m_anf_exlin         = p.anf_exlin();
+        m_xor_gauss         = p.xor_gauss();
+        m_xor_gauss_max_cells = p.xor_gauss_max_cells();
+        m_vivify            = p.vivify();
+        m_vivify_ticks      = p.vivify_ticks();
         m_cut_simplify      = p.cut();
         m_cut_delay         = p.cut_delay();
         m_cut_aig           = p.cut_aig();
@@ -185,8 +190,12 @@ namespace sat {
         m_gc_increment    = p.gc_increment();
         m_gc_small_lbd    = p.gc_small_lbd();
         m_gc_k            = std::min(255u, p.gc_k());
+        m_gc_tiers        = p.gc_tiers();
+        m_gc_tier1_glue   = p.gc_tier1_glue();
+        m_gc_tier2_glue   = std::max(m_gc_tier1_glue, p.gc_tier2_glue());
         m_gc_burst        = p.gc_burst();
         m_gc_defrag       = p.gc_defrag();
+        m_gc_defrag_fragmentation = p.gc_defrag_fragmentation();
 
         m_force_cleanup   = p.force_cleanup();
 
@@ -210,6 +219,7 @@ namespace sat {
              m_smt_proof_check ||
              m_drat_check_sat);
         m_drat_binary     = p.drat_binary();
+        m_drat_async      = p.drat_async();
         m_drat_activity   = p.drat_activity();
         m_dyn_sub_res     = p.dyn_sub_res();
 
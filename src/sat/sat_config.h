@@ -97,6 +97,7 @@ namespace sat {
         bool               m_propagate_prefetch;
         restart_strategy   m_restart;
         bool               m_restart_fast;
+        bool               m_restart_reuse_trail;
         unsigned           m_restart_initial;
         double             m_restart_factor; // for geometric case
         double             m_restart_margin; // for ema
@@ -132,6 +133,10 @@ namespace sat {
         bool               m_anf_simplify;
         unsigned           m_anf_delay;
         bool               m_anf_exlin;
+        bool               m_xor_gauss;
+        unsigned           m_xor_gauss_max_cells;
+        bool               m_vivify;
+        unsigned           m_vivify_ticks;
         bool               m_lookahead_simplify;
         bool               m_lookahead_simplify_bca;
         cutoff_t           m_lookahead_cube_cutoff;
@@ -160,8 +165,12 @@ namespace sat {
         unsigned           m_gc_increment;
         unsigned           m_gc_small_lbd;
         unsigned           m_gc_k;
+        bool               m_gc_tiers;
+        unsigned           m_gc_tier1_glue;
+        unsigned           m_gc_tier2_glue;
         bool               m_gc_burst;
         bool               m_gc_defrag;
+        double             m_gc_defrag_fragmentation;
 
         bool               m_force_cleanup;
 
@@ -178,6 +187,7 @@ namespace sat {
         bool               m_drat;
         bool               m_drat_disable;
         bool               m_drat_binary;
+        bool               m_drat_async;
         symbol             m_drat_file;
         bool               m_smt_proof_check;
         bool               m_drat_check_unsat;
@@ -0,0 +1,294 @@
+/*++
+  Copyright (c) 2024 Microsoft Corporation
+
+  Module Name:
+
+   sat_cube_and_conquer.cpp
+
+  Abstract:
+
+    Cube and conquer driver.
+
+  --*/
+
+#include "util/stopwatch.h"
+#include "sat/sat_cube_and_conquer.h"
+#include "sat/sat_parallel.h"
+
+#ifndef SINGLE_THREAD
+#include <thread>
+#include <chrono>
+#endif
+
+namespace sat {
+
+    cube_and_conquer::cube_and_conquer(solver& s, unsigned num_workers):
+        s(s),
+        m_num_workers(std::max(1u, num_workers)),
+        m_max_pending(2 * std::max(1u, num_workers)) {
+#ifdef SINGLE_THREAD
+        m_num_workers = 1;
+#endif
+    }
+
+    void cube_and_conquer::init_workers(params_ref const& p) {
+        m_limits.init(m_num_workers);
+        for (unsigned i = 0; i < m_num_workers; ++i) {
+            params_ref wp(p);
+            wp.set_uint("random_seed", s.rand()() + i);
+            solver* w = alloc(solver, wp, m_limits[i]);
+            w->copy(s, true);
+            m_workers.push_back(w);
+        }
+    }
+
+    void cube_and_conquer::cancel() {
+        for (reslimit& rl : m_limits)
+            rl.cancel();
+        m_cuber_limit.cancel();
+    }
+
+    // called while holding m_mux
+    void cube_and_conquer::set_result(lbool r, unsigned worker) {
+        if (m_done)
+            return;
+        m_done = true;
+        m_result = r;
+        m_winner = worker;
+        cancel();
+    }
+
+    bool cube_and_conquer::push_cube(literal_vector const& cube) {
+        {
+            lock_guard lock(m_mux);
+            if (m_done)
+                return false;
+            m_queue.push_back(cube);
+            ++m_stats.m_num_cubes;
+        }
+#ifdef SINGLE_THREAD
+        conquer(0);
+#endif
+        return true;
+    }
+
+    bool cube_and_conquer::next_cube(unsigned worker, unsigned& id, literal_vector& cube, unsigned& num_cores, vector<literal_vector>& cores) {
+        while (true) {
+            {
+                lock_guard lock(m_mux);
+                if (m_done)
+                    return false;
+                for (; num_cores < m_cores.size(); ++num_cores)
+                    cores.push_back(m_cores[num_cores]);
+                if (m_queue_head < m_queue.size()) {
+                    id = m_queue_head;
+                    cube.reset();
+                    cube.append(m_queue[id]);
+                    m_queue[id].finalize();
+                    ++m_queue_head;
+                    return true;
+                }
+                if (m_cubing_done)
+                    return false;
+            }
+#ifdef SINGLE_THREAD
+            return false;
+#else
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+        }
+    }
+
+    /**
+       \brief the worker learns the negation of the refuted cores.
+     */
+    void cube_and_conquer::add_cores(unsigned worker, vector<literal_vector> const& cores) {
+        solver& w = *m_workers[worker];
+        w.pop_to_base_level();
+        literal_vector lits;
+        for (auto const& core : cores) {
+            lits.reset();
+            for (literal l : core)
+                lits.push_back(~l);
+            w.mk_clause(lits.size(), lits.data(), status::redundant());
+        }
+    }
+
+    bool cube_and_conquer::is_pruned(literal_vector const& cube, vector<literal_vector> const& cores, bool_vector& marks) const {
+        for (literal l : cube) {
+            marks.reserve(l.index() + 1, false);
+            marks[l.index()] = true;
+        }
+        bool pruned = any_of(cores, [&](literal_vector const& core) {
+            return all_of(core, [&](literal l) { return l.index() < marks.size() && marks[l.index()]; });
+        });
+        for (literal l : cube)
+            marks[l.index()] = false;
+        return pruned;
+    }
+
+    void cube_and_conquer::solve_cube(unsigned worker, unsigned id, literal_vector const& cube) {
+        solver& w = *m_workers[worker];
+        stopwatch sw;
+        sw.start();
+        lbool r = l_undef;
+        try {
+            r = w.check(cube.size(), cube.data());
+        }
+        catch (z3_exception& ex) {
+            IF_VERBOSE(1, verbose_stream() << "(sat.cube-and-conquer :worker " << worker << " :exception \"" << ex.msg() << "\")\n");
+        }
+        sw.stop();
+        lock_guard lock(m_mux);
+        if (m_done && r == l_undef)
+            return;
+        cube_info info = { id, worker, cube.size(), 0, r, false, sw.get_seconds() };
+        switch (r) {
+        case l_false:
+            ++m_stats.m_num_refuted;
+            info.m_core_size = w.get_core().size();
+            if (w.get_core().empty())
+                set_result(l_false, worker);
+            else
+                m_cores.push_back(w.get_core());
+            break;
+        case l_true:
+            set_result(l_true, worker);
+            break;
+        default:
+            ++m_stats.m_num_unknown;
+            break;
+        }
+        if (m_on_cube)
+            m_on_cube(info);
+    }
+
+    void cube_and_conquer::conquer(unsigned worker) {
+        unsigned id = 0, num_cores = 0, num_added = 0;
+        literal_vector cube;
+        vector<literal_vector> cores;
+        bool_vector marks;
+        while (next_cube(worker, id, cube, num_cores, cores)) {
+            if (is_pruned(cube, cores, marks)) {
+                lock_guard lock(m_mux);
+                ++m_stats.m_num_pruned;
+                cube_info info = { id, worker, cube.size(), 0, l_false, true, 0.0 };
+                if (m_on_cube)
+                    m_on_cube(info);
+                continue;
+            }
+            if (num_added < cores.size()) {
+                vector<literal_vector> new_cores;
+                for (; num_added < cores.size(); ++num_added)
+                    new_cores.push_back(cores[num_added]);
+                add_cores(worker, new_cores);
+            }
+            solve_cube(worker, id, cube);
+        }
+    }
+
+    void cube_and_conquer::cube(solver& cuber) {
+        bool_var_vector vars;
+        literal_vector lits;
+        bool complete = false;
+        try {
+            while (true) {
+#ifndef SINGLE_THREAD
+                while (true) {
+                    {
+                        lock_guard lock(m_mux);
+                        if (m_done)
+                            return;
+                        if (m_queue.size() - m_queue_head < m_max_pending)
+                            break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+#endif
+                vars.reset();
+                stopwatch sw;
+                sw.start();
+                lbool r = cuber.cube(vars, lits, UINT_MAX);
+                sw.stop();
+                m_stats.m_cube_time += sw.get_seconds();
+                if (r == l_true) {
+                    lock_guard lock(m_mux);
+                    set_result(l_true, UINT_MAX);
+                    complete = true;
+                    break;
+                }
+                if (r == l_false) {
+                    complete = true;
+                    break;
+                }
+                if (!push_cube(lits))
+                    break;
+                if (lits.empty()) {
+                    // lookahead did not split the remaining problem,
+                    // the empty cube covers it.
+                    complete = true;
+                    break;
+                }
+            }
+        }
+        catch (z3_exception& ex) {
+            IF_VERBOSE(1, verbose_stream() << "(sat.cube-and-conquer :cuber-exception \"" << ex.msg() << "\")\n");
+        }
+        lock_guard lock(m_mux);
+        if (!complete && !m_done)
+            ++m_stats.m_num_unknown;
+        m_cubing_done = true;
+    }
+
+    lbool cube_and_conquer::operator()() {
+        if (s.inconsistent())
+            return l_false;
+        params_ref p;
+        p.copy(s.params());
+        p.set_sym("drat.file", symbol::null);
+        p.set_uint("threads", m_num_workers);
+        init_workers(p);
+        solver cuber(p, m_cuber_limit);
+        cuber.copy(s, true);
+
+        scoped_limits limits(s.rlimit());
+        limits.push_child(&m_cuber_limit);
+        for (reslimit& rl : m_limits)
+            limits.push_child(&rl);
+
+#ifndef SINGLE_THREAD
+        {
+            sat::parallel par(s);
+            par.reserve(m_num_workers, 1 << 12);
+            for (unsigned i = 0; i < m_num_workers; ++i)
+                m_workers[i]->set_par(&par, i);
+            vector<std::thread> threads(m_num_workers);
+            for (unsigned i = 0; i < m_num_workers; ++i)
+                threads[i] = std::thread([&, i]() { conquer(i); });
+            cube(cuber);
+            for (auto& th : threads)
+                th.join();
+            for (solver* w : m_workers)
+                w->set_par(nullptr, 0);
+        }
+#else
+        cube(cuber);
+#endif
+        if (!m_done && m_stats.m_num_unknown == 0)
+            m_result = l_false;
+        if (m_result == l_true)
+            s.set_model(m_winner == UINT_MAX ? cuber.get_model() : m_workers[m_winner]->get_model(), true);
+        for (solver* w : m_workers)
+            w->collect_statistics(m_worker_stats);
+        return m_result;
+    }
+
+    void cube_and_conquer::collect_statistics(statistics& st) const {
+        st.copy(m_worker_stats);
+        st.update("cube-and-conquer cubes", m_stats.m_num_cubes);
+        st.update("cube-and-conquer refuted", m_stats.m_num_refuted);
+        st.update("cube-and-conquer pruned", m_stats.m_num_pruned);
+        st.update("cube-and-conquer unknown", m_stats.m_num_unknown);
+        st.update("cube-and-conquer cube time", m_stats.m_cube_time);
+    }
+}
@@ -0,0 +1,102 @@
+/*++
+  Copyright (c) 2024 Microsoft Corporation
+
+  Module Name:
+
+   sat_cube_and_conquer.h
+
+  Abstract:
+
+    Cube and conquer driver.
+
+    A lookahead solver produces cubes on the calling thread and
+    streams them to a pool of CDCL workers that solve the cubes
+    as assumptions. Workers exchange units and binary clauses through
+    sat::parallel.
+    When a worker refutes a cube, the core of the cube is recorded.
+    Queued cubes that contain a recorded core are pruned without
+    being solved, and all workers learn the negation of the core.
+
+  --*/
+
+#pragma once
+
+#include "util/mutex.h"
+#include "util/statistics.h"
+#include "util/scoped_ptr_vector.h"
+#include "sat/sat_types.h"
+#include "sat/sat_solver.h"
+
+namespace sat {
+
+    class cube_and_conquer {
+    public:
+        struct cube_info {
+            unsigned m_id;
+            unsigned m_worker;
+            unsigned m_size;
+            unsigned m_core_size;
+            lbool    m_result;       // l_false if the cube is refuted
+            bool     m_pruned;       // refuted by the core of another cube
+            double   m_seconds;
+        };
+
+    private:
+        struct stats {
+            unsigned m_num_cubes = 0;
+            unsigned m_num_refuted = 0;
+            unsigned m_num_pruned = 0;
+            unsigned m_num_unknown = 0;
+            double   m_cube_time = 0;
+            void reset() { *this = stats(); }
+        };
+
+        solver&                     s;
+        unsigned                    m_num_workers;
+        unsigned                    m_max_pending;
+        std::function<void(cube_info const&)> m_on_cube;
+        scoped_ptr_vector<solver>   m_workers;
+        vector<reslimit>            m_limits;
+        reslimit                    m_cuber_limit;
+        stats                       m_stats;
+        statistics                  m_worker_stats;
+
+        // state shared between the cuber and the workers, protected by m_mux.
+        mutex                       m_mux;
+        vector<literal_vector>      m_queue;
+        unsigned                    m_queue_head = 0;
+        vector<literal_vector>      m_cores;
+        bool                        m_cubing_done = false;
+        bool                        m_done = false;
+        lbool                       m_result = l_undef;
+        unsigned                    m_winner = UINT_MAX;
+
+        void init_workers(params_ref const& p);
+        void cancel();
+        void set_result(lbool r, unsigned worker);
+        bool next_cube(unsigned worker, unsigned& id, literal_vector& cube, unsigned& num_cores, vector<literal_vector>& cores);
+        void add_cores(unsigned worker, vector<literal_vector> const& cores);
+        bool is_pruned(literal_vector const& cube, vector<literal_vector> const& cores, bool_vector& marks) const;
+        void solve_cube(unsigned worker, unsigned id, literal_vector const& cube);
+        void conquer(unsigned worker);
+        void cube(solver& cuber);
+        bool push_cube(literal_vector const& cube);
+
+    public:
+        cube_and_conquer(solver& s, unsigned num_workers);
+
+        /**
+           \brief set a callback invoked after each cube is decided.
+           It is called while holding a lock shared by all workers.
+        */
+        void set(std::function<void(cube_info const&)>& f) { m_on_cube = f; }
+
+        /**
+           \brief solve the clauses of s.
+           If the result is l_true, the model is stored in s.
+        */
+        lbool operator()();
+
+        void collect_statistics(statistics& st) const;
+    };
+}
@@ -32,24 +32,97 @@
 
 namespace sat {
 
+    ddfw_shared::ddfw_shared(unsigned num_vars): 
+        m_num_words((num_vars + 63) / 64),
+        m_bits(alloc_vect<std::atomic<uint64_t>>(m_num_words)) {
+        for (unsigned i = 0; i < m_num_words; ++i)
+            m_bits[i].store(0, std::memory_order_relaxed);
+    }
+
+    ddfw_shared::~ddfw_shared() {
+        dealloc_vect(m_bits, m_num_words);
+    }
+
+    bool ddfw_shared::publish(unsigned num_unsat, bool_vector const& values) {
+        if (num_unsat >= best())
+            return false;
+        bool expected = false;
+        if (!m_writing.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            return false;
+        bool published = false;
+        if (num_unsat < best()) {
+            unsigned seq = m_seq.load(std::memory_order_relaxed);
+            m_seq.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            unsigned n = std::min(values.size(), 64 * m_num_words);
+            for (unsigned w = 0; w < m_num_words; ++w) {
+                uint64_t bits = 0;
+                for (unsigned i = 64 * w, e = std::min(n, i + 64); i < e; ++i)
+                    bits |= static_cast<uint64_t>(values[i]) << (i % 64);
+                m_bits[w].store(bits, std::memory_order_relaxed);
+            }
+            m_best.store(num_unsat, std::memory_order_relaxed);
+            m_seq.store(seq + 2, std::memory_order_release);
+            published = true;
+        }
+        m_writing.store(false, std::memory_order_release);
+        return published;
+    }
+
+    bool ddfw_shared::fetch(unsigned& seq, bool_vector& values) const {
+        unsigned s1 = m_seq.load(std::memory_order_acquire);
+        if (s1 == seq || (s1 & 1) != 0)
+            return false;
+        bool_vector tmp(values.size(), false);
+        unsigned n = std::min(values.size(), 64 * m_num_words);
+        for (unsigned w = 0; 64 * w < n; ++w) {
+            uint64_t bits = m_bits[w].load(std::memory_order_relaxed);
+            for (unsigned i = 64 * w, e = std::min(n, i + 64); i < e; ++i)
+                tmp[i] = (bits >> (i % 64)) & 1;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_seq.load(std::memory_order_relaxed) != s1)
+            return false;
+        values.swap(tmp);
+        seq = s1;
+        return true;
+    }
+
     ddfw::~ddfw() {
-        for (auto& ci : m_clauses) 
-            m_alloc.del_clause(ci.m_clause);        
     }
 
     lbool ddfw::check(unsigned sz, literal const* assumptions, parallel* p) {
         init(sz, assumptions);
         flet<parallel*> _p(m_par, p);
+        m_search_time.reset();
+        m_search_time.start();
         if (m_plugin)
             check_with_plugin();
         else
             check_without_plugin();
+        m_search_time.stop();
         remove_assumptions();
         log();
         return m_min_sz == 0 ? l_true : l_undef;
     }
 
+    void ddfw::collect_statistics(statistics& st) const {
+        double secs = m_search_time.get_seconds();
+        st.update("ddfw flips", static_cast<double>(m_flips));
+        if (secs > 0)
+            st.update("ddfw flips/sec", m_flips / secs);
+        st.update("ddfw restarts", m_restart_count);
+        st.update("ddfw reinits", m_reinit_count);
+        st.update("ddfw shifts", static_cast<double>(m_shifts));
+        if (m_shared) {
+            st.update("ddfw models published", m_models_published);
+            st.update("ddfw models imported", m_models_imported);
+        }
+    }
+
     void ddfw::check_without_plugin() {
+        if (m_min_sz == 0)
+            save_model(); // the initial assignment satisfies all clauses
         while (m_limit.inc() && m_min_sz > 0) {
             if (should_reinit_weights()) do_reinit_weights();
             else if (do_flip<false>());
@@ -61,6 +134,8 @@ namespace sat {
 
     void ddfw::check_with_plugin() {
         m_plugin->init_search();
+        if (m_min_sz == 0)
+            save_model();
         m_steps_since_progress = 0;
         unsigned steps = 0;
         while (m_min_sz > 0 && m_steps_since_progress++ <= 1500000) {
@@ -167,13 +242,13 @@ namespace sat {
     template<bool uses_plugin>
     bool_var ddfw::pick_literal_var() {
 #if false
-        unsigned sz = m_clauses.size();
+        unsigned sz = num_clauses();
         unsigned start = rand();
         for (unsigned i = 0; i < 100; ++i) {
             unsigned cl = (i + start) % sz;
             if (m_unsat.contains(cl))
                 continue;
-            for (auto lit : *m_clauses[cl].m_clause) {
+            for (auto lit : get_clause(cl)) {
                 if (is_true(lit))
                     continue;
                 double r = uses_plugin ? plugin_reward(lit.var()) : reward(lit.var());
@@ -187,15 +262,24 @@ namespace sat {
         return null_bool_var;
     }
 
-    void ddfw::add(unsigned n, literal const* c) {        
-        clause* cls = m_alloc.mk_clause(n, c, false);
-        unsigned idx = m_clauses.size();
+    void ddfw::reserve_var(bool_var v) {
+        m_use_list.reserve(2*(v+1));
+        m_vars.reserve(v+1);
+        m_values.reserve(v+1, false);
+        m_rewards.reserve(v+1, 0);
+        m_make_counts.reserve(v+1, 0);
+    }
 
-        m_clauses.push_back(clause_info(cls, m_config.m_init_clause_weight));
-        for (literal lit : *cls) {
-            m_use_list.reserve(2*(lit.var()+1));
-            m_vars.reserve(lit.var()+1);
-            m_use_list[lit.index()].push_back(idx);
+    void ddfw::add(unsigned n, literal const* c) {        
+        unsigned idx = num_clauses();
+        m_lits.append(n, c);
+        m_lit_start.push_back(m_lits.size());
+        m_weights.push_back(m_config.m_init_clause_weight);
+        m_trues.push_back(0);
+        m_num_trues.push_back(0);
+        for (unsigned i = 0; i < n; ++i) {
+            reserve_var(c[i].var());
+            m_use_list[c[i].index()].push_back(idx);
         }
     }
 
@@ -203,19 +287,25 @@ namespace sat {
      * Remove the last clause that was added
      */
     void ddfw::del() {
-        auto& info = m_clauses.back();
-        for (literal lit : *info.m_clause)
+        unsigned idx = num_clauses() - 1;
+        for (literal lit : get_clause(idx))
             m_use_list[lit.index()].pop_back();
-        m_alloc.del_clause(info.m_clause);
-        m_clauses.pop_back();
-        if (m_unsat.contains(m_clauses.size()))
-            m_unsat.remove(m_clauses.size());
+        m_lits.shrink(m_lit_start[idx]);
+        m_lit_start.pop_back();
+        m_weights.pop_back();
+        m_trues.pop_back();
+        m_num_trues.pop_back();
+        if (m_unsat.contains(idx))
+            m_unsat.remove(idx);
     }
 
     void ddfw::add(solver const& s) {
-        for (auto& ci : m_clauses) 
-            m_alloc.del_clause(ci.m_clause);
-        m_clauses.reset(); 
+        m_lits.reset();
+        m_lit_start.reset();
+        m_lit_start.push_back(0);
+        m_weights.reset();
+        m_trues.reset();
+        m_num_trues.reset();
         m_use_list.reset();
         m_num_non_binary_clauses = 0;
 
@@ -310,52 +400,46 @@ namespace sat {
         literal lit = literal(v, !value(v));
         literal nlit = ~lit;
         SASSERT(is_true(lit));
+        unsigned* num_trues = m_num_trues.data();
+        unsigned* trues = m_trues.data();
+        double const* weights = m_weights.data();
         for (unsigned cls_idx : use_list(*this, lit)) {
-            clause_info& ci = m_clauses[cls_idx];
-            ci.del(lit);
-            double w = ci.m_weight;
+            unsigned n = --num_trues[cls_idx];
+            trues[cls_idx] -= lit.index();
+            if (n > 1)
+                continue;
+            double w = weights[cls_idx];
+            if (n == 1) {
+                dec_reward(to_literal(trues[cls_idx]), w);
+                continue;
+            }
             // cls becomes false: flip any variable in clause to receive reward w
-            switch (ci.m_num_trues) {
-            case 0: {
-                m_unsat.insert_fresh(cls_idx);
-                clause const& c = get_clause(cls_idx);
-                for (literal l : c) {
-                    inc_reward(l, w);
-                    inc_make(l);
-                }
-                inc_reward(lit, w);
-                break;
-                }
-            case 1:
-                dec_reward(to_literal(ci.m_trues), w);
-                break;
-            default:
-                break;
+            m_unsat.insert_fresh(cls_idx);
+            for (literal l : get_clause(cls_idx)) {
+                inc_reward(l, w);
+                inc_make(l);
             }
+            inc_reward(lit, w);
         }
         for (unsigned cls_idx : use_list(*this, nlit)) {
-            clause_info& ci = m_clauses[cls_idx];             
-            double w = ci.m_weight;
+            unsigned n = num_trues[cls_idx]++;
+            unsigned t = trues[cls_idx];
+            trues[cls_idx] += nlit.index();
+            if (n > 1)
+                continue;
+            double w = weights[cls_idx];
             // the clause used to have a single true (pivot) literal, now it has two.
             // Then the previous pivot is no longer penalized for flipping.
-            switch (ci.m_num_trues) {
-            case 0: {
-                m_unsat.remove(cls_idx);   
-                clause const& c = get_clause(cls_idx);
-                for (literal l : c) {
-                    dec_reward(l, w);
-                    dec_make(l);
-                }
-                dec_reward(nlit, w);
-                break;
+            if (n == 1) {
+                inc_reward(to_literal(t), w);
+                continue;
             }
-            case 1:
-                inc_reward(to_literal(ci.m_trues), w);
-                break;
-            default:
-                break;
+            m_unsat.remove(cls_idx);   
+            for (literal l : get_clause(cls_idx)) {
+                dec_reward(l, w);
+                dec_make(l);
             }
-            ci.add(nlit);
+            dec_reward(nlit, w);
         }
         value(v) = !value(v);
         update_reward_avg(v);
@@ -368,16 +452,17 @@ namespace sat {
     void ddfw::do_reinit_weights() {
         log();
 
+        double* weights = m_weights.data();
+        unsigned const* num_trues = m_num_trues.data();
+        unsigned sz = num_clauses();
         if (m_reinit_count % 2 == 0) { 
-            for (auto& ci : m_clauses) 
-                ci.m_weight += 1;                            
+            for (unsigned i = 0; i < sz; ++i) 
+                weights[i] += 1;                            
         }
         else {
-            for (auto& ci : m_clauses) 
-                if (ci.is_true()) 
-                    ci.m_weight = m_config.m_init_clause_weight;                
-                else 
-                    ci.m_weight = m_config.m_init_clause_weight + 1;                                       
+            double w = m_config.m_init_clause_weight;
+            for (unsigned i = 0; i < sz; ++i) 
+                weights[i] = w + (num_trues[i] == 0);
         }
         init_clause_data();   
         ++m_reinit_count;
@@ -385,31 +470,31 @@ namespace sat {
     }
 
     void ddfw::init_clause_data() {
-        for (unsigned v = 0; v < num_vars(); ++v) {
-            make_count(v) = 0;
-            reward(v) = 0;
-        }
+        m_make_counts.fill(0);
+        m_rewards.fill(0);
         m_unsat_vars.reset();
         m_unsat.reset();
-        unsigned sz = m_clauses.size();
+        unsigned sz = num_clauses();
         for (unsigned i = 0; i < sz; ++i) {
-            auto& ci = m_clauses[i];
-            clause const& c = get_clause(i);
-            ci.m_trues = 0;
-            ci.m_num_trues = 0;
-            for (literal lit : c) 
-                if (is_true(lit)) 
-                    ci.add(lit);                            
-            switch (ci.m_num_trues) {
+            auto c = get_clause(i);
+            unsigned trues = 0, num_trues = 0;
+            for (literal lit : c) {
+                bool t = is_true(lit);
+                num_trues += t;
+                trues += t ? lit.index() : 0;
+            }
+            m_trues[i] = trues;
+            m_num_trues[i] = num_trues;
+            switch (num_trues) {
             case 0:
                 for (literal lit : c) {
-                    inc_reward(lit, ci.m_weight);
+                    inc_reward(lit, m_weights[i]);
                     inc_make(lit);
                 }
                 m_unsat.insert_fresh(i);
                 break;
             case 1:
-                dec_reward(to_literal(ci.m_trues), ci.m_weight);
+                dec_reward(to_literal(trues), m_weights[i]);
                 break;
             default:
                 break;
@@ -422,7 +507,8 @@ namespace sat {
     }
     
     void ddfw::do_restart() {        
-        reinit_values();
+        if (!import_shared())
+            reinit_values();
         init_clause_data();
         m_restart_next += m_config.m_restart_base*get_luby(++m_restart_count);
     }
@@ -455,6 +541,19 @@ namespace sat {
             m_probs.push_back(-m_vars[v].m_reward_avg);         
     }
 
+    /**
+       \brief Continue from the best assignment of the other ddfw threads,
+       if it is better than ours and has not been imported yet.
+    */
+    bool ddfw::import_shared() {
+        if (!m_shared || m_shared->best() >= m_min_sz)
+            return false;
+        if (!m_shared->fetch(m_shared_seq, m_values))
+            return false;
+        ++m_models_imported;
+        return true;
+    }
+
     void ddfw::do_parallel_sync() {
         if (m_par->from_solver(*this)) 
             m_par->to_solver(*this);
@@ -479,6 +578,8 @@ namespace sat {
             m_steps_since_progress = 0;
             if (m_unsat.size() < 50 || m_min_sz * 10 > m_unsat.size() * 11)
                 save_model();
+            if (m_shared && m_shared->publish(m_unsat.size(), m_values))
+                ++m_models_published;
         }
         if (m_unsat.size() < m_min_sz) {
             m_models.reset();
@@ -510,8 +611,8 @@ namespace sat {
 
     unsigned ddfw::value_hash() const {
         unsigned s0 = 0, s1 = 0;
-        for (auto const& vi : m_vars) {
-            s0 += vi.m_value;
+        for (bool v : m_values) {
+            s0 += v;
             s1 += s0;
         }
         return s1;
@@ -525,10 +626,10 @@ namespace sat {
        3. select multiple clauses instead of just one per clause in unsat.
      */
 
-    bool ddfw::select_clause(double max_weight, clause_info const& cn, unsigned& n) {
-        if (cn.m_num_trues == 0 || cn.m_weight + 1e-5 < max_weight) 
+    bool ddfw::select_clause(double max_weight, unsigned cn, unsigned& n) {
+        if (m_num_trues[cn] == 0 || m_weights[cn] + 1e-5 < max_weight) 
             return false;
-        if (cn.m_weight > max_weight) {
+        if (m_weights[cn] > max_weight) {
             n = 2;
             return true;
         } 
@@ -536,17 +637,14 @@ namespace sat {
     }
 
     unsigned ddfw::select_max_same_sign(unsigned cf_idx) {
-        auto& ci = m_clauses[cf_idx];
         unsigned cl = UINT_MAX; // clause pointer to same sign, max weight satisfied clause.
-        clause const& c = *ci.m_clause;
         double max_weight = m_init_weight;
         unsigned n = 1;
-        for (literal lit : c) {
+        for (literal lit : get_clause(cf_idx)) {
             for (unsigned cn_idx : use_list(*this, lit)) {
-                auto& cn = m_clauses[cn_idx];
-                if (select_clause(max_weight, cn, n)) {
+                if (select_clause(max_weight, cn_idx, n)) {
                     cl = cn_idx;
-                    max_weight = cn.m_weight;
+                    max_weight = m_weights[cn_idx];
                 }
             }
         }
@@ -554,26 +652,23 @@ namespace sat {
     }
 
     void ddfw::transfer_weight(unsigned from, unsigned to, double w) {
-        auto& cf = m_clauses[to];
-        auto& cn = m_clauses[from];
-        if (cn.m_weight < w) 
+        if (m_weights[from] < w) 
             return;
-        cf.m_weight += w;
-        cn.m_weight -= w;
+        m_weights[to] += w;
+        m_weights[from] -= w;
         
         for (literal lit : get_clause(to)) 
             inc_reward(lit, w);
-        if (cn.m_num_trues == 1) 
-            inc_reward(to_literal(cn.m_trues), w);
+        if (m_num_trues[from] == 1) 
+            inc_reward(to_literal(m_trues[from]), w);
     }
 
     unsigned ddfw::select_random_true_clause() {
-        unsigned num_clauses = m_clauses.size();
+        unsigned num_clauses = this->num_clauses();
         unsigned rounds = 100 * num_clauses;
         for (unsigned i = 0; i < rounds; ++i) {
             unsigned idx = (m_rand() * m_rand()) % num_clauses;
-            auto & cn = m_clauses[idx];
-            if (cn.is_true() && cn.m_weight >= m_init_weight) 
+            if (is_true(idx) && m_weights[idx] >= m_init_weight) 
                 return idx;
         }
         return UINT_MAX;
@@ -591,26 +686,25 @@ namespace sat {
     void ddfw::shift_weights() {
         ++m_shifts;
         for (unsigned to_idx : m_unsat) {
-            SASSERT(!m_clauses[to_idx].is_true());
+            SASSERT(!is_true(to_idx));
             unsigned from_idx = select_max_same_sign(to_idx);
             if (from_idx == UINT_MAX || disregard_neighbor())
                 from_idx = select_random_true_clause();
             if (from_idx == UINT_MAX)
                 continue;
-            auto & cn = m_clauses[from_idx];
-            SASSERT(cn.is_true());
-            double w = calculate_transfer_weight(cn.m_weight);
+            SASSERT(is_true(from_idx));
+            double w = calculate_transfer_weight(m_weights[from_idx]);
             transfer_weight(from_idx, to_idx, w);
         }
         // DEBUG_CODE(invariant(););
     }
 
     std::ostream& ddfw::display(std::ostream& out) const {
-        unsigned num_cls = m_clauses.size();
+        unsigned num_cls = num_clauses();
         for (unsigned i = 0; i < num_cls; ++i) {
-            out << get_clause(i) << " ";
-            auto const& ci = m_clauses[i];
-            out << ci.m_num_trues << " " << ci.m_weight << "\n";
+            for (literal lit : get_clause(i))
+                out << lit << " ";
+            out << m_num_trues[i] << " " << m_weights[i] << "\n";
         }
         for (unsigned v = 0; v < num_vars(); ++v) {
             out << v << ": " << reward(v) << "\n";
@@ -640,26 +734,24 @@ namespace sat {
             double v_reward = 0;
             literal lit(v, !value(v));
             for (unsigned j : m_use_list[lit.index()]) {
-                clause_info const& ci = m_clauses[j];
-                if (ci.m_num_trues == 1) {
-                    SASSERT(lit == to_literal(ci.m_trues));
-                    v_reward -= ci.m_weight;
+                if (m_num_trues[j] == 1) {
+                    SASSERT(lit == to_literal(m_trues[j]));
+                    v_reward -= m_weights[j];
                 }
             }
             for (unsigned j : m_use_list[(~lit).index()]) {
-                clause_info const& ci = m_clauses[j];
-                if (ci.m_num_trues == 0) {
-                    v_reward += ci.m_weight;
+                if (m_num_trues[j] == 0) {
+                    v_reward += m_weights[j];
                 }                
             }
             IF_VERBOSE(0, if (v_reward != reward(v)) verbose_stream() << v << " " << v_reward << " " << reward(v) << "\n");
             // SASSERT(reward(v) == v_reward);
         }
         DEBUG_CODE(
-            for (auto const& ci : m_clauses) {
-                SASSERT(ci.m_weight > 0);
+            for (double w : m_weights) {
+                SASSERT(w > 0);
             }
-            for (unsigned i = 0; i < m_clauses.size(); ++i) {
+            for (unsigned i = 0; i < num_clauses(); ++i) {
                 bool found = false;
                 for (literal lit : get_clause(i)) {
                     if (is_true(lit)) found = true;
@@ -24,8 +24,10 @@
 #include "util/rlimit.h"
 #include "util/params.h"
 #include "util/ema.h"
+#include "util/stopwatch.h"
 #include "sat/sat_clause.h"
 #include "sat/sat_types.h"
+#include <atomic>
 
 namespace arith {
     class sls;
@@ -47,18 +49,43 @@ namespace sat {
         virtual void on_restart() = 0;
     };
 
+    /**
+       \brief Best assignment found by a group of ddfw threads.
+
+       A thread publishes its assignment when it leaves fewer clauses
+       unsatisfied than the best one so far, and the other threads pick it
+       up when they restart. No lock is taken: a writer that finds another
+       writer active gives up, and readers validate their copy with a
+       sequence number that is odd while a write is in progress.
+    */
+    class ddfw_shared {
+        std::atomic<unsigned>   m_best { UINT_MAX };
+        std::atomic<unsigned>   m_seq { 0 };
+        std::atomic<bool>       m_writing { false };
+        unsigned                m_num_words;
+        std::atomic<uint64_t>*  m_bits;
+    public:
+        ddfw_shared(unsigned num_vars);
+        ~ddfw_shared();
+        unsigned best() const { return m_best.load(std::memory_order_relaxed); }
+        bool publish(unsigned num_unsat, bool_vector const& values);
+        /**
+           \brief Copy the best assignment into \c values if it changed since \c seq.
+        */
+        bool fetch(unsigned& seq, bool_vector& values) const;
+    };
+
     class ddfw : public i_local_search {
         friend class arith::sls;
     public:
-        struct clause_info {
-            clause_info(clause* cl, double init_weight): m_weight(init_weight), m_clause(cl) {}
-            double   m_weight;           // weight of clause
-            unsigned m_trues = 0;        // set of literals that are true
-            unsigned m_num_trues = 0;    // size of true set
-            clause*  m_clause;
-            bool is_true() const { return m_num_trues > 0; }
-            void add(literal lit) { ++m_num_trues; m_trues += lit.index(); }
-            void del(literal lit) { SASSERT(m_num_trues > 0); --m_num_trues; m_trues -= lit.index(); }
+        class clause_lits {
+            literal const* m_begin;
+            literal const* m_end;
+        public:
+            clause_lits(literal const* b, literal const* e): m_begin(b), m_end(e) {}
+            literal const* begin() const { return m_begin; }
+            literal const* end() const { return m_end; }
+            unsigned size() const { return static_cast<unsigned>(m_end - m_begin); }
         };
 
         class use_list {
@@ -96,10 +123,7 @@ namespace sat {
 
         struct var_info {
             var_info() {}
-            bool     m_value = false;
-            double   m_reward = 0;
             double   m_last_reward = 0;
-            unsigned m_make_count = 0;
             int      m_bias = 0;
             bool     m_external = false;
             ema      m_reward_avg = 1e-5;
@@ -107,9 +131,21 @@ namespace sat {
         
         config               m_config;
         reslimit             m_limit;
-        clause_allocator     m_alloc;
-        svector<clause_info> m_clauses;
         literal_vector       m_assumptions;        
+
+        // Clauses are stored as a struct of arrays: the literals of clause i are
+        // m_lits[m_lit_start[i]..m_lit_start[i+1]), the other fields have one entry per clause.
+        // The flip loops then touch only the fields they update.
+        literal_vector       m_lits;
+        unsigned_vector      m_lit_start;
+        svector<double>      m_weights;     // weight of clause
+        unsigned_vector      m_trues;       // sum of the indices of true literals
+        unsigned_vector      m_num_trues;   // number of true literals
+
+        // per variable state updated on every flip, kept apart from the rest
+        bool_vector          m_values;
+        svector<double>      m_rewards;
+        unsigned_vector      m_make_counts;
         svector<var_info>    m_vars;        // var -> info
         svector<double>      m_probs;       // var -> probability of flipping
         svector<double>      m_scores;      // reward -> score
@@ -130,8 +166,12 @@ namespace sat {
         unsigned         m_min_sz = 0, m_steps_since_progress = 0;
         u_map<unsigned>  m_models;
         stopwatch        m_stopwatch;
+        stopwatch        m_search_time;
 
         parallel*        m_par;
+        ddfw_shared*     m_shared = nullptr;
+        unsigned         m_shared_seq = 0;
+        unsigned         m_models_published = 0, m_models_imported = 0;
         local_search_plugin* m_plugin = nullptr;
 
         void flatten_use_list(); 
@@ -144,15 +184,15 @@ namespace sat {
 
         inline unsigned num_vars() const { return m_vars.size(); }
 
-        inline unsigned& make_count(bool_var v) { return m_vars[v].m_make_count; }
+        inline unsigned& make_count(bool_var v) { return m_make_counts[v]; }
 
-        inline bool& value(bool_var v) { return m_vars[v].m_value; }
+        inline bool& value(bool_var v) { return m_values[v]; }
 
-        inline bool value(bool_var v) const { return m_vars[v].m_value; }
+        inline bool value(bool_var v) const { return m_values[v]; }
 
-        inline double& reward(bool_var v) { return m_vars[v].m_reward; }
+        inline double& reward(bool_var v) { return m_rewards[v]; }
 
-        inline double reward(bool_var v) const { return m_vars[v].m_reward; }
+        inline double reward(bool_var v) const { return m_rewards[v]; }
 
         inline double plugin_reward(bool_var v) { return is_external(v) ? (m_vars[v].m_last_reward = m_plugin->reward(v)) : reward(v); }
 
@@ -166,11 +206,20 @@ namespace sat {
 
         inline bool is_true(literal lit) const { return value(lit.var()) != lit.sign(); }
 
-        inline clause const& get_clause(unsigned idx) const { return *m_clauses[idx].m_clause; }
+        inline clause_lits get_clause(unsigned idx) const { 
+            literal const* base = m_lits.data();
+            return clause_lits(base + m_lit_start[idx], base + m_lit_start[idx + 1]); 
+        }
 
-        inline double get_weight(unsigned idx) const { return m_clauses[idx].m_weight; }
+        inline double get_weight(unsigned idx) const { return m_weights[idx]; }
 
-        inline bool is_true(unsigned idx) const { return m_clauses[idx].is_true(); }
+        inline bool is_true(unsigned idx) const { return m_num_trues[idx] > 0; }
+
+        inline void add_true(unsigned idx, literal lit) { ++m_num_trues[idx]; m_trues[idx] += lit.index(); }
+
+        inline void del_true(unsigned idx, literal lit) { SASSERT(m_num_trues[idx] > 0); --m_num_trues[idx]; m_trues[idx] -= lit.index(); }
+
+        void reserve_var(bool_var v);
 
         void update_reward_avg(bool_var v) { m_vars[v].m_reward_avg.update(reward(v)); }
 
@@ -220,7 +269,7 @@ namespace sat {
         // reinitialize weights activity
         bool should_reinit_weights();        
         void do_reinit_weights();
-        inline bool select_clause(double max_weight, clause_info const& cn, unsigned& n);
+        inline bool select_clause(double max_weight, unsigned cn, unsigned& n);
 
         // restart activity
         bool should_restart();
@@ -232,6 +281,7 @@ namespace sat {
         // parallel integration
         bool should_parallel_sync();
         void do_parallel_sync();
+        bool import_shared();
 
         void log();
 
@@ -253,12 +303,14 @@ namespace sat {
 
     public:
 
-        ddfw(): m_par(nullptr) {}
+        ddfw(): m_par(nullptr) { m_lit_start.push_back(0); }
 
         ~ddfw() override;
 
         void set(local_search_plugin* p) { m_plugin = p; }
 
+        void set_shared(ddfw_shared* s) { m_shared = s; }
+
         lbool check(unsigned sz, literal const* assumptions, parallel* p) override;
 
         void updt_params(params_ref const& p) override;
@@ -279,16 +331,20 @@ namespace sat {
         unsigned num_non_binary_clauses() const override { return m_num_non_binary_clauses; }
         void reinit(solver& s, bool_vector const& phase) override;
 
-        void collect_statistics(statistics& st) const override {} 
+        void collect_statistics(statistics& st) const override;
 
         double get_priority(bool_var v) const override { return m_probs[v]; }
 
         // access clause information and state of Boolean search
         indexed_uint_set& unsat_set() { return m_unsat; }
 
-        unsigned num_clauses() const { return m_clauses.size(); }
+        unsigned num_clauses() const { return m_weights.size(); }
+
+        clause_lits get_clause_lits(unsigned idx) const { return get_clause(idx); }
+
+        double get_clause_weight(unsigned idx) const { return m_weights[idx]; }
 
-        clause_info& get_clause_info(unsigned idx) { return m_clauses[idx]; }
+        unsigned get_num_trues(unsigned idx) const { return m_num_trues[idx]; }
 
         void remove_assumptions();
 
@@ -21,6 +21,7 @@ Notes:
 --*/
 
 #include "util/rational.h"
+#include "util/async_writer.h"
 #include "sat/sat_solver.h"
 #include "sat/sat_drat.h"
 
@@ -34,10 +35,14 @@ namespace sat {
             m_out = alloc(std::ofstream, s.get_config().m_drat_file.str(), mode);
             if (s.get_config().m_drat_binary) 
                 std::swap(m_out, m_bout);            
+            if (s.get_config().m_drat_async)
+                m_writer = alloc(async_writer, m_out ? *m_out : *m_bout);
         }
     }
 
     drat::~drat() {
+        dealloc(m_writer);
+        m_writer = nullptr;
         if (m_out) m_out->flush();
         if (m_bout) m_bout->flush();
         dealloc(m_out);
@@ -56,6 +61,18 @@ namespace sat {
         m_activity    = s.get_config().m_drat_activity;
     }
 
+    void drat::write(std::ostream& out, char const* data, unsigned len) {
+        if (m_writer)
+            m_writer->write(data, len);
+        else
+            out.write(data, len);
+    }
+
+    void drat::write(std::string const& str) {
+        if (m_out)
+            write(*m_out, str.data(), static_cast<unsigned>(str.size()));
+    }
+
     std::ostream& drat::pp(std::ostream& out, status st) const {
         if (st.is_deleted())
             out << "d";
@@ -110,20 +127,22 @@ namespace sat {
             len += static_cast<unsigned>(lastd - d);
             buffer[len++] = ' ';
             if (static_cast<size_t>(len) + 50 > sizeof(buffer)) {
-                m_out->write(buffer, len);
+                write(*m_out, buffer, len);
                 len = 0;
             }
         }
         buffer[len++] = '0';
         buffer[len++] = '\n';
-        m_out->write(buffer, len);
+        write(*m_out, buffer, len);
     }
 
     void drat::dump_activity() {
-        (*m_out) << "c activity ";
+        std::ostringstream strm;
+        strm << "c activity ";
         for (unsigned v = 0; v < s.num_vars(); ++v) 
-            (*m_out) << s.m_activity[v] << " ";
-        (*m_out) << "\n";
+            strm << s.m_activity[v] << " ";
+        strm << "\n";
+        write(strm.str());
     }
 
     void drat::bdump(unsigned n, literal const* c, status st) {
@@ -146,14 +165,14 @@ namespace sat {
                 if (v) ch |= 128;
                 buffer[len++] = ch;
                 if (len == sizeof(buffer)) {
-                    m_bout->write(buffer, len);
+                    write(*m_bout, buffer, len);
                     len = 0;
                 }
             }
             while (v);
         }
         buffer[len++] = 0;
-        m_bout->write(buffer, len);
+        write(*m_bout, buffer, len);
     }
 
     bool drat::is_cleaned(clause& c) const {
@@ -626,7 +645,7 @@ namespace sat {
 
     void drat::add() {
         ++m_stats.m_num_add;
-        if (m_out) (*m_out) << "0\n";
+        if (m_out) write(*m_out, "0\n", 2);
         if (m_bout) bdump(0, nullptr, status::redundant());
         if (m_check_unsat) {
             verify(0, nullptr);
@@ -768,6 +787,10 @@ namespace sat {
         st.update("num-drat", m_stats.m_num_drat);
         st.update("num-add", m_stats.m_num_add);
         st.update("num-del", m_stats.m_num_del);
+        if (m_writer) {
+            st.update("drat bytes", static_cast<double>(m_writer->num_bytes()));
+            st.update("drat writer stalls", m_writer->num_stalls());
+        }
     }
 
 
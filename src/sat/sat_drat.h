@@ -23,6 +23,8 @@ Notes:
 
 #include "sat_types.h"
 
+class async_writer;
+
 namespace sat {
     class justification;
     class clause;
@@ -52,6 +54,7 @@ namespace sat {
         clause_allocator        m_alloc;
         std::ostream*           m_out = nullptr;
         std::ostream*           m_bout = nullptr;
+        async_writer*           m_writer = nullptr; // writes m_out or m_bout in the background
         svector<std::pair<clause&, status>> m_proof;
         svector<std::pair<literal, clause*>> m_units;
         vector<watch>           m_watches;
@@ -65,6 +68,7 @@ namespace sat {
 
 
         void dump_activity();
+        void write(std::ostream& out, char const* data, unsigned len);
         void dump(unsigned n, literal const* c, status st);
         void bdump(unsigned n, literal const* c, status st);
         void append(literal l, status st);
@@ -113,6 +117,11 @@ namespace sat {
 
         std::ostream* out() { return m_out; }
 
+        /**
+           \brief Append text, such as a comment, to the textual proof.
+        */
+        void write(std::string const& s);
+
         bool is_cleaned(clause& c) const;        
         void del(literal l);
         void del(literal l1, literal l2);
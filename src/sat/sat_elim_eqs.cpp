@@ -18,13 +18,15 @@ Revision History:
 --*/
 #include "sat/sat_elim_eqs.h"
 #include "sat/sat_solver.h"
+#include "sat/sat_parallel_for.h"
 #include "util/trace.h"
 
 namespace sat {
     
-    elim_eqs::elim_eqs(solver & s):
+    elim_eqs::elim_eqs(solver & s, unsigned num_threads):
         m_solver(s),
-        m_to_delete(nullptr) {
+        m_to_delete(nullptr),
+        m_num_threads(num_threads) {
     }
 
     elim_eqs::~elim_eqs() {
@@ -95,7 +97,34 @@ namespace sat {
         }
     }
 
+    /**
+       \brief substitute and sort the literals of affected clauses in parallel.
+       The watched literals of affected clauses are saved so that the clauses
+       can be detached afterwards.
+    */
+    void elim_eqs::normalize_clauses(literal_vector const & roots, clause_vector const & cs) {
+        m_affected.reset();
+        m_affected.resize(cs.size(), false);
+        m_watch_lits.reset();
+        m_watch_lits.resize(cs.size(), std::make_pair(null_literal, null_literal));
+        parallel_for(m_num_threads, cs.size(), [&](unsigned begin, unsigned end) {
+            for (unsigned k = begin; k < end; ++k) {
+                clause & c = *cs[k];
+                if (all_of(c, [&](literal l) { return l == norm(roots, l); }))
+                    continue;
+                m_affected[k] = true;
+                m_watch_lits[k] = std::make_pair(c[0], c[1]);
+                for (literal & l : c)
+                    l = norm(roots, l);
+                std::sort(c.begin(), c.end());
+            }
+        });
+    }
+
     void elim_eqs::cleanup_clauses(literal_vector const & roots, clause_vector & cs) {
+        bool parallel = m_num_threads > 1 && !m_solver.m_config.m_drat;
+        if (parallel)
+            normalize_clauses(roots, cs);
         clause_vector::iterator it  = cs.begin();
         clause_vector::iterator it2 = it;
         clause_vector::iterator end = cs.end();
@@ -104,36 +133,51 @@ namespace sat {
             TRACE("sats", tout << "processing: " << c << "\n";);
             unsigned sz    = c.size();
             unsigned i;
-            for (i = 0; i < sz; i++) {
-                literal l = c[i];
-                literal r = norm(roots, l);
-                if (l != r)
-                    break;
-            }
-            if (i == sz) {
-                // clause was not affected
-                *it2 = *it;
-                it2++;
-                continue;
-            }
-            if (!c.frozen()) {
-                m_solver.detach_clause(c);
+            if (parallel) {
+                unsigned k = static_cast<unsigned>(it - cs.begin());
+                if (!m_affected[k]) {
+                    *it2 = *it;
+                    it2++;
+                    continue;
+                }
+                if (!c.frozen()) {
+                    clause_offset cls_off = m_solver.get_offset(c);
+                    erase_clause_watch(m_solver.get_wlist(~m_watch_lits[k].first), cls_off);
+                    erase_clause_watch(m_solver.get_wlist(~m_watch_lits[k].second), cls_off);
+                }
             }
+            else {
+                for (i = 0; i < sz; i++) {
+                    literal l = c[i];
+                    literal r = norm(roots, l);
+                    if (l != r)
+                        break;
+                }
+                if (i == sz) {
+                    // clause was not affected
+                    *it2 = *it;
+                    it2++;
+                    continue;
+                }
+                if (!c.frozen()) {
+                    m_solver.detach_clause(c);
+                }
             
-            // save clause to be deleted for drat
-            if (m_solver.m_config.m_drat) {
-                if (!m_to_delete) m_to_delete = alloc(tmp_clause);
-                m_to_delete->set(sz, c.begin(), c.is_learned());
-            }
+                // save clause to be deleted for drat
+                if (m_solver.m_config.m_drat) {
+                    if (!m_to_delete) m_to_delete = alloc(tmp_clause);
+                    m_to_delete->set(sz, c.begin(), c.is_learned());
+                }
 
-            // apply substitution
-            for (i = 0; i < sz; i++) {   
-                literal lit = c[i];
-                c[i] = norm(roots, lit);
-                VERIFY(c[i] == norm(roots, c[i]));
-                VERIFY(!m_solver.was_eliminated(c[i].var()) || lit == c[i]);
+                // apply substitution
+                for (i = 0; i < sz; i++) {   
+                    literal lit = c[i];
+                    c[i] = norm(roots, lit);
+                    VERIFY(c[i] == norm(roots, c[i]));
+                    VERIFY(!m_solver.was_eliminated(c[i].var()) || lit == c[i]);
+                }
+                std::sort(c.begin(), c.end());
             }
-            std::sort(c.begin(), c.end());
             for (literal l : c) VERIFY(l == norm(roots, l));
             TRACE("sats", tout << "after normalization/sorting: " << c << "\n"; tout.flush(););
             DEBUG_CODE({
@@ -177,6 +221,13 @@ namespace sat {
             switch (j) {
             case 0:
                 m_solver.set_conflict();
+                if (parallel) {
+                    // the remaining affected clauses are already rewritten,
+                    // their watches have to be updated.
+                    *it2 = *it;
+                    it2++;
+                    break;
+                }
                 for (; it != end; ++it) {
                     *it2 = *it;
                     it2++;
@@ -34,14 +34,22 @@ namespace sat {
         svector<bin> m_new_bin;
         solver & m_solver;
         tmp_clause* m_to_delete;
+        unsigned m_num_threads;
+        svector<char> m_affected;
+        svector<std::pair<literal, literal>> m_watch_lits;
         void drat_delete_clause();
         void save_elim(literal_vector const & roots, bool_var_vector const & to_elim);
+        void normalize_clauses(literal_vector const & roots, clause_vector const & cs);
         void cleanup_clauses(literal_vector const & roots, clause_vector & cs);
         void cleanup_bin_watches(literal_vector const & roots);
         bool check_clauses(literal_vector const & roots) const;
         bool check_clause(clause const& c, literal_vector const& roots) const;
     public:
-        elim_eqs(solver & s);
+        /**
+           \brief with num_threads > 1, literals of clauses are substituted
+           in parallel unless a proof is produced.
+        */
+        elim_eqs(solver & s, unsigned num_threads = 1);
         ~elim_eqs();
         void operator()(literal_vector const & roots, bool_var_vector const & to_elim);
         void operator()(union_find<>& uf);
@@ -153,6 +153,21 @@ namespace sat {
         }
     }
 
+    /**
+       \brief Learned clauses are split in three tiers by glue.
+       Clauses in the core tier (glue <= gc.tier1_glue) are never deleted,
+       clauses in the mid tier (glue <= gc.tier2_glue) survive as long as
+       they participate in conflict analysis between two gc rounds.
+       Tiers are only used if gc.tiers is enabled.
+    */
+    bool solver::keep_tier(clause & c) const {
+        if (!m_config.m_gc_tiers)
+            return false;
+        if (c.glue() <= m_config.m_gc_tier1_glue)
+            return true;
+        return c.glue() <= m_config.m_gc_tier2_glue && c.was_used_in_conflict();
+    }
+
     /**
        \brief GC (the second) half of the clauses in the database.
     */
@@ -163,7 +178,7 @@ namespace sat {
         unsigned j      = new_sz;
         for (unsigned i = new_sz; i < sz; i++) {
             clause & c = *(m_learned[i]);
-            if (can_delete(c)) {
+            if (!keep_tier(c) && can_delete(c)) {
                 detach_clause(c);
                 del_clause(c);
             }
@@ -175,6 +190,9 @@ namespace sat {
         new_sz = j;
         m_stats.m_gc_clause += sz - new_sz;
         m_learned.shrink(new_sz);
+        if (m_config.m_gc_tiers)
+            for (clause* cp : m_learned)
+                cp->unmark_used_in_conflict();
         IF_VERBOSE(SAT_VB_LVL, verbose_stream() << "(sat-gc :strategy " << st_name << " :deleted " << (sz - new_sz) << ")\n";);
     }
 
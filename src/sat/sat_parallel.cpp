@@ -22,66 +22,67 @@ Revision History:
 
 namespace sat {
 
-    void parallel::vector_pool::next(unsigned& index) {
-        SASSERT(index < m_size);
-        unsigned n = index + 2 + get_length(index);
-        index = (n >= m_size) ? 0 : n;
-    }
-
-    void parallel::vector_pool::reserve(unsigned num_threads, unsigned sz) {
-        m_vectors.reset();
-        m_vectors.resize(sz, 0);
-        m_heads.reset();
-        m_heads.resize(num_threads, 0);
-        m_at_end.reset();
-        m_at_end.resize(num_threads, true);
-        m_tail = 0;
-        m_size = sz;
-    }
-    
-    void parallel::vector_pool::begin_add_vector(unsigned owner, unsigned n) {
-        SASSERT(m_tail < m_size);
-        unsigned capacity = n + 2;
-        m_vectors.reserve(m_size + capacity, 0);
-        IF_VERBOSE(3, verbose_stream() << owner << ": begin-add " << n << " tail: " << m_tail << " size: " << m_size << "\n";);
-        for (unsigned i = 0; i < m_heads.size(); ++i) {
-            while (m_tail < m_heads[i] && m_heads[i] < m_tail + capacity) {
-                next(m_heads[i]);
-            }
-            m_at_end[i] = false;
+    void parallel::clause_ring::reset(unsigned capacity) {
+        if (m_data)
+            dealloc_vect(m_data, m_capacity);
+        m_data = nullptr;
+        m_capacity = 0;
+        if (capacity > 0) {
+            m_capacity = 1;
+            while (m_capacity < capacity)
+                m_capacity *= 2;
+            m_data = alloc_vect<std::atomic<unsigned>>(m_capacity);
         }
-        m_vectors[m_tail++] = owner;
-        m_vectors[m_tail++] = n;    
-    }
-
-    void parallel::vector_pool::add_vector_elem(unsigned e) {
-        m_vectors[m_tail++] = e;
+        m_mask = m_capacity - 1;
+        m_reserved = 0;
+        m_tail = 0;
     }
 
-    void parallel::vector_pool::end_add_vector() {
-        if (m_tail >= m_size) 
-            m_tail = 0;
+    /**
+       Entries are laid out as [n, glue, lit_1, ..., lit_n]. 
+       The writer announces the range it is about to overwrite in m_reserved before 
+       touching the data, and publishes the entry by advancing m_tail.
+    */
+    void parallel::clause_ring::push(unsigned glue, unsigned n, literal const* lits) {
+        uint64_t sz = n + 2;
+        if (2 * sz > m_capacity)
+            return;
+        uint64_t t = m_tail.load(std::memory_order_relaxed);
+        m_reserved.store(t + sz, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_data[t & m_mask].store(n, std::memory_order_relaxed);
+        m_data[(t + 1) & m_mask].store(glue, std::memory_order_relaxed);
+        for (unsigned i = 0; i < n; ++i)
+            m_data[(t + 2 + i) & m_mask].store(lits[i].index(), std::memory_order_relaxed);
+        m_tail.store(t + sz, std::memory_order_release);
     }
 
-
-    bool parallel::vector_pool::get_vector(unsigned owner, unsigned& n, unsigned const*& ptr) {
-        unsigned head = m_heads[owner];      
-        unsigned iterations = 0;
-        while (head != m_tail || !m_at_end[owner]) {
-            ++iterations;
-            SASSERT(head < m_size && m_tail < m_size);            
-            bool is_self = owner == get_owner(head);
-            next(m_heads[owner]);
-            IF_VERBOSE(static_cast<unsigned>(iterations > m_size ? 0 : 3), verbose_stream() << owner << ": [" << head << ":" << m_heads[owner] << "] tail: " << m_tail << "\n";);
-            m_at_end[owner] = (m_heads[owner] == m_tail);
-            if (!is_self) {
-                n = get_length(head);
-                ptr = get_ptr(head);
-                return true;
-            }
-            head = m_heads[owner];
+    /**
+       Copy the entry at head into lits and advance head. 
+       The entry is discarded if the writer has started to overwrite it while it was copied.
+    */
+    bool parallel::clause_ring::pop(uint64_t& head, unsigned& glue, literal_vector& lits) const {
+        uint64_t t = m_tail.load(std::memory_order_acquire);
+        if (head == t)
+            return false;
+        if (t - head > m_capacity) {
+            head = t;
+            return false;
+        }
+        unsigned n = m_data[head & m_mask].load(std::memory_order_relaxed);
+        glue = m_data[(head + 1) & m_mask].load(std::memory_order_relaxed);
+        bool valid = 2 * (n + 2) <= m_capacity && head + n + 2 <= t;
+        lits.reset();
+        for (unsigned i = 0; valid && i < n; ++i)
+            lits.push_back(to_literal(m_data[(head + 2 + i) & m_mask].load(std::memory_order_relaxed)));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (!valid || m_reserved.load(std::memory_order_relaxed) - head > m_capacity) {
+            // lapped by the writer while copying
+            head = m_tail.load(std::memory_order_acquire);
+            return false;
         }
-        return false;
+        head += n + 2;
+        return true;
     }
 
     parallel::parallel(solver& s): m_num_clauses(0), m_consumer_ready(false), m_scoped_rlimit(s.rlimit()) {}
@@ -136,62 +137,73 @@ namespace sat {
         }
     }
 
+    void parallel::reserve(unsigned num_owners, unsigned sz) {
+        m_rings.reset();
+        m_heads.reset();
+        for (unsigned i = 0; i < num_owners; ++i) {
+            m_rings.push_back(alloc(clause_ring));
+            m_rings.back()->reset(sz);
+        }
+        m_heads.resize(num_owners);
+        for (auto& heads : m_heads)
+            heads.resize(num_owners, 0);
+    }
+
     void parallel::share_clause(solver& s, literal l1, literal l2) {        
         if (s.get_config().m_num_threads == 1 || s.m_par_syncing_clauses) return;
         flet<bool> _disable_sync_clause(s.m_par_syncing_clauses, true);
         IF_VERBOSE(3, verbose_stream() << s.m_par_id << ": share " <<  l1 << " " << l2 << "\n";);
-        {
-            lock_guard lock(m_mux);
-            m_pool.begin_add_vector(s.m_par_id, 2);
-            m_pool.add_vector_elem(l1.index());
-            m_pool.add_vector_elem(l2.index());            
-            m_pool.end_add_vector();
-        }        
+        literal lits[2] = { l1, l2 };
+        m_rings[s.m_par_id]->push(1, 2, lits);
     }
 
     void parallel::share_clause(solver& s, clause const& c) {        
         if (s.get_config().m_num_threads == 1 || !enable_add(c) || s.m_par_syncing_clauses) return;
         flet<bool> _disable_sync_clause(s.m_par_syncing_clauses, true);
-        unsigned n = c.size();
         unsigned owner = s.m_par_id;
         IF_VERBOSE(3, verbose_stream() << owner << ": share " <<  c << "\n";);
-        lock_guard lock(m_mux);
-        m_pool.begin_add_vector(owner, n);                
-        for (unsigned i = 0; i < n; ++i) 
-            m_pool.add_vector_elem(c[i].index());
-        m_pool.end_add_vector();        
+        m_rings[owner]->push(c.glue(), c.size(), c.begin());
     }
 
     void parallel::get_clauses(solver& s) {
         if (s.m_par_syncing_clauses) return;
         flet<bool> _disable_sync_clause(s.m_par_syncing_clauses, true);
-        lock_guard lock(m_mux);
         _get_clauses(s);        
     }
 
     void parallel::_get_clauses(solver& s) {
-        unsigned n;
-        unsigned const* ptr;
+        unsigned glue;
+        literal_vector lits;
         unsigned owner = s.m_par_id;
-        while (m_pool.get_vector(owner, n, ptr)) {
-            m_lits.reset();
-            bool usable_clause = true;
-            for (unsigned i = 0; usable_clause && i < n; ++i) {
-                literal lit(to_literal(ptr[i]));                
-                m_lits.push_back(lit);
-                usable_clause = lit.var() <= s.m_par_num_vars && !s.was_eliminated(lit.var());
-            }
-            IF_VERBOSE(3, verbose_stream() << s.m_par_id << ": retrieve " << m_lits << "\n";);
-            SASSERT(n >= 2);
-            if (usable_clause) {
-                s.mk_clause_core(m_lits.size(), m_lits.data(), sat::status::redundant());
+        svector<uint64_t>& heads = m_heads[owner];
+        for (unsigned i = 0; i < m_rings.size(); ++i) {
+            if (i == owner)
+                continue;
+            clause_ring const& ring = *m_rings[i];
+            while (ring.pop(heads[i], glue, lits)) {
+                SASSERT(lits.size() >= 2);
+                if (!enable_share(lits.size(), glue))
+                    continue;
+                bool usable_clause = true;
+                for (unsigned j = 0; usable_clause && j < lits.size(); ++j) {
+                    literal lit = lits[j];
+                    usable_clause = lit.var() <= s.m_par_num_vars && !s.was_eliminated(lit.var());
+                }
+                IF_VERBOSE(3, verbose_stream() << s.m_par_id << ": retrieve " << lits << "\n";);
+                if (usable_clause) {
+                    s.mk_clause_core(lits.size(), lits.data(), sat::status::redundant());
+                }
             }
-        }        
+        }
     }
 
     bool parallel::enable_add(clause const& c) const {
+        return enable_share(c.size(), c.glue());
+    }
+
+    bool parallel::enable_share(unsigned sz, unsigned glue) {
         // plingeling, glucose heuristic:
-        return (c.size() <= 40 && c.glue() <= 8) || c.glue() <= 2;
+        return (sz <= 40 && glue <= 8) || glue <= 2;
     }
 
     void parallel::_from_solver(solver& s) {
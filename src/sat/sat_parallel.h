@@ -24,31 +24,32 @@ Revision History:
 #include "util/rlimit.h"
 #include "util/scoped_ptr_vector.h"
 #include "util/mutex.h"
+#include <atomic>
 
 namespace sat {
 
     class parallel {
 
-        // shared pool of learned clauses.
-        class vector_pool {
-            unsigned_vector m_vectors;
-            unsigned        m_size{ 0 };
-            unsigned        m_tail{ 0 };
-            unsigned_vector m_heads;
-            bool_vector   m_at_end;
-            void next(unsigned& index);
-            unsigned get_owner(unsigned index) const { return m_vectors[index]; }
-            unsigned get_length(unsigned index) const { return m_vectors[index+1]; }
-            unsigned const* get_ptr(unsigned index) const { return m_vectors.data() + index + 2; }
+        // single-writer/multi-reader ring of learned clauses.
+        // Each solver owns one ring and is the only thread writing to it.
+        // Readers keep their own read positions and copy entries out without taking a lock.
+        // A reader that falls more than a ring behind the writer skips to the current tail.
+        class clause_ring {
+            std::atomic<unsigned>* m_data { nullptr };
+            unsigned               m_capacity { 0 };
+            unsigned               m_mask { 0 };
+            std::atomic<uint64_t>  m_reserved { 0 }; // end of the entry being written
+            std::atomic<uint64_t>  m_tail { 0 };     // end of the last published entry
         public:
-            void reserve(unsigned num_owners, unsigned sz);
-            void begin_add_vector(unsigned owner, unsigned n);
-            void end_add_vector();
-            void add_vector_elem(unsigned e);
-            bool get_vector(unsigned owner, unsigned& n, unsigned const*& ptr);
+            ~clause_ring() { reset(0); }
+            void reset(unsigned capacity);
+            uint64_t tail() const { return m_tail.load(std::memory_order_acquire); }
+            void push(unsigned glue, unsigned n, literal const* lits);
+            bool pop(uint64_t& head, unsigned& glue, literal_vector& lits) const;
         };
 
         bool enable_add(clause const& c) const;
+        static bool enable_share(unsigned sz, unsigned glue);
         void _get_clauses(solver& s);
         void _from_solver(solver& s);
         void _to_solver(solver& s);
@@ -58,8 +59,8 @@ namespace sat {
         typedef hashtable<unsigned, u_hash, u_eq> index_set;
         literal_vector m_units;
         index_set      m_unit_set;
-        literal_vector m_lits;
-        vector_pool    m_pool;
+        scoped_ptr_vector<clause_ring> m_rings;
+        vector<svector<uint64_t>>      m_heads;  // m_heads[reader][writer] is owned by reader
         mutex          m_mux;
 
         // for exchange with local search:
@@ -82,8 +83,8 @@ namespace sat {
 
         void push_child(reslimit& rl);
 
-        // reserve space
-        void reserve(unsigned num_owners, unsigned sz) { m_pool.reserve(num_owners, sz); }
+        // reserve a ring of (at least) sz words for each owner
+        void reserve(unsigned num_owners, unsigned sz);
 
         solver& get_solver(unsigned i) { return *m_solvers[i]; }
 
@@ -92,12 +93,12 @@ namespace sat {
         // exchange unit literals
         void exchange(solver& s, literal_vector const& in, unsigned& limit, literal_vector& out);
 
-        // add clause to shared clause pool
+        // add clause to the ring owned by s
         void share_clause(solver& s, clause const& c);
 
         void share_clause(solver& s, literal l1, literal l2);
         
-        // receive clauses from shared clause pool
+        // receive clauses from the rings of the other solvers
         void get_clauses(solver& s);
 
         // exchange from solver state to local search and back.
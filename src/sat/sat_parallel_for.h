@@ -0,0 +1,66 @@
+/*++
+  Copyright (c) 2024 Microsoft Corporation
+
+  Module Name:
+
+   sat_parallel_for.h
+
+  Abstract:
+
+    Split an index range in chunks that are processed by separate threads.
+    Used by in-processing passes whose scans over literals or clauses
+    are independent of each other.
+
+  --*/
+
+#pragma once
+
+#include "util/vector.h"
+
+#ifndef SINGLE_THREAD
+#include <exception>
+#include <thread>
+#endif
+
+namespace sat {
+
+    /**
+       \brief apply f(begin, end) to num_threads consecutive chunks of [0, n).
+       The first chunk is processed by the calling thread.
+       Exceptions thrown by f, such as out of memory or resource limit
+       exceptions, are caught in the thread that processes the chunk.
+       The exception of the first failing chunk is rethrown on the 
+       calling thread after all threads are joined.
+    */
+    template<typename F>
+    void parallel_for(unsigned num_threads, unsigned n, F const& f) {
+        num_threads = std::max(1u, std::min(num_threads, n));
+#ifndef SINGLE_THREAD
+        if (num_threads > 1) {
+            unsigned chunk = (n + num_threads - 1) / num_threads;
+            vector<std::exception_ptr> errors(num_threads);
+            auto run = [&f, &errors](unsigned i, unsigned begin, unsigned end) {
+                try {
+                    f(begin, end);
+                }
+                catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            };
+            vector<std::thread> threads(num_threads - 1);
+            for (unsigned i = 1; i < num_threads; ++i) {
+                unsigned begin = std::min(n, i * chunk), end = std::min(n, begin + chunk);
+                threads[i - 1] = std::thread([&run, i, begin, end]() { run(i, begin, end); });
+            }
+            run(0, 0, std::min(n, chunk));
+            for (auto& th : threads)
+                th.join();
+            for (auto const& e : errors)
+                if (e)
+                    std::rethrow_exception(e);
+            return;
+        }
+#endif
+        f(0, n);
+    }
+}
@@ -16,7 +16,10 @@
 
 --*/
 
+#include "util/stopwatch.h"
 #include "sat/sat_proof_trim.h"
+#include "sat/sat_parallel_for.h"
+#include <atomic>
 
 namespace sat {
 
@@ -28,6 +31,8 @@ namespace sat {
     */        
 
     vector<std::pair<unsigned, unsigned_vector>> proof_trim::trim() {
+        stopwatch sw;
+        sw.start();
         m_result.reset();
         m_propagated.resize(num_vars(), false);
 
@@ -46,6 +51,7 @@ namespace sat {
                 revive(cl, clp);
                 continue;
             }            
+            ++m_stats.m_num_steps;
             IF_VERBOSE(10, s.display(verbose_stream()));
             prune_trail(cl, clp);
             IF_VERBOSE(10, s.display(verbose_stream() << "\n"));
@@ -61,6 +67,9 @@ namespace sat {
             conflict_analysis_core(cl, clp);            
         }
         m_result.reverse();
+        m_stats.m_num_core = m_result.size();
+        sw.stop();
+        m_stats.m_trim_time += sw.get_seconds();
         return m_result;
     }
     
@@ -77,32 +86,42 @@ namespace sat {
      * Remove all clauses after cl that are in the cone of influence of cl.
      * The coi is defined inductively: C is in coi of cl if it contains ~l
      * or it contains ~l' where l' is implied by a clause in the coi of cl.
-     * Possible optimization: 
-     * - check if clause contains a literal that is on implied on the trail
-     *   if it doesn't contain any such literal, bypass the trail adjustment.
+     * The clause can only be on the trail if one of its literals is assigned
+     * to true. If it has no such literal the trail adjustment is bypassed.
+     * The sets m_in_clause and m_in_coi are cleared by removing the inserted
+     * elements, so a step does not pay for the number of variables.
      */
 
     void proof_trim::prune_trail(literal_vector const& cl, clause* cp) {
-        m_in_clause.reset();
-        m_in_coi.reset();
-
         // verbose_stream() << "prune trail " << cl << "\n";
         
         if (cl.empty())
             return;
 
+        if (all_of(cl, [&](literal lit) { return s.value(lit) != l_true; })) {
+            ++m_stats.m_num_scans_skipped;
+            s.m_inconsistent = false;
+            s.m_qhead = s.m_trail.size();
+            s.propagate(false);
+            return;
+        }
+        ++m_stats.m_num_scans;
+
         for (literal lit : cl) 
             m_in_clause.insert(lit.index());
 
+        // literals before the first literal of cl are not in its cone of influence.
+        unsigned first = first_trail_position();
         auto unassign_literal = [&](literal l) {
             m_in_coi.insert((~l).index());
+            m_coi.push_back(~l);
             s.m_assignment[l.index()] = l_undef;
             s.m_assignment[(~l).index()] = l_undef;
         };
         
         bool on_trail = false;
-        unsigned j = 0;
-        for (unsigned i = 0; i < s.trail_size(); ++i) {
+        unsigned j = first;
+        for (unsigned i = first; i < s.trail_size(); ++i) {
             literal l = s.trail_literal(i);
             if (m_in_clause.contains(l.index())) {
                 SASSERT(!on_trail);
@@ -139,6 +158,11 @@ namespace sat {
             else
                 s.m_trail[j++] = s.m_trail[i];
         }            
+        for (literal lit : cl)
+            m_in_clause.remove(lit.index());
+        for (literal lit : m_coi)
+            m_in_coi.remove(lit.index());
+        m_coi.reset();
         s.m_trail.shrink(j);
         // verbose_stream() << "trail after " << s.m_trail << "\n";
         s.m_inconsistent = false; 
@@ -146,6 +170,31 @@ namespace sat {
         s.propagate(false);
     }
 
+    // trails shorter than this are searched on one thread.
+    static const unsigned s_parallel_threshold = 1 << 15;
+
+    /**
+     * Return the position of the first trail literal in m_in_clause, or the trail size.
+     * The search only reads the trail, so long trails are split in chunks that
+     * are searched by sat.threads threads.
+     */
+    unsigned proof_trim::first_trail_position() {
+        unsigned sz = s.trail_size();
+        unsigned nt = sz < s_parallel_threshold ? 1 : s.get_config().m_num_threads;
+        std::atomic<unsigned> first(sz);
+        parallel_for(nt, sz, [&](unsigned begin, unsigned end) {
+            for (unsigned i = begin; i < end && i < first; ++i) {
+                if (!m_in_clause.contains(s.trail_literal(i).index()))
+                    continue;
+                unsigned f = first;
+                while (i < f && !first.compare_exchange_weak(f, i))
+                    ;
+                return;
+            }
+        });
+        return first;
+    }
+
 
     /**
        The current state is in conflict.
@@ -347,9 +396,10 @@ namespace sat {
         m_clause.shrink(j);
         if (unit_or_binary_occurs())
             return;        
-        if (!m_conflict.empty() && m_clause.empty()) {
+        if (!m_conflict.empty() && m_clause.empty() && !m_has_empty_clause) {
             m_clauses.insert(m_clause, { {}, id, m_clause.empty() });
             m_trail.push_back({ id , m_clause, nullptr, true, is_initial });
+            m_has_empty_clause = true;
         }
         if (!m_conflict.empty())
             return;        
@@ -417,6 +467,9 @@ namespace sat {
     }
     
     void proof_trim::del() {
+        // steps after the empty clause are not replayed, trim starts from the empty clause.
+        if (m_has_empty_clause)
+            return;
         std::sort(m_clause.begin(), m_clause.end());
         clause* cp = del(m_clause);
         m_trail.push_back({ 0, m_clause, cp, false, true });
@@ -425,4 +478,12 @@ namespace sat {
     void proof_trim::infer(unsigned id) {
         assume(id, false);        
     }
+
+    void proof_trim::collect_statistics(statistics& st) const {
+        st.update("trim steps", m_stats.m_num_steps);
+        st.update("trim trail scans", m_stats.m_num_scans);
+        st.update("trim trail scans skipped", m_stats.m_num_scans_skipped);
+        st.update("trim core steps", m_stats.m_num_core);
+        st.update("trim time", m_stats.m_trim_time);
+    }
 }
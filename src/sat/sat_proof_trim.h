@@ -34,7 +34,9 @@ namespace sat {
         uint_set       m_in_deps;
         uint_set       m_in_clause;
         uint_set       m_in_coi;
+        literal_vector m_coi;
         clause*        m_conflict_clause = nullptr;
+        bool           m_has_empty_clause = false;
         vector<std::tuple<unsigned, literal_vector, clause*, bool, bool>> m_trail;
         vector<std::pair<unsigned, unsigned_vector>> m_result;
         
@@ -60,9 +62,20 @@ namespace sat {
         map<literal_vector, clause_info, hash, eq>   m_clauses;
         bool_vector                         m_propagated;
 
+        struct stats {
+            unsigned m_num_steps = 0;
+            unsigned m_num_scans = 0;
+            unsigned m_num_scans_skipped = 0;
+            unsigned m_num_core = 0;
+            double   m_trim_time = 0;
+            void reset() { *this = stats(); }
+        };
+        stats m_stats;
+
         void del(literal_vector const& cl, clause* cp);
 
         void prune_trail(literal_vector const& cl, clause* cp);
+        unsigned first_trail_position();
         void conflict_analysis_core(literal_vector const& cl, clause* cp);
 
         void add_dependency(literal lit);
@@ -93,7 +106,14 @@ namespace sat {
         void infer(unsigned id);
         void updt_params(params_ref const& p) { s.updt_params(p); }
 
+        /**
+           \brief true if the empty clause was added, so that the proof can be trimmed.
+        */
+        bool has_empty_clause() const { return m_has_empty_clause; }
+
         vector<std::pair<unsigned, unsigned_vector>> trim();
 
+        void collect_statistics(statistics& st) const;
+
     };
 }
@@ -22,6 +22,7 @@ Revision History:
 #include "util/stopwatch.h"
 #include "util/trace.h"
 #include "sat/sat_scc_params.hpp"
+#include "sat/sat_parallel_for.h"
 
 namespace sat {
 
@@ -32,16 +33,6 @@ namespace sat {
         updt_params(p);
     }
 
-    struct frame {
-        unsigned  m_lidx;
-        unsigned  m_succ_idx;
-        bool      m_first;
-        watched * m_it;
-        watched * m_end;
-        frame(unsigned lidx, watched * it, watched * end, unsigned sidx = 0):m_lidx(lidx), m_succ_idx(sidx), m_first(true), m_it(it), m_end(end) {}
-    };
-    typedef svector<frame> frames;
-
     struct scc::report {
         scc &     m_scc;
         stopwatch m_watch;
@@ -67,152 +58,275 @@ namespace sat {
         }
     };
 
-    bool scc::extract_roots(literal_vector& roots, bool_var_vector& to_elim) {
-        literal_vector lits;
-        unsigned_vector index;
-        unsigned_vector lowlink;
-        unsigned_vector s;
-        svector<char>   in_s;
+    // graphs with less work than this are processed on one thread.
+    static const unsigned s_parallel_threshold = 1 << 15;
+
+    unsigned scc::num_threads(unsigned work) const {
+        return work < s_parallel_threshold ? 1 : m_num_threads;
+    }
+
+    /**
+       \brief pack the binary implication graph in CSR format.
+       Literal l has an edge to l2 if the watch list of l contains the binary clause ~l or l2.
+    */
+    void scc::init_graph() {
         unsigned num_lits = m_solver.num_vars() * 2;
-        index.resize(num_lits, UINT_MAX);
-        lowlink.resize(num_lits, UINT_MAX);
-        in_s.resize(num_lits, false);
-        roots.resize(m_solver.num_vars(), null_literal);
-        unsigned next_index = 0;
-        svector<frame>   frames;
-        
-        for (unsigned l_idx = 0; l_idx < num_lits; l_idx++) {
-            if (index[l_idx] != UINT_MAX)
+        auto const& watches = m_solver.m_watches;
+        m_offsets.reset();
+        m_offsets.resize(num_lits + 1, 0);
+        unsigned nt = num_threads(num_lits);
+        parallel_for(nt, num_lits, [&](unsigned begin, unsigned end) {
+            for (unsigned l_idx = begin; l_idx < end; ++l_idx) {
+                unsigned n = 0;
+                for (watched const& w : watches[l_idx])
+                    n += w.is_binary_clause();
+                m_offsets[l_idx + 1] = n;
+            }
+        });
+        for (unsigned l_idx = 0; l_idx < num_lits; ++l_idx)
+            m_offsets[l_idx + 1] += m_offsets[l_idx];
+        m_succ.reset();
+        m_succ.resize(m_offsets[num_lits], 0);
+        nt = num_threads(m_succ.size());
+        parallel_for(nt, num_lits, [&](unsigned begin, unsigned end) {
+            for (unsigned l_idx = begin; l_idx < end; ++l_idx) {
+                unsigned k = m_offsets[l_idx];
+                for (watched const& w : watches[l_idx])
+                    if (w.is_binary_clause())
+                        m_succ[k++] = w.get_literal().index();
+            }
+        });
+    }
+
+    /**
+       \brief mark literals without live predecessors or successors.
+       They form trivial SCCs. The in-degree of l is the out-degree of ~l,
+       so trimming is closed under negation.
+    */
+    void scc::trim() {
+        unsigned num_lits = m_offsets.size() - 1;
+        m_trimmed.reset();
+        m_trimmed.resize(num_lits, 0);
+        m_live.reset();
+        m_live.resize(num_lits, 0);
+        unsigned nt = num_threads(m_succ.size());
+        for (unsigned round = 0; round < 8; ++round) {
+            parallel_for(nt, num_lits, [&](unsigned begin, unsigned end) {
+                for (unsigned l_idx = begin; l_idx < end; ++l_idx) {
+                    unsigned n = 0;
+                    if (!m_trimmed[l_idx])
+                        for (unsigned k = m_offsets[l_idx]; k < m_offsets[l_idx + 1]; ++k)
+                            n += !m_trimmed[m_succ[k]];
+                    m_live[l_idx] = n;
+                }
+            });
+            bool change = false;
+            for (unsigned l_idx = 0; l_idx < num_lits; ++l_idx) {
+                if (!m_trimmed[l_idx] && (m_live[l_idx] == 0 || m_live[l_idx ^ 1] == 0)) {
+                    m_trimmed[l_idx] = true;
+                    ++m_num_trimmed;
+                    change = true;
+                }
+            }
+            if (!change)
+                break;
+        }
+    }
+
+    /**
+       \brief iterative Tarjan from root over the literals that are not trimmed.
+       Non-trivial SCCs are appended to sccs, lim records where each SCC ends.
+    */
+    void scc::tarjan(unsigned root, unsigned& next_index, unsigned_vector& stack,
+                     svector<std::pair<unsigned, unsigned>>& frames, literal_vector& sccs, unsigned_vector& lim) {
+        auto new_node = [&](unsigned u) {
+            m_index[u] = m_lowlink[u] = next_index++;
+            stack.push_back(u);
+            m_in_stack[u] = true;
+            frames.push_back({ u, m_offsets[u] });
+        };
+        new_node(root);
+        while (!frames.empty()) {
+            auto& fr = frames.back();
+            unsigned u = fr.first;
+            unsigned end = m_offsets[u + 1];
+            for (; fr.second < end; ++fr.second) {
+                unsigned v = m_succ[fr.second];
+                if (m_trimmed[v])
+                    continue;
+                if (m_index[v] == UINT_MAX)
+                    break;
+                if (m_in_stack[v] && m_index[v] < m_lowlink[u])
+                    m_lowlink[u] = m_index[v];
+            }
+            if (fr.second < end) {
+                new_node(m_succ[fr.second]);
                 continue;
-            if (m_solver.was_eliminated(to_literal(l_idx).var()))
+            }
+            frames.pop_back();
+            if (!frames.empty()) {
+                auto& parent = frames.back();
+                if (m_lowlink[u] < m_lowlink[parent.first])
+                    m_lowlink[parent.first] = m_lowlink[u];
+                ++parent.second;
+            }
+            if (m_lowlink[u] != m_index[u])
                 continue;
-            
-            m_solver.checkpoint();
-
-#define NEW_NODE(LIDX) {                                                        \
-                index[LIDX]   = next_index;                                     \
-                lowlink[LIDX] = next_index;                                     \
-                next_index++;                                                   \
-                s.push_back(LIDX);                                              \
-                in_s[LIDX] = true;                                              \
-                watch_list & wlist = m_solver.get_wlist(LIDX);                  \
-                frames.push_back(frame(LIDX, wlist.begin(), wlist.end()));      \
+            unsigned sz = sccs.size(), w;
+            do {
+                w = stack.back();
+                stack.pop_back();
+                m_in_stack[w] = false;
+                sccs.push_back(to_literal(w));
             }
+            while (w != u);
+            if (sccs.size() == sz + 1)
+                sccs.shrink(sz);
+            else
+                lim.push_back(sccs.size());
+        }
+    }
 
-            NEW_NODE(l_idx);
+    /**
+       \brief find the non-trivial SCCs of the literals that are not trimmed.
+       With several threads, the remaining graph is split into weakly connected
+       components and each thread runs Tarjan on its share of the components.
+    */
+    void scc::find_sccs(vector<literal_vector>& sccs, vector<unsigned_vector>& lims) {
+        unsigned num_lits = m_offsets.size() - 1;
+        m_index.reset();
+        m_index.resize(num_lits, UINT_MAX);
+        m_lowlink.reset();
+        m_lowlink.resize(num_lits, UINT_MAX);
+        m_in_stack.reset();
+        m_in_stack.resize(num_lits, false);
+        unsigned nt = num_threads(m_succ.size());
+        sccs.reset();
+        lims.reset();
+        sccs.resize(nt);
+        lims.resize(nt);
+        vector<unsigned_vector> roots(nt);
 
-            while (!frames.empty()) {
-            loop:
-                frame & fr = frames.back();
-                unsigned l_idx = fr.m_lidx;
-                if (!fr.m_first) {
-                    SASSERT(fr.m_it->is_binary_clause());
-                    // after visiting child
-                    literal l2 = fr.m_it->get_literal();
-                    unsigned l2_idx = l2.index();
-                    SASSERT(index[l2_idx] != UINT_MAX);
-                    if (lowlink[l2_idx] < lowlink[l_idx])
-                        lowlink[l_idx] = lowlink[l2_idx];
-                    fr.m_it++;
+        if (nt == 1) {
+            for (unsigned l_idx = 0; l_idx < num_lits; ++l_idx)
+                if (!m_trimmed[l_idx])
+                    roots[0].push_back(l_idx);
+        }
+        else {
+            // weakly connected components by union-find
+            m_comp.reset();
+            for (unsigned l_idx = 0; l_idx < num_lits; ++l_idx)
+                m_comp.push_back(l_idx);
+            auto find = [&](unsigned x) {
+                while (m_comp[x] != x) {
+                    m_comp[x] = m_comp[m_comp[x]];
+                    x = m_comp[x];
                 }
-                fr.m_first = false;
-                while (fr.m_it != fr.m_end) {
-                    if (!fr.m_it->is_binary_clause()) {
-                        fr.m_it++;
+                return x;
+            };
+            for (unsigned l_idx = 0; l_idx < num_lits; ++l_idx) {
+                if (m_trimmed[l_idx])
+                    continue;
+                for (unsigned k = m_offsets[l_idx]; k < m_offsets[l_idx + 1]; ++k) {
+                    unsigned v = m_succ[k];
+                    if (m_trimmed[v])
                         continue;
-                    }
-                    literal l2 = fr.m_it->get_literal();
-                    unsigned l2_idx = l2.index();
-                    if (index[l2_idx] == UINT_MAX) {
-                        NEW_NODE(l2_idx);
-                        goto loop;
-                    }
-                    else if (in_s[l2_idx]) {
-                        if (index[l2_idx] < lowlink[l_idx])
-                            lowlink[l_idx] = index[l2_idx];
-                    }
-                    fr.m_it++;
+                    unsigned a = find(l_idx), b = find(v);
+                    if (a != b)
+                        m_comp[std::max(a, b)] = std::min(a, b);
                 }
-                // visited all successors
-                if (lowlink[l_idx] == index[l_idx]) {
-                    // found new SCC
-                    CTRACE("scc_cycle", s.back() != l_idx, {
-                            tout << "cycle: ";
-                            unsigned j = s.size() - 1;
-                            unsigned l2_idx;
-                            do {
-                                l2_idx = s[j];
-                                j--;
-                                tout << to_literal(l2_idx) << " ";
-                            } while (l2_idx != l_idx);
-                            tout << "\n";
-                        });
-                    
-                    SASSERT(!s.empty());
-                    literal l = to_literal(l_idx);
-                    bool_var v = l.var();
-                    if (roots[v] != null_literal) {
-                        // variable was already assigned... just consume stack
-                        TRACE("scc_detail", tout << "consuming stack...\n";);
-                        unsigned l2_idx;
-                        do {
-                            l2_idx = s.back();
-                            s.pop_back();
-                            in_s[l2_idx] = false;
-                            SASSERT(roots[to_literal(l2_idx).var()].var() == roots[v].var());
-                        } while (l2_idx != l_idx);
-                    }
-                    else {
-                        // check if the SCC has an external variable, and check for conflicts
-                        TRACE("scc_detail", tout << "assigning roots...\n";);
-                        literal  r = null_literal;
-                        unsigned j = s.size() - 1;
-                        unsigned l2_idx;
-                        do {
-                            l2_idx = s[j];
-                            j--;
-                            if (to_literal(l2_idx) == ~l) {
-                                m_solver.set_conflict();
-                                return false;
-                            }
-                            if (m_solver.is_external(to_literal(l2_idx).var())) {
-                                r = to_literal(l2_idx);
-                                break;
-                            }
-                        } while (l2_idx != l_idx);
-
-                        if (r == null_literal) {
-                            // SCC does not contain external variable
-                            r = to_literal(l_idx);
-                        }
+            }
+            // assign components to the least loaded thread, largest first
+            unsigned_vector size(num_lits, 0u);
+            unsigned_vector comps;
+            for (unsigned l_idx = 0; l_idx < num_lits; ++l_idx) {
+                if (m_trimmed[l_idx])
+                    continue;
+                unsigned r = find(l_idx);
+                if (size[r]++ == 0)
+                    comps.push_back(r);
+            }
+            std::stable_sort(comps.begin(), comps.end(), [&](unsigned a, unsigned b) { return size[a] > size[b]; });
+            unsigned_vector load(nt, 0u), owner(num_lits, 0u);
+            for (unsigned r : comps) {
+                unsigned t = 0;
+                for (unsigned i = 1; i < nt; ++i)
+                    if (load[i] < load[t])
+                        t = i;
+                load[t] += size[r];
+                owner[r] = t;
+            }
+            for (unsigned l_idx = 0; l_idx < num_lits; ++l_idx)
+                if (!m_trimmed[l_idx])
+                    roots[owner[m_comp[l_idx]]].push_back(l_idx);
+        }
 
-                        TRACE("scc_detail", tout << "r: " << r << "\n";);
+        parallel_for(nt, nt, [&](unsigned begin, unsigned end) {
+            unsigned_vector stack;
+            svector<std::pair<unsigned, unsigned>> frames;
+            unsigned next_index = 0;
+            for (unsigned t = begin; t < end; ++t)
+                for (unsigned l_idx : roots[t])
+                    if (m_index[l_idx] == UINT_MAX)
+                        tarjan(l_idx, next_index, stack, frames, sccs[t], lims[t]);
+        });
+    }
 
-                        do {
-                            l2_idx = s.back();
-                            s.pop_back();
-                            in_s[l2_idx] = false;
-                            literal  l2 = to_literal(l2_idx);
-                            bool_var v2 = l2.var();
+    bool scc::extract_roots(literal_vector& roots, bool_var_vector& to_elim) {
+        m_solver.checkpoint();
+        init_graph();
+        trim();
+        vector<literal_vector> sccs;
+        vector<unsigned_vector> lims;
+        find_sccs(sccs, lims);
+        m_solver.checkpoint();
 
-                            if (roots[v2] == null_literal) {
-                                if (l2.sign()) {
-                                    roots[v2] = ~r;
-                                }
-                                else {
-                                    roots[v2] = r;
-                                }
-                                if (v2 != r.var())
-                                    to_elim.push_back(v2);
-                            }
-                        } while (l2_idx != l_idx);
-                    }
+        unsigned num_vars = m_solver.num_vars();
+        roots.reset();
+        roots.resize(num_vars, null_literal);
+        bool_vector mark(num_vars, false);
+        for (unsigned t = 0; t < sccs.size(); ++t) {
+            unsigned start = 0;
+            for (unsigned end : lims[t]) {
+                literal const* begin = sccs[t].data() + start;
+                unsigned sz = end - start;
+                start = end;
+                TRACE("scc_cycle", tout << "cycle: " << literal_vector(sz, begin) << "\n";);
+                // pick the smallest external variable, otherwise the smallest variable,
+                // such that the SCC of the negated literals picks the negated root.
+                literal r = null_literal;
+                bool conflict = false;
+                for (unsigned i = 0; i < sz; ++i) {
+                    literal l = begin[i];
+                    conflict |= mark[l.var()];
+                    mark[l.var()] = true;
+                    bool ext = m_solver.is_external(l.var());
+                    if (r == null_literal || 
+                        (ext && !m_solver.is_external(r.var())) ||
+                        (ext == m_solver.is_external(r.var()) && l.var() < r.var()))
+                        r = l;
+                }
+                for (unsigned i = 0; i < sz; ++i)
+                    mark[begin[i].var()] = false;
+                if (conflict) {
+                    m_solver.set_conflict();
+                    return false;
+                }
+                TRACE("scc_detail", tout << "r: " << r << "\n";);
+                for (unsigned i = 0; i < sz; ++i) {
+                    literal l2 = begin[i];
+                    bool_var v2 = l2.var();
+                    if (roots[v2] != null_literal)
+                        continue;
+                    roots[v2] = l2.sign() ? ~r : r;
+                    if (v2 != r.var())
+                        to_elim.push_back(v2);
                 }
-                frames.pop_back();
             }
         }
+        std::sort(to_elim.begin(), to_elim.end());
 
-        for (unsigned i = 0; i < m_solver.num_vars(); ++i) {
+        for (unsigned i = 0; i < num_vars; ++i) {
             if (roots[i] == null_literal) {
                 roots[i] = literal(i, false);
             }
@@ -237,7 +351,7 @@ namespace sat {
         TRACE("scc", for (unsigned i = 0; i < roots.size(); i++) { tout << i << " -> " << roots[i] << "\n"; }
               tout << "to_elim: "; for (unsigned v : to_elim) tout << v << " "; tout << "\n";);
         m_num_elim += to_elim.size();
-        elim_eqs eliminator(m_solver);
+        elim_eqs eliminator(m_solver, num_threads(m_solver.m_clauses.size() + m_solver.m_learned.size()));
         eliminator(roots, to_elim);
         TRACE("scc_detail", m_solver.display(tout););
         CASSERT("scc_bug", m_solver.check_invariant());
@@ -250,7 +364,7 @@ namespace sat {
 
     unsigned scc::reduce_tr(bool learned) {        
         init_big(learned);
-        unsigned num_elim = m_big.reduce_tr(m_solver);
+        unsigned num_elim = m_big.reduce_tr(m_solver, num_threads(m_solver.m_watches.size()));
         m_num_elim_bin += num_elim;
         return num_elim;
     }
@@ -265,17 +379,20 @@ namespace sat {
     void scc::collect_statistics(statistics & st) const {
         st.update("sat scc elim vars", m_num_elim);
         st.update("sat scc elim binary", m_num_elim_bin);
+        st.update("sat scc trimmed", m_num_trimmed);
     }
     
     void scc::reset_statistics() {
         m_num_elim = 0;
         m_num_elim_bin = 0;
+        m_num_trimmed = 0;
     }
 
     void scc::updt_params(params_ref const & _p) {
         sat_scc_params p(_p);
         m_scc = p.scc();
         m_scc_tr = p.scc_tr();
+        m_num_threads = std::max(1u, p.scc_threads());
     }
 
     void scc::collect_param_descrs(param_descrs & d) {
@@ -32,12 +32,31 @@ namespace sat {
         // config
         bool       m_scc;
         bool       m_scc_tr;
+        unsigned   m_num_threads;
         // stats
         unsigned   m_num_elim;
         unsigned   m_num_elim_bin;
+        unsigned   m_num_trimmed;
 
         big        m_big;
 
+        // binary implication graph in compressed sparse row format.
+        // the successors of literal index l are m_succ[m_offsets[l]], ..., m_succ[m_offsets[l + 1] - 1].
+        unsigned_vector m_offsets;
+        unsigned_vector m_succ;
+        svector<char>   m_trimmed;  // literal is not part of a non-trivial SCC
+        unsigned_vector m_live;
+        unsigned_vector m_index, m_lowlink;
+        svector<char>   m_in_stack;
+        unsigned_vector m_comp;
+
+        unsigned num_threads(unsigned work) const;
+        void init_graph();
+        void trim();
+        void tarjan(unsigned root, unsigned& next_index, unsigned_vector& stack, 
+                    svector<std::pair<unsigned, unsigned>>& frames, literal_vector& sccs, unsigned_vector& lim);
+        void find_sccs(vector<literal_vector>& sccs, vector<unsigned_vector>& lims);
+
         void reduce_tr();
         unsigned reduce_tr(bool learned);
 
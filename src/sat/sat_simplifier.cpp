@@ -1913,6 +1913,27 @@ namespace sat {
         }
     }
 
+    /**
+       \brief Hash of the clauses in m_pos_cls and m_neg_cls.
+       It does not depend on the order of the clauses or of their literals,
+       because use lists and watch lists are rebuilt between rounds.
+       The result is never 0.
+    */
+    unsigned simplifier::occurrence_fingerprint() const {
+        unsigned h = m_pos_cls.size() + 31 * m_neg_cls.size();
+        auto add = [&](clause_wrapper const& c) {
+            unsigned ch = c.size();
+            for (unsigned i = 0; i < c.size(); ++i)
+                ch += hash_u(c[i].index());
+            h += hash_u(ch);
+        };
+        for (clause_wrapper const& c : m_pos_cls)
+            add(c);
+        for (clause_wrapper const& c : m_neg_cls)
+            add(c);
+        return h == 0 ? 1 : h;
+    }
+
     bool simplifier::try_eliminate(bool_var v) {
         if (value(v) != l_undef)
             return false;
@@ -1959,6 +1980,15 @@ namespace sat {
         collect_clauses(pos_l, m_pos_cls);
         collect_clauses(neg_l, m_neg_cls);
 
+        // the resolvents are a function of the occurrences of v.
+        // If they did not change since v last produced too many resolvents, skip it.
+        unsigned fingerprint = occurrence_fingerprint();
+        m_elim_fingerprint.reserve(v + 1, 0);
+        if (m_elim_fingerprint[v] == fingerprint) {
+            ++m_num_elim_skipped;
+            return false;
+        }
+
         TRACE("sat_simplifier", tout << "collecting number of after_clauses\n";);
         unsigned before_clauses = num_pos + num_neg;
         unsigned after_clauses  = 0;
@@ -1971,7 +2001,8 @@ namespace sat {
                     after_clauses++;
                     if (after_clauses > before_clauses) {
                         TRACE("sat_simplifier", tout << "too many after clauses: " << after_clauses << "\n";);
-                        return false;
+                        m_elim_fingerprint[v] = fingerprint;
+                                        return false;
                     }
                 }
             }
@@ -2058,17 +2089,23 @@ namespace sat {
         simplifier & m_simplifier;
         stopwatch    m_watch;
         unsigned     m_num_elim_vars;
+        unsigned     m_num_elim_skipped;
         elim_var_report(simplifier & s):
             m_simplifier(s),
-            m_num_elim_vars(s.m_num_elim_vars) {
+            m_num_elim_vars(s.m_num_elim_vars),
+            m_num_elim_skipped(s.m_num_elim_skipped) {
             m_watch.start();
         }
 
         ~elim_var_report() {
             m_watch.stop();
+            m_simplifier.m_num_elim_rounds++;
+            m_simplifier.m_num_elim_last_round = m_simplifier.m_num_elim_vars - m_num_elim_vars;
+            m_simplifier.m_elim_time += m_watch.get_seconds();
             IF_VERBOSE(SAT_VB_LVL,
                        verbose_stream() << " (sat-resolution :elim-vars "
                        << (m_simplifier.m_num_elim_vars - m_num_elim_vars)
+                       << " :skipped " << (m_simplifier.m_num_elim_skipped - m_num_elim_skipped)
                        << " :threshold " << m_simplifier.m_elim_counter
                        << mem_stat()
                        << " :time " << std::fixed << std::setprecision(2) << m_watch.get_seconds() << ")\n";);
@@ -2145,6 +2182,10 @@ namespace sat {
         st.update("sat abce", m_num_abce);
         st.update("sat bca",  m_num_bca);
         st.update("sat ate",  m_num_ate);
+        st.update("sat elim var rounds", m_num_elim_rounds);
+        st.update("sat elim vars last round", m_num_elim_last_round);
+        st.update("sat elim var skipped", m_num_elim_skipped);
+        st.update("sat elim var time", m_elim_time);
     }
 
     void simplifier::reset_statistics() {
@@ -2158,5 +2199,9 @@ namespace sat {
         m_num_elim_vars = 0;
         m_num_bca = 0;
         m_num_ate = 0;
+        m_num_elim_rounds = 0;
+        m_num_elim_skipped = 0;
+        m_num_elim_last_round = 0;
+        m_elim_time = 0;
     }
 };
@@ -66,6 +66,7 @@ namespace sat {
         svector<bin_clause>    m_sub_bin_todo;
         unsigned               m_last_sub_trail_sz; // size of the trail since last cleanup
         bool_var_set           m_elim_todo;
+        unsigned_vector        m_elim_fingerprint; // occurrences of variables that produced too many resolvents in an earlier round, 0 if none
         bool                   m_need_cleanup;
         tmp_clause             m_dummy;
 
@@ -117,6 +118,10 @@ namespace sat {
         unsigned               m_num_elim_vars;
         unsigned               m_num_sub_res;
         unsigned               m_num_elim_lits;
+        unsigned               m_num_elim_rounds;
+        unsigned               m_num_elim_skipped;
+        unsigned               m_num_elim_last_round;
+        double                 m_elim_time;
 
         bool                   m_learned_in_use_lists;
         unsigned               m_old_num_elim_vars;
@@ -195,6 +200,7 @@ namespace sat {
         unsigned get_to_elim_cost(bool_var v) const;
         void order_vars_for_elim(bool_var_vector & r);
         void collect_clauses(literal l, clause_wrapper_vector & r);
+        unsigned occurrence_fingerprint() const;
         clause_wrapper_vector m_pos_cls;
         clause_wrapper_vector m_neg_cls;
         literal_vector m_new_cls;
@@ -32,6 +32,7 @@ Revision History:
 #include "sat/sat_ddfw.h"
 #include "sat/sat_prob.h"
 #include "sat/sat_anf_simplifier.h"
+#include "sat/sat_xor_gauss.h"
 #include "sat/sat_cut_simplifier.h"
 #if defined(_MSC_VER) && !defined(_M_ARM) && !defined(_M_ARM64)
 # include <xmmintrin.h>
@@ -53,6 +54,7 @@ namespace sat {
         m_scc(*this, p),
         m_asymm_branch(*this, p),
         m_probing(*this, p),
+        m_vivify(*this),
         m_mus(*this),
         m_binspr(*this),
         m_inconsistent(false),
@@ -657,14 +659,16 @@ namespace sat {
 
     bool solver::should_defrag() {
         if (m_defrag_threshold > 0) --m_defrag_threshold;
-        return m_defrag_threshold == 0 && m_config.m_gc_defrag;
+        return m_defrag_threshold == 0 && m_config.m_gc_defrag && 
+            cls_allocator().fragmentation() >= m_config.m_gc_defrag_fragmentation;
     }
 
     void solver::defrag_clauses() {
         m_defrag_threshold = 2;
         if (memory_pressure()) return;
         pop(scope_lvl());
-        IF_VERBOSE(2, verbose_stream() << "(sat-defrag)\n");
+        IF_VERBOSE(2, verbose_stream() << "(sat-defrag :fragmentation " << cls_allocator().fragmentation() << ")\n");
+        ++m_stats.m_defrag;
         clause_allocator& alloc = m_cls_allocator[!m_cls_allocator_idx];
         ptr_vector<clause> new_clauses, new_learned;
         for (clause* c : m_clauses) c->unmark_used();
@@ -694,7 +698,7 @@ namespace sat {
                         else {
                             new_clauses.push_back(c2);
                         }
-                        offset = get_offset(*c2);
+                        offset = alloc.get_offset(c2);
                         c1.set_new_offset(offset);
                     }
                     w = watched(w.get_blocked_literal(), offset);
@@ -1024,6 +1028,7 @@ namespace sat {
         watch_list& wlist = m_watches[l.index()];
         m_asymm_branch.dec(wlist.size());
         m_probing.dec(wlist.size());
+        m_vivify.dec(wlist.size());
         watch_list::iterator it = wlist.begin();
         watch_list::iterator it2 = it;
         watch_list::iterator end = wlist.end();
@@ -1342,6 +1347,8 @@ namespace sat {
         solver& s;
         scoped_ls(solver& s): s(s) {}
         ~scoped_ls() { 
+            if (s.m_local_search)
+                s.m_local_search->collect_statistics(s.m_aux_stats);
             dealloc(s.m_local_search); 
             s.m_local_search = nullptr; 
         }
@@ -1478,12 +1485,16 @@ namespace sat {
         }
 
         vector<reslimit> lims(num_ddfw);            
-        // set up ddfw search
+        // set up ddfw search, the ddfw threads exchange their best assignments
+        scoped_ptr<ddfw_shared> ddfw_best;
+        if (num_ddfw > 1)
+            ddfw_best = alloc(ddfw_shared, num_vars());
         for (int i = 0; i < num_ddfw; ++i) {
             ddfw* d = alloc(ddfw);
             d->updt_params(m_params);
             d->set_seed(m_config.m_random_seed + i);
             d->add(*this);
+            d->set_shared(ddfw_best.get());
             ls.push_back(d);
         }
         int local_search_offset = num_extra_solvers;
@@ -1594,6 +1605,8 @@ namespace sat {
             rlimit().reset_cancel();
         }
         set_par(nullptr, 0);
+        for (auto* l : ls)
+            l->collect_statistics(m_aux_stats);
         ls.reset();
         uw.reset();
         if (finished_id == -1) {
@@ -2070,6 +2083,9 @@ namespace sat {
         CASSERT("sat_simplify_bug", check_invariant());
         m_asymm_branch(false);
 
+        m_vivify();
+        CASSERT("sat_simplify_bug", check_invariant());
+
         if (m_config.m_lookahead_simplify && !m_ext) {
             lookahead lh(*this);
             lh.simplify(true);
@@ -2105,6 +2121,12 @@ namespace sat {
             anf.collect_statistics(m_aux_stats);
             // TBD: throttle anf_delay based on yield
         }
+
+        if (m_config.m_xor_gauss && !inconsistent()) {
+            xor_gauss gauss(*this);
+            gauss();
+            gauss.collect_statistics(m_aux_stats);
+        }
         
         if (m_cut_simplifier && m_simplifications > m_config.m_cut_delay && !inconsistent()) {
             (*m_cut_simplifier)();
@@ -2348,14 +2370,19 @@ namespace sat {
             }
             log_stats();
         }
-        TRACE("sat", tout << "restart " << restart_level(to_base) << "\n";);
         IF_VERBOSE(30, display_status(verbose_stream()););
-        TRACE("sat", tout << "restart " << restart_level(to_base) << "\n";);
-        pop_reinit(restart_level(to_base));
+        unsigned num_scopes = restart_level(to_base);
+        TRACE("sat", tout << "restart " << num_scopes << "\n";);
+        unsigned keep_lvl = scope_lvl() - num_scopes;
+        if (keep_lvl > search_lvl()) {
+            m_stats.m_reused_levels += keep_lvl - search_lvl();
+            m_stats.m_saved_propagations += trail_size_at(keep_lvl) - trail_size_at(search_lvl());
+        }
+        pop_reinit(num_scopes);
         set_next_restart();        
     }
 
-    unsigned solver::restart_level(bool to_base) {
+    unsigned solver::restart_level(bool to_base) const {
         SASSERT(!m_case_split_queue.empty());
         if (to_base || scope_lvl() == search_lvl()) 
             return scope_lvl() - search_lvl();        
@@ -2379,6 +2406,9 @@ namespace sat {
             unsigned n = search_lvl();
             for (; n < scope_lvl() && m_case_split_queue.more_active(scope_literal(n).var(), next); ++n) {
             }
+            // with restart.reuse_trail, the decisions that are more active than the next decision are kept.
+            if (m_config.m_restart_reuse_trail)
+                return scope_lvl() - n;
             return n - search_lvl();
         }
     }
@@ -2521,6 +2551,8 @@ namespace sat {
                 break;
             case justification::CLAUSE: {
                 clause & c = get_clause(js);
+                if (c.is_learned())
+                    c.mark_used_in_conflict();
                 unsigned i = 0;
                 if (consequent != null_literal) {
                     SASSERT(c[0] == consequent || c[1] == consequent);
@@ -2639,6 +2671,9 @@ namespace sat {
         else {
             TRACE("sat", tout << "backtrack " << (m_scope_lvl - backtrack_lvl + 1) << " scopes\n";);
             ++m_stats.m_backtracks;
+            // levels between the backjump level and the backtrack level are kept
+            if (backtrack_lvl > backjump_lvl + 1)
+                m_stats.m_saved_propagations += trail_size_at(backtrack_lvl - 1) - trail_size_at(backjump_lvl);
             pop_reinit(m_scope_lvl - backtrack_lvl + 1);
         }
         clause * lemma = mk_clause_core(m_lemma.size(), m_lemma.data(), sat::status::redundant());
@@ -3782,9 +3817,12 @@ namespace sat {
         m_scc.collect_statistics(st);
         m_asymm_branch.collect_statistics(st);
         m_probing.collect_statistics(st);
+        m_vivify.collect_statistics(st);
         if (m_ext) m_ext->collect_statistics(st);
         if (m_local_search) m_local_search->collect_statistics(st);
         if (m_cut_simplifier) m_cut_simplifier->collect_statistics(st);
+        st.update("sat clause memory mb", static_cast<double>(cls_allocator().get_allocation_size()) / (1024.0 * 1024.0));
+        st.update("sat clause fragmentation", cls_allocator().fragmentation());
         st.copy(m_aux_stats);
     }
 
@@ -3794,6 +3832,7 @@ namespace sat {
         m_simplifier.reset_statistics();
         m_asymm_branch.reset_statistics();
         m_probing.reset_statistics();
+        m_vivify.reset_statistics();
         m_aux_stats.reset();
     }
 
@@ -4762,6 +4801,9 @@ namespace sat {
         st.update("sat elim bool vars bdd", m_elim_var_bdd);
         st.update("sat backjumps", m_backjumps);
         st.update("sat backtracks", m_backtracks);
+        st.update("sat defrag", m_defrag);
+        st.update("sat reused levels", m_reused_levels);
+        st.update("sat saved propagations", m_saved_propagations);
     }
 
     void stats::reset() {
@@ -41,6 +41,7 @@ Revision History:
 #include "sat/sat_asymm_branch.h"
 #include "sat/sat_cut_simplifier.h"
 #include "sat/sat_probing.h"
+#include "sat/sat_vivify.h"
 #include "sat/sat_mus.h"
 #include "sat/sat_binspr.h"
 #include "sat/sat_drat.h"
@@ -79,6 +80,9 @@ namespace sat {
         unsigned m_units;
         unsigned m_backtracks;
         unsigned m_backjumps;
+        unsigned m_defrag;
+        unsigned m_reused_levels;
+        unsigned m_saved_propagations;
         stats() { reset(); }
         void reset();
         void collect_statistics(statistics & st) const;
@@ -112,6 +116,7 @@ namespace sat {
         scc                     m_scc;
         asymm_branch            m_asymm_branch;
         probing                 m_probing;
+        vivify                  m_vivify;
         bool                    m_is_probing { false };
         mus                     m_mus;           // MUS for minimal core extraction
         binspr                  m_binspr;
@@ -239,6 +244,7 @@ namespace sat {
         friend class lut_finder;
         friend class npn3_finder;
         friend class proof_trim;
+        friend class vivify;
         friend struct backoff;
     public:
         solver(params_ref const & p, reslimit& l);
@@ -393,6 +399,8 @@ namespace sat {
         unsigned lvl(literal l) const { return m_justification[l.var()].level(); }
         unsigned trail_size() const { return m_trail.size(); }
         literal  scope_literal(unsigned n) const { return m_trail[m_scopes[n].m_trail_lim]; }
+        // number of literals on the trail assigned at levels up to lvl.
+        unsigned trail_size_at(unsigned lvl) const { return lvl < scope_lvl() ? m_scopes[lvl].m_trail_lim : m_trail.size(); }
         void assign(literal l, justification j) {
             TRACE("sat_assign", tout << l << " previous value: " << value(l) << " j: " << j << "\n";);
             switch (value(l)) {
@@ -580,7 +588,7 @@ namespace sat {
         svector<size_t> m_last_positions;
         unsigned m_last_position_log;
         unsigned m_restart_logs;
-        unsigned restart_level(bool to_base);
+        unsigned restart_level(bool to_base) const;
         void log_stats();
         bool should_cancel();
         bool should_restart() const;
@@ -616,6 +624,7 @@ namespace sat {
         bool activate_frozen_clause(clause & c);
         unsigned psm(clause const & c) const;
         bool can_delete(clause const & c) const;
+        bool keep_tier(clause & c) const;
         bool can_delete3(literal l1, literal l2, literal l3) const;
 
         // gc for lemmas in the reinit-stack
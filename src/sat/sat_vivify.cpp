@@ -0,0 +1,329 @@
+/*++
+  Copyright (c) 2024 Microsoft Corporation
+
+  Module Name:
+
+   sat_vivify.cpp
+
+  Abstract:
+
+    Vivification of learned clauses.
+
+  --*/
+
+#include "util/stopwatch.h"
+#include "sat/sat_vivify.h"
+#include "sat/sat_solver.h"
+
+namespace sat {
+
+    struct vivify::report {
+        vivify&   v;
+        stopwatch m_watch;
+        unsigned  m_num_checked;
+        unsigned  m_num_vivified;
+        unsigned  m_num_elim_literals;
+        unsigned  m_num_reused;
+        report(vivify& v):
+            v(v),
+            m_num_checked(v.m_num_checked),
+            m_num_vivified(v.m_num_vivified),
+            m_num_elim_literals(v.m_num_elim_literals),
+            m_num_reused(v.m_num_reused) {
+            m_watch.start();
+        }
+        ~report() {
+            m_watch.stop();
+            IF_VERBOSE(2,
+                       verbose_stream() << " (sat-vivify :checked " << (v.m_num_checked - m_num_checked)
+                       << " :vivified " << (v.m_num_vivified - m_num_vivified)
+                       << " :elim-literals " << (v.m_num_elim_literals - m_num_elim_literals)
+                       << " :reused-levels " << (v.m_num_reused - m_num_reused)
+                       << " :ticks-left " << v.m_counter
+                       << m_watch << ")\n";);
+        }
+    };
+
+    bool vivify::lit_lt(literal a, literal b) const {
+        unsigned oa = m_occs[a.index()], ob = m_occs[b.index()];
+        return oa > ob || (oa == ob && a.index() < b.index());
+    }
+
+    bool vivify::candidate_lt(candidate const& a, candidate const& b) const {
+        literal const* la = m_lits.data() + a.m_begin;
+        literal const* lb = m_lits.data() + b.m_begin;
+        unsigned sz = std::min(a.m_size, b.m_size);
+        for (unsigned i = 0; i < sz; ++i) {
+            if (la[i] != lb[i])
+                return lit_lt(la[i], lb[i]);
+        }
+        return a.m_size < b.m_size;
+    }
+
+    /**
+       \brief collect learned clauses of the first two tiers.
+       The literals of each clause are copied and sorted by decreasing
+       number of occurrences, such that clauses with common literals
+       share a prefix after sorting.
+    */
+    void vivify::init_candidates() {
+        m_candidates.reset();
+        m_lits.reset();
+        m_occs.reset();
+        m_occs.resize(2 * s.num_vars(), 0);
+        for (clause* cp : s.m_learned) {
+            clause& c = *cp;
+            if (c.size() <= 2 || c.glue() > s.m_config.m_gc_tier2_glue || c.frozen() ||
+                c.on_reinit_stack() || c.was_removed() || !s.can_delete(c))
+                continue;
+            m_candidates.push_back({ cp, m_lits.size(), c.size() });
+            for (literal l : c) {
+                m_lits.push_back(l);
+                ++m_occs[l.index()];
+            }
+        }
+        auto lit_cmp = [&](literal a, literal b) { return lit_lt(a, b); };
+        for (candidate const& cand : m_candidates)
+            std::sort(m_lits.begin() + cand.m_begin, m_lits.begin() + cand.m_begin + cand.m_size, lit_cmp);
+        std::sort(m_candidates.begin(), m_candidates.end(), [&](candidate const& a, candidate const& b) { return candidate_lt(a, b); });
+    }
+
+    void vivify::backtrack(unsigned lvl) {
+        if (s.scope_lvl() > lvl)
+            s.pop(s.scope_lvl() - lvl);
+        m_decisions.shrink(std::min(lvl, m_decisions.size()));
+        if (s.m_trail.size() > s.m_qhead)
+            s.propagate_core(false);
+    }
+
+    /**
+       \brief attach the clause that was vivified last, at the current level.
+       The clause is kept detached while the next clause reuses the trail
+       and is attached as soon as the trail is cut down to the shared prefix.
+    */
+    void vivify::reattach() {
+        if (!m_detached)
+            return;
+        clause& c = *m_detached;
+        m_detached = nullptr;
+        unsigned idx = c.size();
+        for (unsigned i = 0; i < c.size() && idx == c.size(); ++i)
+            if (s.value(c[i]) != l_false)
+                idx = i;
+        if (idx == c.size() && s.scope_lvl() > 0) {
+            backtrack(0);
+            idx = c.size();
+            for (unsigned i = 0; i < c.size() && idx == c.size(); ++i)
+                if (s.value(c[i]) != l_false)
+                    idx = i;
+        }
+        if (idx == c.size()) {
+            s.set_conflict();
+            s.attach_clause(c);
+            return;
+        }
+        std::swap(c[0], c[idx]);
+        s.attach_nary_clause(c, false);
+        if (s.m_trail.size() > s.m_qhead)
+            s.propagate_core(false);
+        if (s.inconsistent() && s.scope_lvl() > 0)
+            backtrack(0);
+    }
+
+    bool vivify::is_reason_of_literal(clause const& c, literal const* lits, unsigned sz) const {
+        for (unsigned i = 0; i < sz; ++i) {
+            literal l = lits[i];
+            if (s.value(l) != l_true)
+                continue;
+            justification const& j = s.m_justification[l.var()];
+            if (j.is_clause() && &s.get_clause(j) == &c)
+                return true;
+        }
+        return false;
+    }
+
+    /**
+       \brief vivify the clause of cand.
+       Return false if the solver became inconsistent.
+    */
+    bool vivify::vivify_clause(candidate const& cand) {
+        clause& c = *cand.m_clause;
+        literal const* lits = m_lits.data() + cand.m_begin;
+        unsigned sz = cand.m_size;
+
+        // find the decisions of the previous clause that this clause would also make.
+        unsigned lvl = 0;
+        for (unsigned i = 0; i < sz && lvl < m_decisions.size(); ++i) {
+            literal l = lits[i];
+            if (l == ~m_decisions[lvl])
+                ++lvl;
+            else if (s.value(l) != l_false || s.lvl(l) > lvl)
+                break;
+        }
+        m_num_reused += lvl;
+        backtrack(lvl);
+        reattach();
+        if (s.inconsistent())
+            return false;
+
+        for (unsigned i = 0; i < sz; ++i)
+            if (s.value(lits[i]) == l_true && s.lvl(lits[i]) == 0)
+                return true;
+
+        // c was used to propagate a literal in the prefix.
+        if (is_reason_of_literal(c, lits, sz))
+            backtrack(0);
+
+        ++m_num_checked;
+        s.detach_clause(c);
+        m_detached = &c;
+
+        literal true_lit = null_literal;
+        for (unsigned i = 0; i < sz && !s.inconsistent() && true_lit == null_literal; ++i) {
+            literal l = lits[i];
+            switch (s.value(l)) {
+            case l_true:
+                true_lit = l;
+                break;
+            case l_false:
+                // implied by the previous decisions, or a decision.
+                break;
+            case l_undef:
+                s.push();
+                s.assign_scoped(~l);
+                m_decisions.push_back(~l);
+                ++m_num_decisions;
+                s.propagate_core(false);
+                break;
+            }
+        }
+
+        m_new_lits.reset();
+        unsigned num_decisions = true_lit == null_literal ? m_decisions.size() : s.lvl(true_lit);
+        for (unsigned i = 0; i < num_decisions; ++i)
+            m_new_lits.push_back(~m_decisions[i]);
+        if (true_lit != null_literal)
+            m_new_lits.push_back(true_lit);
+
+        if (s.inconsistent())
+            backtrack(0);
+
+        if (m_new_lits.size() < c.size())
+            strengthen(c);
+        return !s.inconsistent();
+    }
+
+    /**
+       \brief replace the literals of c by m_new_lits at base level.
+    */
+    void vivify::strengthen(clause& c) {
+        SASSERT(m_detached == &c);
+        backtrack(0);
+        m_detached = nullptr;
+        ++m_num_vivified;
+        unsigned old_sz = c.size();
+        unsigned j = 0;
+        for (literal l : m_new_lits) {
+            if (s.value(l) == l_false)
+                continue;
+            if (s.value(l) == l_true) {
+                c.set_removed(true);
+                return;
+            }
+            m_new_lits[j++] = l;
+        }
+        m_new_lits.shrink(j);
+        m_num_elim_literals += old_sz - j;
+        TRACE("sat_vivify", tout << c << " -> " << m_new_lits << "\n";);
+        switch (j) {
+        case 0:
+            s.set_conflict();
+            c.set_removed(true);
+            break;
+        case 1:
+            s.assign_unit(m_new_lits[0]);
+            s.propagate_core(false);
+            c.set_removed(true);
+            break;
+        case 2:
+            s.mk_bin_clause(m_new_lits[0], m_new_lits[1], true);
+            if (s.m_trail.size() > s.m_qhead)
+                s.propagate_core(false);
+            c.set_removed(true);
+            break;
+        default:
+            for (unsigned i = 0; i < j; ++i) {
+                unsigned k = i;
+                while (c[k] != m_new_lits[i])
+                    ++k;
+                std::swap(c[i], c[k]);
+            }
+            s.shrink(c, old_sz, j);
+            c.set_glue(std::min(c.glue(), j));
+            s.attach_clause(c);
+            if (s.m_trail.size() > s.m_qhead)
+                s.propagate_core(false);
+            break;
+        }
+    }
+
+    void vivify::operator()() {
+        if (!s.m_config.m_vivify || s.inconsistent() || s.scope_lvl() > 0 || s.m_learned.empty())
+            return;
+        report _rpt(*this);
+        ++m_num_calls;
+        int64_t budget = s.m_config.m_vivify_ticks;
+        m_counter = budget;
+        init_candidates();
+        for (candidate const& cand : m_candidates) {
+            if (m_counter < 0 || !s.rlimit().inc())
+                break;
+            if (!vivify_clause(cand))
+                break;
+        }
+        if (!s.inconsistent()) {
+            backtrack(0);
+            reattach();
+        }
+        else if (m_detached) {
+            s.attach_clause(*m_detached);
+            m_detached = nullptr;
+        }
+        m_ticks += budget - std::min(m_counter, budget);
+
+        // reclaim clauses that were subsumed or replaced by units and binary clauses.
+        unsigned j = 0;
+        for (clause* cp : s.m_learned) {
+            if (cp->was_removed()) {
+                cp->set_removed(false);
+                s.del_clause(*cp);
+            }
+            else
+                s.m_learned[j++] = cp;
+        }
+        s.m_learned.shrink(j);
+        m_candidates.reset();
+        m_lits.reset();
+        m_decisions.reset();
+    }
+
+    void vivify::collect_statistics(statistics& st) const {
+        st.update("sat vivify rounds", m_num_calls);
+        st.update("sat vivify checked", m_num_checked);
+        st.update("sat vivify strengthened", m_num_vivified);
+        st.update("sat vivify elim literals", m_num_elim_literals);
+        st.update("sat vivify reused levels", m_num_reused);
+        st.update("sat vivify decisions", m_num_decisions);
+        st.update("sat vivify ticks", static_cast<double>(m_ticks));
+    }
+
+    void vivify::reset_statistics() {
+        m_num_calls = 0;
+        m_num_checked = 0;
+        m_num_vivified = 0;
+        m_num_elim_literals = 0;
+        m_num_reused = 0;
+        m_num_decisions = 0;
+        m_ticks = 0;
+    }
+}
@@ -0,0 +1,81 @@
+/*++
+  Copyright (c) 2024 Microsoft Corporation
+
+  Module Name:
+
+   sat_vivify.h
+
+  Abstract:
+
+    Vivification of learned clauses.
+
+    Learned clauses in the core and mid tiers (by glue, see gc.tier1_glue
+    and gc.tier2_glue) are strengthened by assigning the negation of their
+    literals one at a time and propagating:
+    - a literal that becomes false is implied by the previous ones and is removed;
+    - a literal that becomes true, or a conflict, ends the clause early.
+
+    Literals of each clause are ordered by the number of occurrences in
+    the candidate clauses, and the clauses are sorted by these literal
+    sequences. Consecutive clauses then share a prefix of decisions and
+    the trail for the shared prefix is kept instead of being recomputed.
+
+    The work is bounded by the number of watch list entries visited
+    during propagation (vivify.ticks).
+
+  --*/
+
+#pragma once
+
+#include "util/statistics.h"
+#include "sat/sat_types.h"
+
+namespace sat {
+    class solver;
+
+    class vivify {
+        struct report;
+        struct candidate {
+            clause*  m_clause;
+            unsigned m_begin;
+            unsigned m_size;
+        };
+
+        solver&            s;
+        int64_t            m_counter = 0;
+        unsigned_vector    m_occs;          // number of occurrences of a literal in the candidates
+        literal_vector     m_lits;          // sorted literals of the candidates
+        svector<candidate> m_candidates;
+        literal_vector     m_decisions;     // m_decisions[i] is the decision at level i + 1
+        literal_vector     m_new_lits;
+        clause*            m_detached = nullptr;
+
+        // stats
+        unsigned           m_num_calls = 0;
+        unsigned           m_num_checked = 0;
+        unsigned           m_num_vivified = 0;
+        unsigned           m_num_elim_literals = 0;
+        unsigned           m_num_reused = 0;
+        unsigned           m_num_decisions = 0;
+        uint64_t           m_ticks = 0;
+
+        bool lit_lt(literal a, literal b) const;
+        bool candidate_lt(candidate const& a, candidate const& b) const;
+        void init_candidates();
+        void backtrack(unsigned lvl);
+        void reattach();
+        bool is_reason_of_literal(clause const& c, literal const* lits, unsigned sz) const;
+        bool vivify_clause(candidate const& cand);
+        void strengthen(clause& c);
+
+    public:
+        vivify(solver& s): s(s) {}
+
+        void operator()();
+
+        inline void dec(unsigned c) { m_counter -= c; }
+
+        void collect_statistics(statistics& st) const;
+        void reset_statistics();
+    };
+}
@@ -43,66 +43,74 @@ namespace sat {
             BINARY = 0, CLAUSE, EXT_CONSTRAINT
         };
     private:
-        size_t   m_val1;
-        unsigned m_val2; 
+        /**
+           Watches are packed into a single 64-bit word so that a watch list
+           entry occupies 8 bytes.
+           The low 32 bits contain the kind (2 bits) followed by the learned flag (binary clauses) 
+           or the blocked literal (clauses). The high 32 bits contain the implied literal (binary clauses)
+           or the clause offset (clauses). External constraint indices are aligned, so the kind
+           is stored in their low bits.
+        */
+        uint64_t m_val;
+
+        static uint64_t mk_val(unsigned lo, unsigned hi) { return static_cast<uint64_t>(lo) | (static_cast<uint64_t>(hi) << 32); }
+        unsigned lo() const { return static_cast<unsigned>(m_val); }
+        unsigned hi() const { return static_cast<unsigned>(m_val >> 32); }
     public:
         watched(literal l, bool learned):
-            m_val1(l.to_uint()),
-            m_val2(static_cast<unsigned>(BINARY) + (static_cast<unsigned>(learned) << 2)) {
+            m_val(mk_val(static_cast<unsigned>(BINARY) + (static_cast<unsigned>(learned) << 2), l.to_uint())) {
             SASSERT(is_binary_clause());
             SASSERT(get_literal() == l);
             SASSERT(is_learned() == learned);
             SASSERT(learned || is_binary_non_learned_clause());
         }
 
-
-        unsigned val2() const { return m_val2; }
+        unsigned val2() const { return lo(); }
 
         watched(literal blocked_lit, clause_offset cls_off):
-            m_val1(cls_off), 
-            m_val2(static_cast<unsigned>(CLAUSE) + (blocked_lit.to_uint() << 2)) {
+            m_val(mk_val(static_cast<unsigned>(CLAUSE) + (blocked_lit.to_uint() << 2), cls_off)) {
             SASSERT(is_clause());
             SASSERT(get_blocked_literal() == blocked_lit);
             SASSERT(get_clause_offset() == cls_off);
         }
 
         explicit watched(ext_constraint_idx cnstr_idx):
-            m_val1(cnstr_idx),
-            m_val2(static_cast<unsigned>(EXT_CONSTRAINT)) {
+            m_val(static_cast<uint64_t>(cnstr_idx) | static_cast<uint64_t>(EXT_CONSTRAINT)) {
+            SASSERT((cnstr_idx & 3) == 0);
             SASSERT(is_ext_constraint());
             SASSERT(get_ext_constraint_idx() == cnstr_idx);
         }
 
-        kind get_kind() const { return static_cast<kind>(m_val2 & 3); }
+        kind get_kind() const { return static_cast<kind>(m_val & 3); }
        
         bool is_binary_clause() const { return get_kind() == BINARY; }
-        literal get_literal() const { SASSERT(is_binary_clause()); return to_literal(static_cast<unsigned>(m_val1)); }
-        void set_literal(literal l) { SASSERT(is_binary_clause()); m_val1 = l.to_uint(); }
-        bool is_learned() const { SASSERT(is_binary_clause()); return ((m_val2 >> 2) & 1) == 1; }
+        literal get_literal() const { SASSERT(is_binary_clause()); return to_literal(hi()); }
+        void set_literal(literal l) { SASSERT(is_binary_clause()); m_val = mk_val(lo(), l.to_uint()); }
+        bool is_learned() const { SASSERT(is_binary_clause()); return ((m_val >> 2) & 1) == 1; }
 
         bool is_binary_learned_clause() const { return is_binary_clause() && is_learned(); }
         bool is_binary_non_learned_clause() const { return is_binary_clause() && !is_learned(); }
 
-        void set_learned(bool l) { if (l) m_val2 |= 4u; else m_val2 &= ~4u; SASSERT(is_learned() == l); }
+        void set_learned(bool l) { if (l) m_val |= 4u; else m_val &= ~static_cast<uint64_t>(4u); SASSERT(is_learned() == l); }
                 
 
         bool is_clause() const { return get_kind() == CLAUSE; }
-        clause_offset get_clause_offset() const { SASSERT(is_clause()); return static_cast<clause_offset>(m_val1); }
-        literal get_blocked_literal() const { SASSERT(is_clause()); return to_literal(m_val2 >> 2); }
-        void set_clause_offset(clause_offset c) { SASSERT(is_clause()); m_val1 = c; }
-        void set_blocked_literal(literal l) { SASSERT(is_clause()); m_val2 = static_cast<unsigned>(CLAUSE) + (l.to_uint() << 2); }
+        clause_offset get_clause_offset() const { SASSERT(is_clause()); return static_cast<clause_offset>(hi()); }
+        literal get_blocked_literal() const { SASSERT(is_clause()); return to_literal(lo() >> 2); }
+        void set_clause_offset(clause_offset c) { SASSERT(is_clause()); m_val = mk_val(lo(), c); }
+        void set_blocked_literal(literal l) { SASSERT(is_clause()); m_val = mk_val(static_cast<unsigned>(CLAUSE) + (l.to_uint() << 2), hi()); }
         void set_clause(literal blocked_lit, clause_offset cls_off) {
-            m_val1 = cls_off;
-            m_val2 = static_cast<unsigned>(CLAUSE) + (blocked_lit.to_uint() << 2);
+            m_val = mk_val(static_cast<unsigned>(CLAUSE) + (blocked_lit.to_uint() << 2), cls_off);
         }
 
         bool is_ext_constraint() const { return get_kind() == EXT_CONSTRAINT; }
-        ext_constraint_idx get_ext_constraint_idx() const { SASSERT(is_ext_constraint()); return m_val1; }
+        ext_constraint_idx get_ext_constraint_idx() const { SASSERT(is_ext_constraint()); return static_cast<ext_constraint_idx>(m_val & ~static_cast<uint64_t>(3)); }
         
-        bool operator==(watched const & w) const { return m_val1 == w.m_val1 && m_val2 == w.m_val2; }
+        bool operator==(watched const & w) const { return m_val == w.m_val; }
         bool operator!=(watched const & w) const { return !operator==(w); }
     };
 
+    static_assert(sizeof(watched) == 8, "watch list entries are expected to be 8 bytes");
     static_assert(0 <= watched::BINARY && watched::BINARY <= 2, "");
     static_assert(0 <= watched::CLAUSE && watched::CLAUSE <= 2, "");
     static_assert(0 <= watched::EXT_CONSTRAINT && watched::EXT_CONSTRAINT <= 2, "");
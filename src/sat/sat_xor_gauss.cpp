@@ -0,0 +1,156 @@
+/*++
+  Copyright (c) 2024 Microsoft Corporation
+
+  Module Name:
+
+   sat_xor_gauss.cpp
+
+  Abstract:
+   
+    Gauss-Jordan elimination of XOR constraints.
+
+  --*/
+
+#include "util/union_find.h"
+#include "math/simplex/bit_matrix.h"
+#include "sat/sat_xor_gauss.h"
+#include "sat/sat_xor_finder.h"
+#include "sat/sat_elim_eqs.h"
+
+namespace sat {
+
+    struct xor_gauss::report {
+        xor_gauss& g;
+        stopwatch  m_watch;
+        report(xor_gauss& g): g(g) { m_watch.start(); }
+        ~report() {
+            m_watch.stop();
+            IF_VERBOSE(2,
+                       verbose_stream() << " (sat.xor-gauss"
+                       << " :xors " << g.m_stats.m_num_xors
+                       << " :columns " << g.m_stats.m_num_columns
+                       << " :units " << g.m_stats.m_num_units
+                       << " :eqs " << g.m_stats.m_num_eqs
+                       << " :skipped " << g.m_stats.m_num_skipped
+                       << m_watch << ")\n");
+        }
+    };
+
+    /**
+       \brief extract xors from the irredundant clauses.
+       The literals of each xor sum to 1.
+    */
+    void xor_gauss::collect_xors(vector<literal_vector>& xors) {
+        clause_vector clauses(s.clauses());
+        std::function<void(literal_vector const&)> f =
+            [&](literal_vector const& x) { xors.push_back(x); };
+        xor_finder xf(s);
+        xf.set(f);
+        xf(clauses);
+    }
+
+    unsigned xor_gauss::column(bool_var v) {
+        if (m_var2column[v] == UINT_MAX) {
+            m_var2column[v] = m_column2var.size();
+            m_column2var.push_back(v);
+        }
+        return m_var2column[v];
+    }
+
+    void xor_gauss::operator()() {
+        SASSERT(s.at_base_lvl());
+        report _report(*this);
+        vector<literal_vector> xors;
+        collect_xors(xors);
+        m_stats.m_num_xors = xors.size();
+        if (xors.empty())
+            return;
+
+        // variables assigned at base level are moved to the right-hand side.
+        m_var2column.reset();
+        m_var2column.resize(s.num_vars(), UINT_MAX);
+        m_column2var.reset();
+        for (auto const& x : xors)
+            for (literal l : x)
+                if (s.value(l) == l_undef)
+                    column(l.var());
+        unsigned rhs = m_column2var.size();
+        m_stats.m_num_columns = rhs;
+        if (static_cast<uint64_t>(xors.size()) * (rhs + 1) > s.get_config().m_xor_gauss_max_cells) {
+            ++m_stats.m_num_skipped;
+            return;
+        }
+
+        bit_matrix bm;
+        bm.reset(rhs + 1);
+        for (auto const& x : xors) {
+            auto r = bm.add_row();
+            bool parity = true;
+            for (literal l : x) {
+                parity ^= l.sign();
+                if (s.value(l) == l_undef)
+                    r.set(m_var2column[l.var()], !r[m_var2column[l.var()]]);
+                else if (s.value(l.var()) == l_true)
+                    parity ^= true;
+            }
+            r.set(rhs, parity);
+        }
+        bm.solve();
+        TRACE("sat_xor_gauss", tout << bm << "\n";);
+
+        union_find_default_ctx ctx;
+        union_find<> uf(ctx);
+        for (unsigned i = 2 * s.num_vars(); i-- > 0; ) 
+            uf.mk_var();
+
+        for (auto const& r : bm) {
+            unsigned cols[2] = { rhs, rhs };
+            unsigned n = 0;
+            for (unsigned c : r) {
+                if (c == rhs)
+                    break;
+                if (n < 2)
+                    cols[n] = c;
+                ++n;
+            }
+            bool parity = r[rhs];
+            if (n == 0 && parity) {
+                s.set_conflict();
+                return;
+            }
+            else if (n == 1) {
+                // x = parity
+                literal lit(m_column2var[cols[0]], !parity);
+                if (s.value(lit) == l_false) {
+                    s.set_conflict();
+                    return;
+                }
+                if (s.value(lit) == l_undef) {
+                    s.assign_unit(lit);
+                    ++m_stats.m_num_units;
+                }
+            }
+            else if (n == 2) {
+                // x + y = parity
+                literal x(m_column2var[cols[0]], false);
+                literal y(m_column2var[cols[1]], parity);
+                uf.merge(x.index(), y.index());
+                uf.merge((~x).index(), (~y).index());
+                ++m_stats.m_num_eqs;
+            }
+        }
+        if (m_stats.m_num_units > 0)
+            s.propagate(false);
+        if (m_stats.m_num_eqs > 0 && !s.inconsistent()) {
+            elim_eqs elim(s);
+            elim(uf);
+        }
+    }
+
+    void xor_gauss::collect_statistics(statistics& st) const {
+        st.update("sat xor gauss xors", m_stats.m_num_xors);
+        st.update("sat xor gauss units", m_stats.m_num_units);
+        st.update("sat xor gauss eqs", m_stats.m_num_eqs);
+        st.update("sat xor gauss skipped", m_stats.m_num_skipped);
+    }
+}
@@ -0,0 +1,56 @@
+/*++
+  Copyright (c) 2024 Microsoft Corporation
+
+  Module Name:
+
+   sat_xor_gauss.h
+
+  Abstract:
+   
+    Gauss-Jordan elimination of XOR constraints.
+
+    XORs are extracted from clauses by the xor_finder and
+    solved as a linear system over GF(2) using a bit_matrix.
+    Systems whose matrix has more than xor.gauss.max_cells entries
+    are skipped.
+    Rows of the reduced system with one variable become units,
+    rows with two variables become equivalences and a row
+    without variables, but with right-hand side 1, is a conflict.
+
+  --*/
+
+#pragma once
+
+#include "util/statistics.h"
+#include "sat/sat_types.h"
+#include "sat/sat_solver.h"
+
+namespace sat {
+
+    class xor_gauss {
+        struct report;
+
+        struct stats {
+            unsigned m_num_xors = 0;
+            unsigned m_num_columns = 0;
+            unsigned m_num_units = 0;
+            unsigned m_num_eqs = 0;
+            unsigned m_num_skipped = 0;
+            void reset() { *this = stats(); }
+        };
+
+        solver&          s;
+        stats            m_stats;
+        unsigned_vector  m_var2column;
+        bool_var_vector  m_column2var;
+
+        void collect_xors(vector<literal_vector>& xors);
+        unsigned column(bool_var v);
+
+    public:
+        xor_gauss(solver& s) : s(s) {}
+
+        void operator()();
+        void collect_statistics(statistics& st) const;
+    };
+}
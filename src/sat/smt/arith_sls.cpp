@@ -36,8 +36,8 @@ namespace arith {
         if (unsat().size() == 1) {
             auto idx = *unsat().begin();
             verbose_stream() << idx << "\n";
-            auto const& c = *m_bool_search->m_clauses[idx].m_clause;
-            verbose_stream() << c << "\n";
+            auto c = get_clause(idx);
+            verbose_stream() << sat::literal_vector(c.size(), c.begin()) << "\n";
             for (auto lit : c) {
                 bool_var bv = lit.var();
                 ineq* i = atom(bv);
@@ -135,7 +135,7 @@ namespace arith {
         m_bool_vars.reserve(s.s().num_vars());
         add_vars();
         for (unsigned i = 0; i < d->num_clauses(); ++i)
-            for (sat::literal lit : *d->get_clause_info(i).m_clause)
+            for (sat::literal lit : d->get_clause_lits(i))
                 init_bool_var(lit.var());
         for (unsigned v = 0; v < s.s().num_vars(); ++v)
             init_bool_var_assignment(v);
@@ -357,14 +357,12 @@ namespace arith {
                   
             // lit flips form false to true:            
             for (auto cl : m_bool_search->get_use_list(lit)) {
-                auto const& clause = get_clause_info(cl);
-                if (!clause.is_true())
+                if (m_bool_search->get_num_trues(cl) == 0)
                     ++score;
             }
             // ignore the situation where clause contains multiple literals using v
             for (auto cl : m_bool_search->get_use_list(~lit)) {
-                auto const& clause = get_clause_info(cl);
-                if (clause.m_num_trues == 1)
+                if (m_bool_search->get_num_trues(cl) == 1)
                     --score;
             }
         }
@@ -111,10 +111,7 @@ namespace arith {
 
         indexed_uint_set& unsat() { return m_bool_search->unsat_set(); }
         unsigned num_clauses() const { return m_bool_search->num_clauses(); }
-        sat::clause& get_clause(unsigned idx) { return *get_clause_info(idx).m_clause; }
-        sat::clause const& get_clause(unsigned idx) const { return *get_clause_info(idx).m_clause; }
-        sat::ddfw::clause_info& get_clause_info(unsigned idx) { return m_bool_search->get_clause_info(idx); }
-        sat::ddfw::clause_info const& get_clause_info(unsigned idx) const { return m_bool_search->get_clause_info(idx); }
+        sat::ddfw::clause_lits get_clause(unsigned idx) const { return m_bool_search->get_clause_lits(idx); }
         bool is_true(sat::literal lit) { return lit.sign() != m_bool_search->get_value(lit.var()); }
         bool sign(sat::bool_var v) const { return !m_bool_search->get_value(v); }
 
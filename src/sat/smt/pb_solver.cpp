@@ -1415,9 +1415,11 @@ namespace pb {
         SASSERT(c->well_formed());
         VERIFY(c->well_formed());
         if (m_solver && m_solver->get_config().m_drat) {
-            auto * out = s().get_drat().out();
-            if (out)
-                *out << "c ba constraint " << *c << " 0\n";
+            if (s().get_drat().out()) {
+                std::ostringstream strm;
+                strm << "c ba constraint " << *c << " 0\n";
+                s().get_drat().write(strm.str());
+            }
         }
     }
 
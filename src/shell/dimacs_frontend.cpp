@@ -25,6 +25,7 @@ Revision History:
 #include "sat/dimacs.h"
 #include "sat/sat_params.hpp"
 #include "sat/sat_solver.h"
+#include "sat/sat_cube_and_conquer.h"
 #include "sat/tactic/goal2sat.h"
 #include "sat/tactic/sat2goal.h"
 #include "ast/reg_decl_plugins.h"
@@ -219,6 +220,24 @@ lbool solve_parallel(sat::solver& s) {
     return r;
 }
 
+static lbool solve_cube_and_conquer(sat::solver& s, unsigned num_workers) {
+    sat::cube_and_conquer cc(s, num_workers);
+    std::function<void(sat::cube_and_conquer::cube_info const&)> on_cube = 
+        [&](sat::cube_and_conquer::cube_info const& info) {
+        std::cout << "c cube " << info.m_id 
+                  << " worker " << info.m_worker 
+                  << " size " << info.m_size
+                  << " result " << (info.m_pruned ? "pruned" : info.m_result == l_false ? "unsat" : info.m_result == l_true ? "sat" : "unknown");
+        if (info.m_result == l_false && !info.m_pruned)
+            std::cout << " core " << info.m_core_size;
+        std::cout << " time " << info.m_seconds << "\n";
+    };
+    cc.set(on_cube);
+    lbool r = cc();
+    cc.collect_statistics(g_st);
+    return r;
+}
+
 unsigned read_dimacs(char const * file_name) {
     g_start_time = clock();
     register_on_timeout_proc(on_timeout);
@@ -261,6 +280,9 @@ unsigned read_dimacs(char const * file_name) {
     else if (par.get_bool("enable", false)) {
         r = solve_parallel(solver);
     }
+    else if (sp.cube_and_conquer()) {
+        r = solve_cube_and_conquer(solver, sp.threads());
+    }
     else {
         r = g_solver->check();
     }
@@ -7,11 +7,15 @@ Copyright (c) 2020 Microsoft Corporation
 #include<fstream>
 #include "util/memory_manager.h"
 #include "util/statistics.h"
+#include "util/stopwatch.h"
+#include "util/gparams.h"
 #include "ast/proofs/proof_checker.h"
 #include "ast/reg_decl_plugins.h"
 #include "sat/dimacs.h"
 #include "sat/sat_solver.h"
 #include "sat/sat_drat.h"
+#include "sat/sat_proof_trim.h"
+#include "sat/sat_params.hpp"
 #include "shell/drat_frontend.h"
 
 
@@ -64,6 +68,67 @@ public:
     }
 };
 
+/**
+* Replay the proof in the trimmer and report the steps that are needed
+* to derive the empty clause. Input clauses are marked with 'i' in the
+* proof, other clauses are lemmas. Steps are numbered from 1 in the
+* order they occur in the file.
+*/
+static unsigned trim_drat(dimacs::drat_parser& drat, unsigned num_threads) {
+    params_ref p;
+    p.set_uint("threads", num_threads);
+    reslimit lim;
+    sat::proof_trim trim(p, lim);
+    unsigned id = 0, num_inputs = 0, num_lemmas = 0, num_deleted = 0;
+
+    stopwatch sw;
+    sw.start();
+    for (auto const& r : drat) {
+        trim.init_clause();
+        for (sat::literal lit : r.m_lits) {
+            while (lit.var() >= trim.num_vars())
+                trim.mk_var();
+            trim.add_literal(lit.var(), lit.sign());
+        }
+        ++id;
+        if (r.m_status.is_deleted()) {
+            ++num_deleted;
+            trim.del();
+        }
+        else if (r.m_status.is_input()) {
+            ++num_inputs;
+            trim.assume(id);
+        }
+        else {
+            ++num_lemmas;
+            trim.infer(id);
+        }
+    }
+    sw.stop();
+    double replay_time = sw.get_seconds();
+
+    if (!trim.has_empty_clause()) {
+        std::cout << "proof does not contain the empty clause\n";
+        return 0;
+    }
+
+    sw.reset();
+    sw.start();
+    auto core = trim.trim();
+    sw.stop();
+
+    for (auto const& [step, deps] : core)
+        IF_VERBOSE(1, verbose_stream() << step << ": " << deps << "\n");
+    std::cout << "steps:       " << id << " (" << num_inputs << " input, " << num_lemmas << " lemmas, " << num_deleted << " deleted)\n";
+    std::cout << "core steps:  " << core.size() << "\n";
+    std::cout << "replay time: " << replay_time << " s\n";
+    std::cout << "trim time:   " << sw.get_seconds() << " s\n";
+    statistics st;
+    trim.collect_statistics(st);
+    std::cout << st;
+    return 0;
+}
+
 unsigned read_drat(char const* drat_file) {
     ast_manager m;
     reg_decl_plugins(m);
@@ -77,6 +142,9 @@ unsigned read_drat(char const* drat_file) {
         return m.get_family_name(th);
     };
     drat.set_read_theory(read_theory);
+    sat_params sp(gparams::get_module("sat"));
+    if (sp.drat_trim())
+        return trim_drat(drat, sp.threads());
     params_ref p;
     reslimit lim;
     sat::solver solver(p, lim);
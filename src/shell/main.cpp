@@ -52,6 +52,7 @@ static input_kind   g_input_kind          = IN_UNSPECIFIED;
 bool                g_display_statistics  = false;
 bool                g_display_model       = false;
 static bool         g_display_istatistics = false;
+static bool         g_bench_scanner       = false;
 
 static void error(const char * msg) {
     std::cerr << "Error: " << msg << "\n";
@@ -86,6 +87,7 @@ void display_usage() {
     std::cout << "  -log        use parser for Z3 log input format.\n";
     std::cout << "  -in         read formula from standard input.\n";
     std::cout << "  -model      display model for satisfiable SMT.\n";
+    std::cout << "  -bench_scan only tokenize the SMT 2 input and report the scanner throughput in MB/s.\n";
     std::cout << "\nMiscellaneous:\n";
     std::cout << "  -h, -?      prints this message.\n";
     std::cout << "  -version    prints version number of Z3.\n";
@@ -214,6 +216,9 @@ static void parse_cmd_line_args(std::string& input_file, int argc, char ** argv)
             else if (strcmp(opt_name, "model") == 0) {
                 g_display_model = true;
             }
+            else if (strcmp(opt_name, "bench_scan") == 0) {
+                g_bench_scanner = true;
+            }
             else if (strcmp(opt_name, "ist") == 0) {
                 g_display_istatistics = true; 
             }
@@ -381,7 +386,10 @@ int STD_CALL main(int argc, char ** argv) {
         switch (g_input_kind) {
         case IN_SMTLIB_2:
             memory::exit_when_out_of_memory(true, "(error \"out of memory\")");
-            return_value = read_smtlib2_commands(g_input_file);
+            if (g_bench_scanner && g_input_file)
+                return_value = bench_smtlib2_scanner(g_input_file);
+            else
+                return_value = read_smtlib2_commands(g_input_file);
             break;
         case IN_DIMACS:
             return_value = read_dimacs(g_input_file);
@@ -19,11 +19,15 @@ Revision History:
 
 --*/
 #include<iostream>
+#include<fstream>
 #include<time.h>
 #include<signal.h>
 #include "util/timeout.h"
 #include "util/mutex.h"
+#include "util/mapped_file.h"
+#include "util/stopwatch.h"
 #include "parsers/smt2/smt2parser.h"
+#include "parsers/smt2/smt2scanner.h"
 #include "muz/fp/dl_cmds.h"
 #include "cmd_context/extra_cmds/dbg_cmds.h"
 #include "cmd_context/extra_cmds/proof_cmds.h"
@@ -174,12 +178,12 @@ unsigned read_smtlib2_commands(char const * file_name) {
 
     bool result = true;
     if (file_name) {
-        std::ifstream in(file_name);
-        if (in.bad() || in.fail()) {
+        mapped_file in(file_name);
+        if (!in.is_open()) {
             std::cerr << "(error \"failed to open file '" << file_name << "'\")" << std::endl;
             exit(ERR_OPEN_FILE);
         }
-        result = parse_smt2_commands(ctx, in);
+        result = parse_smt2_commands(ctx, in.begin(), in.end());
     }
     else {
         result = parse_smt2_commands(ctx, std::cin, true);
@@ -191,3 +195,43 @@ unsigned read_smtlib2_commands(char const * file_name) {
     return result ? 0 : 1;
 }
 
+/**
+   \brief Report the throughput of the SMT-LIB2 scanner on the given file,
+   once over the memory mapped contents and once over an input stream.
+   Commands are tokenized but not executed.
+*/
+unsigned bench_smtlib2_scanner(char const * file_name) {
+    mapped_file in(file_name);
+    if (!in.is_open()) {
+        std::cerr << "(error \"failed to open file '" << file_name << "'\")" << std::endl;
+        exit(ERR_OPEN_FILE);
+    }
+    cmd_context ctx;
+    double mb = static_cast<double>(in.size()) / (1024.0 * 1024.0);
+    auto run = [&](char const * mode, smt2::scanner & s) {
+        stopwatch sw;
+        sw.start();
+        unsigned num_tokens = 0;
+        try {
+            while (s.scan() != smt2::scanner::EOF_TOKEN)
+                ++num_tokens;
+        }
+        catch (smt2::scanner_exception & ex) {
+            std::cerr << "(error \"line " << s.get_line() << " column " << s.get_pos() << ": " << ex.msg() << "\")" << std::endl;
+        }
+        sw.stop();
+        double secs = sw.get_seconds();
+        std::cout << "(:mode " << mode << " :tokens " << num_tokens << " :size-mb " << mb
+                  << " :time " << secs << " :mb-per-sec " << (secs > 0 ? mb / secs : 0) << ")" << std::endl;
+    };
+    {
+        smt2::scanner s(ctx, in.begin(), in.end());
+        run(in.is_mapped() ? "mmap" : "buffer", s);
+    }
+    {
+        std::ifstream is(file_name);
+        smt2::scanner s(ctx, is);
+        run("stream", s);
+    }
+    return 0;
+}
@@ -20,6 +20,7 @@ Revision History:
 
 unsigned read_smtlib_file(char const * benchmark_file);
 unsigned read_smtlib2_commands(char const * command_file);
+unsigned bench_smtlib2_scanner(char const * file_name);
 void help_tactics();
 void help_simplifiers();
 void help_probes();
@@ -21,6 +21,8 @@ Revision History:
 #include "util/pool.h"
 #include "util/trail.h"
 #include "util/stopwatch.h"
+#include "util/obj_pair_hashtable.h"
+#include "ast/for_each_expr.h"
 #include "ast/ast_pp.h"
 #include "ast/ast_ll_pp.h"
 #include "ast/ast_smt2_pp.h"
@@ -387,6 +389,7 @@ namespace {
         unsigned                   m_num_choices;
         instruction *              m_root;
         enode_vector               m_candidates;
+        ptr_vector<quantifier>     m_quantifiers; //!< quantifiers with a pattern in this tree, used for profiling.
 #ifdef Z3DEBUG
         context *                  m_context;
         ptr_vector<app>            m_patterns;
@@ -542,9 +545,13 @@ namespace {
             return m_candidates;
         }
 
+        ptr_vector<quantifier> & get_quantifiers() {
+            return m_quantifiers;
+        }
+
 #ifdef Z3DEBUG
         void set_context(context * ctx) {
-            SASSERT(m_context == 0);
+            SASSERT(m_context == 0 || m_context == ctx);
             m_context = ctx;
         }
 
@@ -590,10 +597,16 @@ namespace {
         label_hasher &    m_lbl_hasher;
         trail_stack &     m_trail_stack;
         region &          m_region;
+        region            m_persistent_region; // instructions of code trees that survive backtracking.
+        bool              m_persistent = false;
+
+        region & get_region() {
+            return m_persistent ? m_persistent_region : m_region;
+        }
 
         template<typename OP>
         OP * mk_instr(opcode op, unsigned size) {
-            void * mem = m_region.allocate(size);
+            void * mem = get_region().allocate(size);
             OP * r = new (mem) OP;
             r->m_opcode = op;
             r->m_next   = nullptr;
@@ -627,6 +640,19 @@ namespace {
             m_region(s.get_region()) {
         }
 
+        /**
+           \brief Allocate new instructions in a region that is not popped on backtracking.
+           Updates to existing instructions are still recorded in the trail.
+        */
+        void set_persistent(bool f) {
+            m_persistent = f;
+        }
+
+        void reset_persistent() {
+            SASSERT(!m_persistent);
+            m_persistent_region.reset();
+        }
+
         code_tree * mk_code_tree(func_decl * lbl, unsigned short num_args, bool filter_candidates) {
             code_tree * r = alloc(code_tree,m_lbl_hasher, lbl, num_args, filter_candidates);
             r->m_root     = mk_init(num_args);
@@ -634,7 +660,7 @@ namespace {
         }
 
         joint2 * mk_joint2(func_decl * f, unsigned pos, unsigned reg) {
-            return new (m_region) joint2(f, pos, reg);
+            return new (get_region()) joint2(f, pos, reg);
         }
 
         compare * mk_compare(unsigned reg1, unsigned reg2) {
@@ -2865,29 +2891,117 @@ namespace {
     //
     // ------------------------------------
     class code_tree_map {
+        // maximal number of code trees whose instructions are allocated in the persistent region.
+        static const unsigned max_persistent_trees = 4096;
+
         ast_manager &               m;
         compiler &                  m_compiler;
+        code_tree_manager &         m_ct_manager;
         ptr_vector<code_tree>       m_trees;       // mapping: func_label -> tree
         trail_stack &               m_trail_stack;
+        // code trees that were removed by backtracking, indexed by (quantifier, multi-pattern) and first_idx.
+        obj_pair_map<quantifier, app, ptr_vector<code_tree>*> m_cache;
+        unsigned                    m_num_persistent = 0;
+        unsigned                    m_num_reused = 0;
 #ifdef Z3DEBUG
         context *                   m_context;
 #endif
 
         class mk_tree_trail : public trail {
-            ptr_vector<code_tree> & m_trees;
-            unsigned                m_lbl_id;
+            code_tree_map & m_map;
+            unsigned        m_lbl_id;
+            quantifier *    m_qa;        // not null if the tree is persistent.
+            app *           m_mp;
+            unsigned        m_first_idx;
         public:
-            mk_tree_trail(ptr_vector<code_tree> & t, unsigned id):m_trees(t), m_lbl_id(id) {}
+            mk_tree_trail(code_tree_map & t, unsigned id, quantifier * qa, app * mp, unsigned first_idx):
+                m_map(t), m_lbl_id(id), m_qa(qa), m_mp(mp), m_first_idx(first_idx) {}
             void undo() override {
-                dealloc(m_trees[m_lbl_id]);
-                m_trees[m_lbl_id] = nullptr;
+                code_tree * t = m_map.m_trees[m_lbl_id];
+                m_map.m_trees[m_lbl_id] = nullptr;
+                if (m_qa)
+                    m_map.save_tree(m_qa, m_mp, m_first_idx, t);
+                else
+                    dealloc(t);
             }
         };
 
+        /**
+           \brief Return true if the code tree for mp can be kept after backtracking.
+           Ground sub-terms of the patterns are compiled into instructions that refer
+           to their enodes, and these are deleted when the scope is popped.
+        */
+        bool is_persistent(app * mp) const {
+            for (expr * arg : *mp) {
+                for (expr * t : subterms::all(expr_ref(arg, m)))
+                    if (is_app(t) && is_ground(t))
+                        return false;
+            }
+            return true;
+        }
+
+        /**
+           \brief Store a persistent tree removed by backtracking.
+           All updates made by insertions were undone, so the tree contains only the
+           instructions created by mk_tree for the given arguments.
+        */
+        void save_tree(quantifier * qa, app * mp, unsigned first_idx, code_tree * t) {
+            SASSERT(t->get_quantifiers().empty());
+            ptr_vector<code_tree> * ts = nullptr;
+            if (!m_cache.find(qa, mp, ts)) {
+                ts = alloc(ptr_vector<code_tree>);
+                m.inc_ref(qa);
+                m.inc_ref(mp);
+                m_cache.insert(qa, mp, ts);
+            }
+            ts->reserve(first_idx + 1, nullptr);
+            SASSERT((*ts)[first_idx] == nullptr);
+            (*ts)[first_idx] = t;
+        }
+
+        code_tree * find_tree(quantifier * qa, app * mp, unsigned first_idx) {
+            ptr_vector<code_tree> * ts = nullptr;
+            if (!m_cache.find(qa, mp, ts) || first_idx >= ts->size())
+                return nullptr;
+            code_tree * t = (*ts)[first_idx];
+            (*ts)[first_idx] = nullptr;
+            return t;
+        }
+
+        void reset_cache() {
+            for (auto const& kv : m_cache) {
+                ptr_vector<code_tree> * ts = kv.get_value();
+                std::for_each(ts->begin(), ts->end(), delete_proc<code_tree>());
+                dealloc(ts);
+                m.dec_ref(kv.get_key1());
+                m.dec_ref(kv.get_key2());
+            }
+            m_cache.reset();
+        }
+
+        code_tree * mk_tree(quantifier * qa, app * mp, unsigned first_idx, bool & persistent) {
+            persistent = false;
+            code_tree * t = find_tree(qa, mp, first_idx);
+            if (t) {
+                persistent = true;
+                m_num_reused++;
+                TRACE("mam_cache", tout << "reusing code tree for:\n" << mk_pp(mp, m) << "\n";);
+                return t;
+            }
+            persistent = m_num_persistent < max_persistent_trees && is_persistent(mp);
+            if (persistent)
+                m_num_persistent++;
+            m_ct_manager.set_persistent(persistent);
+            t = m_compiler.mk_tree(qa, mp, first_idx, false);
+            m_ct_manager.set_persistent(false);
+            return t;
+        }
+
     public:
-        code_tree_map(ast_manager & m, compiler & c, trail_stack & s):
+        code_tree_map(ast_manager & m, compiler & c, code_tree_manager & ct, trail_stack & s):
             m(m),
             m_compiler(c),
+            m_ct_manager(ct),
             m_trail_stack(s) {
         }
 
@@ -2897,6 +3011,11 @@ namespace {
 
         ~code_tree_map() {
             std::for_each(m_trees.begin(), m_trees.end(), delete_proc<code_tree>());
+            reset_cache();
+        }
+
+        unsigned num_reused() const {
+            return m_num_reused;
         }
 
         /**
@@ -2915,10 +3034,14 @@ namespace {
             unsigned lbl_id   = lbl->get_small_id();
             m_trees.reserve(lbl_id+1, nullptr);
             if (m_trees[lbl_id] == nullptr) {
-                m_trees[lbl_id] = m_compiler.mk_tree(qa, mp, first_idx, false);
+                bool persistent = false;
+                m_trees[lbl_id] = mk_tree(qa, mp, first_idx, persistent);
                 SASSERT(m_trees[lbl_id]->expected_num_args() == p->get_num_args());
                 DEBUG_CODE(m_trees[lbl_id]->set_context(m_context););
-                m_trail_stack.push(mk_tree_trail(m_trees, lbl_id));
+                if (persistent)
+                    m_trail_stack.push(mk_tree_trail(*this, lbl_id, qa, mp, first_idx));
+                else
+                    m_trail_stack.push(mk_tree_trail(*this, lbl_id, nullptr, nullptr, 0));
             }
             else {
                 code_tree * tree = m_trees[lbl_id];
@@ -2930,6 +3053,11 @@ namespace {
                     m_compiler.insert(tree, qa, mp, first_idx, false);
                 }
             }
+            ptr_vector<quantifier> & qs = m_trees[lbl_id]->get_quantifiers();
+            if (qs.empty() || qs.back() != qa) {
+                qs.push_back(qa);
+                m_trail_stack.push(push_back_vector<ptr_vector<quantifier>>(qs));
+            }
             DEBUG_CODE(m_trees[lbl_id]->get_patterns().push_back(mp);
                        m_trail_stack.push(push_back_trail<app*, false>(m_trees[lbl_id]->get_patterns())););
             TRACE("trigger_bug", tout << "after add_pattern, first_idx: " << first_idx << "\n"; m_trees[lbl_id]->display(tout););
@@ -2938,6 +3066,9 @@ namespace {
         void reset() {
             std::for_each(m_trees.begin(), m_trees.end(), delete_proc<code_tree>());
             m_trees.reset();
+            reset_cache();
+            m_ct_manager.reset_persistent();
+            m_num_persistent = 0;
         }
 
         code_tree * get_code_tree_for(func_decl * lbl) const {
@@ -3759,18 +3890,32 @@ namespace {
                     else {
                         m_compiler.insert(m_tmp_trees[lbl_id], qa, mp, 0, true);
                     }
+                    ptr_vector<quantifier> & qs = m_tmp_trees[lbl_id]->get_quantifiers();
+                    if (qs.empty() || qs.back() != qa)
+                        qs.push_back(qa);
                 }
             }
 
+            bool profile = m_context.get_fparams().m_qi_profile;
             for (func_decl * lbl : m_tmp_trees_to_delete) {
                 unsigned    lbl_id   = lbl->get_small_id();
                 code_tree * tmp_tree = m_tmp_trees[lbl_id];
                 SASSERT(tmp_tree != 0);
                 SASSERT(m_context.get_num_enodes_of(lbl) > 0);
+                stopwatch watch;
+                if (profile)
+                    watch.start();
+                unsigned num_attempts = 0;
                 m_interpreter.init(tmp_tree);
                 for (enode * app : m_context.enodes_of(lbl)) {
-                    if (m_context.is_relevant(app))
+                    if (m_context.is_relevant(app)) {
                         m_interpreter.execute_core(tmp_tree, app);
+                        num_attempts++;
+                    }
+                }
+                if (profile) {
+                    watch.stop();
+                    update_profile(tmp_tree, num_attempts, watch);
                 }
                 m_tmp_trees[lbl_id] = 0;
                 dealloc(tmp_tree);
@@ -3815,7 +3960,7 @@ namespace {
             m_ct_manager(m_lbl_hasher, m_trail_stack),
             m_compiler(ctx, m_ct_manager, m_lbl_hasher, use_filters),
             m_interpreter(ctx, *this, use_filters),
-            m_trees(m, m_compiler, m_trail_stack),
+            m_trees(m, m_compiler, m_ct_manager, m_trail_stack),
             m_region(m_trail_stack.get_region()),
             m_r1(nullptr),
             m_r2(nullptr) {
@@ -3877,8 +4022,13 @@ namespace {
             m_tmp_region.reset();
         }
 
+        void collect_statistics(::statistics & st) const override {
+            st.update("mam reused code trees", m_trees.num_reused());
+        }
+
         void display(std::ostream& out) override {
             out << "mam:\n";
+            out << "reused code trees: " << m_trees.num_reused() << "\n";
             m_lbl_hasher.display(out);
             ptr_vector<code_tree>::iterator it = m_trees.begin_code_trees();
             ptr_vector<code_tree>::iterator end = m_trees.end_code_trees();
@@ -3888,11 +4038,30 @@ namespace {
             }
         }
 
+        /**
+           \brief Charge the candidates and time spent in t to the quantifiers with patterns in t.
+        */
+        void update_profile(code_tree * t, unsigned num_attempts, stopwatch const & watch) {
+            double secs = watch.get_seconds();
+            for (quantifier * q : t->get_quantifiers())
+                m_context.get_quantifier_stat(q)->update_match_profile(num_attempts, secs);
+        }
+
         void match() override {
             TRACE("trigger_bug", tout << "match\n"; display(tout););
+            bool profile = m_context.get_fparams().m_qi_profile;
             for (code_tree* t : m_to_match) {
                 SASSERT(t->has_candidates());
-                if (!m_interpreter.execute(t))
+                if (profile) {
+                    stopwatch watch;
+                    watch.start();
+                    bool ok = m_interpreter.execute(t);
+                    watch.stop();
+                    update_profile(t, t->get_candidates().size(), watch);
+                    if (!ok)
+                        return;
+                }
+                else if (!m_interpreter.execute(t))
                     return;
                 t->reset_candidates();
             }
@@ -3910,11 +4079,22 @@ namespace {
             for (; it != end; ++it, ++lbl) {
                 code_tree * t = *it;
                 if (t) {
+                    stopwatch watch;
+                    bool profile = m_context.get_fparams().m_qi_profile;
+                    if (profile)
+                        watch.start();
+                    unsigned num_attempts = 0;
                     m_interpreter.init(t);
                     func_decl * lbl = t->get_root_lbl();
                     for (enode * curr : m_context.enodes_of(lbl)) {
-                        if (use_irrelevant || m_context.is_relevant(curr))
+                        if (use_irrelevant || m_context.is_relevant(curr)) {
                             m_interpreter.execute_core(t, curr);
+                            num_attempts++;
+                        }
+                    }
+                    if (profile) {
+                        watch.stop();
+                        update_profile(t, num_attempts, watch);
                     }
                 }
             }
@@ -3947,6 +4127,8 @@ namespace {
                 SASSERT(bindings[i]->get_generation() <= max_generation);
             }
 #endif
+            if (m_context.get_fparams().m_qi_profile)
+                m_context.get_quantifier_stat(qa)->inc_num_matches();
             unsigned min_gen = 0, max_gen = 0;
             m_interpreter.get_min_max_top_generation(min_gen, max_gen);
             m_context.add_instance(qa, pat, num_bindings, bindings, nullptr, max_generation, min_gen, max_gen, used_enodes);
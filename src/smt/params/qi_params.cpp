@@ -28,6 +28,8 @@ void qi_params::updt_params(params_ref const & _p) {
     m_mbqi_trace = p.mbqi_trace();
     m_mbqi_force_template = p.mbqi_force_template();
     m_mbqi_id = p.mbqi_id();
+    m_mbqi_threads = p.mbqi_threads();
+    m_mbqi_max_round_instances = p.mbqi_max_round_instances();
     m_qe_lite = p.q_lite();
     m_qi_profile = p.qi_profile();
     m_qi_profile_freq = p.qi_profile_freq();
@@ -63,4 +65,6 @@ void qi_params::display(std::ostream & out) const {
     DISPLAY_PARAM(m_mbqi_trace);
     DISPLAY_PARAM(m_mbqi_force_template);
     DISPLAY_PARAM(m_mbqi_id);
+    DISPLAY_PARAM(m_mbqi_threads);
+    DISPLAY_PARAM(m_mbqi_max_round_instances);
 }
@@ -51,6 +51,8 @@ struct qi_params {
     bool               m_mbqi_trace = false;
     unsigned           m_mbqi_force_template = 10;
     const char *       m_mbqi_id = nullptr;
+    unsigned           m_mbqi_threads = 1;
+    unsigned           m_mbqi_max_round_instances = UINT_MAX;
 
     qi_params(params_ref const & p = params_ref()):
         /*
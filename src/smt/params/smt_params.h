@@ -106,6 +106,8 @@ struct smt_params : public preprocessor_params,
     unsigned         m_threads = 1;
     unsigned         m_threads_max_conflicts = UINT_MAX;
     unsigned         m_threads_cube_frequency = 2;
+    unsigned         m_threads_share_glue = 4;
+    unsigned         m_threads_share_size = 16;
     bool             m_simplify_clauses = true;
     unsigned         m_tick = 1000;
     bool             m_display_features = false;
@@ -36,7 +36,8 @@ namespace smt {
         m_cost_function(m),
         m_new_gen_function(m),
         m_parser(m),
-        m_evaluator(m),
+        m_cost(m),
+        m_new_gen(m),
         m_subst(m),
         m_instances(m) {
         init_parser_vars();
@@ -63,6 +64,8 @@ namespace smt {
             warning_msg("invalid new_gen function '%s', switching to default one", m_params.m_qi_new_gen.c_str());
             VERIFY(m_parser.parse_string("cost", m_new_gen_function));
         }
+        m_cost.compile(m_cost_function);
+        m_new_gen.compile(m_new_gen_function);
         m_eager_cost_threshold = m_params.m_qi_eager_threshold;
     }
 
@@ -122,7 +125,7 @@ namespace smt {
 
     float qi_queue::get_cost(quantifier * q, app * pat, unsigned generation, unsigned min_top_generation, unsigned max_top_generation) {
         q::quantifier_stat * stat = set_values(q, pat, generation, min_top_generation, max_top_generation, 0);
-        float r = m_evaluator(m_cost_function, m_vals.size(), m_vals.data());
+        float r = m_cost(m_vals.size(), m_vals.data());
         stat->update_max_cost(r);
         return r;
     }
@@ -130,7 +133,7 @@ namespace smt {
     unsigned qi_queue::get_new_gen(quantifier * q, unsigned generation, float cost) {
         // max_top_generation and min_top_generation are not available for computing inc_gen
         set_values(q, nullptr, generation, 0, 0, cost);
-        float r = m_evaluator(m_new_gen_function, m_vals.size(), m_vals.data());
+        float r = m_new_gen(m_vals.size(), m_vals.data());
         if (q->get_weight() > 0 || r > 0)
             return static_cast<unsigned>(r);
         return std::max(generation + 1, static_cast<unsigned>(r));
@@ -150,8 +153,51 @@ namespace smt {
         m_new_entries.push_back(entry(f, cost, generation));
     }
 
+    /**
+       \brief stable bucket sort of es by the integral part of the cost or by generation.
+       Values above the last bucket share the last bucket.
+    */
+    void qi_queue::sort_entries_by_bucket(bool by_cost, svector<entry> & es, svector<entry> & tmp, unsigned_vector & offsets) {
+        const unsigned num_buckets = 64;
+        auto bucket = [&](entry const& e) {
+            if (!by_cost)
+                return std::min(static_cast<unsigned>(e.m_generation), num_buckets - 1);
+            if (!(e.m_cost > 0.0f))
+                return 0u;
+            if (e.m_cost >= static_cast<float>(num_buckets - 1))
+                return num_buckets - 1;
+            return static_cast<unsigned>(e.m_cost);
+        };
+        offsets.reset();
+        offsets.resize(num_buckets + 1, 0);
+        for (entry const& e : es)
+            offsets[bucket(e) + 1]++;
+        for (unsigned i = 0; i < num_buckets; ++i)
+            offsets[i + 1] += offsets[i];
+        if (offsets[1] == es.size())
+            return;
+        tmp.reset();
+        tmp.resize(es.size(), entry(nullptr, 0.0f, 0));
+        for (entry const& e : es)
+            tmp[offsets[bucket(e)]++] = e;
+        es.swap(tmp);
+    }
+
+    /**
+       \brief order entries by cost and then by generation, such that cheap instances
+       are created first when the round is interrupted by resource limits.
+    */
+    void qi_queue::sort_entries(svector<entry> & es, svector<entry> & tmp, unsigned_vector & offsets) {
+        if (es.size() <= 1)
+            return;
+        sort_entries_by_bucket(false, es, tmp, offsets);
+        sort_entries_by_bucket(true, es, tmp, offsets);
+    }
+
     void qi_queue::instantiate() {
         unsigned since_last_check = 0;
+        sort_entries(m_new_entries, m_sorted_entries, m_bucket_offsets);
+        m_round_lemmas.reset();
         for (entry & curr : m_new_entries) {
             if (m_context.get_cancel_flag()) {
                 break;
@@ -181,6 +227,7 @@ namespace smt {
             }
         }
         m_new_entries.reset();
+        m_round_lemmas.reset();
         TRACE("new_entries_bug", tout << "[qi:instantiate]\n";);
     }
 
@@ -258,10 +305,6 @@ namespace smt {
 #endif
    
         TRACE("qi_queue", tout << "simplified instance:\n" << s_instance << "\n";);
-        stat->inc_num_instances();
-        if (stat->get_num_instances() % m_params.m_qi_profile_freq == 0) {
-            m_qm.display_stats(verbose_stream(), q);
-        }
         expr_ref lemma(m);
         if (m.is_or(s_instance)) {
             ptr_vector<expr> args;
@@ -278,6 +321,25 @@ namespace smt {
         else {
             lemma = m.mk_or(m.mk_not(q), s_instance);
         }
+        if (m_round_lemmas.contains(lemma)) {
+            // different bindings produced the same simplified instance in this round.
+            TRACE("qi_queue", tout << "duplicate instance:\n" << lemma << "\n";);
+            m_stats.m_num_duplicate_instances++;
+            if (m.has_trace_stream()) {
+                display_instance_profile(f, q, num_bindings, bindings, pr ? pr->get_id() : 0, generation);
+                m.trace_stream() << "[end-of-instance]\n";
+            }
+            // the lemma is asserted already, but the definition of the
+            // fingerprint is not: f will not be instantiated again.
+            if (f->get_def())
+                m_context.internalize(f->get_def(), true);
+            return;
+        }
+        m_round_lemmas.insert(lemma);
+        stat->inc_num_instances();
+        if (stat->get_num_instances() % m_params.m_qi_profile_freq == 0) {
+            m_qm.display_stats(verbose_stream(), q);
+        }
         m_instances.push_back(lemma);
         proof_ref pr1(m);
         unsigned proof_id = 0;
@@ -379,12 +441,14 @@ namespace smt {
         m_delayed_entries.shrink(s.m_delayed_entries_lim);
         m_instances.shrink(s.m_instances_lim);
         m_new_entries.reset();
+        m_round_lemmas.reset();
         m_scopes.shrink(new_lvl);
         TRACE("new_entries_bug", tout << "[qi:pop-scope]\n";);
     }
 
     void qi_queue::reset() {
         m_new_entries.reset();
+        m_round_lemmas.reset();
         m_delayed_entries.reset();
         m_instances.reset();
         m_scopes.reset();
@@ -502,6 +566,7 @@ namespace smt {
     void qi_queue::collect_statistics(::statistics & st) const {
         st.update("quant instantiations", m_stats.m_num_instances);
         st.update("lazy quant instantiations", m_stats.m_num_lazy_instances);
+        st.update("duplicate quant instantiations", m_stats.m_num_duplicate_instances);
         st.update("missed quant instantiations", m_delayed_entries.size());
         float min, max;
         get_min_max_costs(min, max);
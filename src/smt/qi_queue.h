@@ -33,12 +33,21 @@ namespace smt {
     class context;
 
     struct qi_queue_stats {
-        unsigned m_num_instances, m_num_lazy_instances;
+        unsigned m_num_instances, m_num_lazy_instances, m_num_duplicate_instances;
         void reset() { memset(this, 0, sizeof(qi_queue_stats)); }
         qi_queue_stats() { reset(); }
     };
 
     class qi_queue {
+    public:
+        struct entry {
+            fingerprint * m_qb;
+            float         m_cost;
+            unsigned      m_generation:31;
+            unsigned      m_instantiated:1;
+            entry(fingerprint * f, float c, unsigned g):m_qb(f), m_cost(c), m_generation(g), m_instantiated(false) {}
+        };
+    private:
         quantifier_manager &          m_qm;
         context &                     m_context;
         ast_manager &                 m;
@@ -48,20 +57,17 @@ namespace smt {
         expr_ref                      m_cost_function;
         expr_ref                      m_new_gen_function;
         cost_parser                   m_parser;
-        cost_evaluator                m_evaluator;
+        compiled_cost                 m_cost;
+        compiled_cost                 m_new_gen;
         cached_var_subst              m_subst;
         svector<float>                m_vals;
         double                        m_eager_cost_threshold;
-        struct entry {
-            fingerprint * m_qb;
-            float         m_cost;
-            unsigned      m_generation:31;
-            unsigned      m_instantiated:1;
-            entry(fingerprint * f, float c, unsigned g):m_qb(f), m_cost(c), m_generation(g), m_instantiated(false) {}
-        };
         svector<entry>                m_new_entries;
         svector<entry>                m_delayed_entries;
+        svector<entry>                m_sorted_entries;  // buffer used to sort m_new_entries
+        unsigned_vector               m_bucket_offsets;
         expr_ref_vector               m_instances;
+        obj_hashtable<expr>           m_round_lemmas;    // lemmas created since the start of the last round, cleared on pop
         unsigned_vector               m_instantiated_trail;
         struct scope {
             unsigned   m_delayed_entries_lim;
@@ -75,6 +81,7 @@ namespace smt {
         float get_cost(quantifier * q, app * pat, unsigned generation, unsigned min_top_generation, unsigned max_top_generation);
         unsigned get_new_gen(quantifier * q, unsigned generation, float cost);
         void instantiate(entry & ent);
+        static void sort_entries_by_bucket(bool by_cost, svector<entry> & es, svector<entry> & tmp, unsigned_vector & offsets);
         void get_min_max_costs(float & min, float & max) const;
         void display_instance_profile(fingerprint * f, quantifier * q, unsigned num_bindings, enode * const * bindings, unsigned proof_id, unsigned generation);
 
@@ -88,6 +95,11 @@ namespace smt {
         */
         void insert(fingerprint * f, app * pat, unsigned generation, unsigned min_top_generation, unsigned max_top_generation);
         void instantiate();
+        /**
+           \brief order entries by the integral part of their cost and then by generation.
+           tmp and offsets are buffers.
+        */
+        static void sort_entries(svector<entry> & es, svector<entry> & tmp, unsigned_vector & offsets);
         bool has_work() const { return !m_new_entries.empty(); }
         void init_search_eh();
         bool final_check_eh();
@@ -63,6 +63,95 @@ namespace smt {
         return true;
     }
 
+    cg_table::flat_table::entry cg_table::flat_table::mk_entry(enode * n, bool unary, bool comm) {
+        SASSERT(n->get_func_decl_id() != UINT_MAX);
+        entry e;
+        e.m_enode = n;
+        e.m_decl  = n->get_func_decl_id();
+        e.m_arg1  = n->get_arg(0)->get_root()->get_owner_id();
+        e.m_arg2  = unary ? 0 : n->get_arg(1)->get_root()->get_owner_id();
+        unsigned a = e.m_decl, b = e.m_arg1, c = e.m_arg2;
+        if (comm && b > c)
+            std::swap(b, c);
+        mix(a, b, c);
+        e.m_hash = c;
+        return e;
+    }
+
+    cg_table::flat_table::entry const * cg_table::flat_table::find(entry const & e, bool comm, bool & commutativity) const {
+        unsigned mask = m_entries.size() - 1;
+        for (unsigned idx = e.m_hash & mask; ; idx = (idx + 1) & mask) {
+            entry const & curr = m_entries[idx];
+            if (!curr.m_enode)
+                return nullptr;
+            if (curr.m_enode == deleted() || curr.m_hash != e.m_hash || curr.m_decl != e.m_decl)
+                continue;
+            if (curr.m_arg1 == e.m_arg1 && curr.m_arg2 == e.m_arg2) {
+                commutativity = false;
+                return &curr;
+            }
+            if (comm && curr.m_arg1 == e.m_arg2 && curr.m_arg2 == e.m_arg1) {
+                commutativity = true;
+                return &curr;
+            }
+        }
+    }
+
+    cg_table::flat_table::entry const * cg_table::flat_table::insert_if_not_there(entry const & e, bool comm, bool & commutativity) {
+        entry const * r = find(e, comm, commutativity);
+        if (r)
+            return r;
+        if ((m_size + m_num_deleted + 1) * 4 > m_entries.size() * 3) {
+            unsigned new_capacity = m_entries.size();
+            while ((m_size + 1) * 2 > new_capacity)
+                new_capacity *= 2;
+            rehash(new_capacity);
+        }
+        unsigned mask = m_entries.size() - 1;
+        unsigned idx = e.m_hash & mask;
+        while (m_entries[idx].m_enode && m_entries[idx].m_enode != deleted())
+            idx = (idx + 1) & mask;
+        if (m_entries[idx].m_enode == deleted())
+            --m_num_deleted;
+        m_entries[idx] = e;
+        ++m_size;
+        commutativity = false;
+        return &m_entries[idx];
+    }
+
+    void cg_table::flat_table::erase(entry const & e, bool comm) {
+        bool commutativity = false;
+        entry const * r = find(e, comm, commutativity);
+        if (!r)
+            return;
+        const_cast<entry*>(r)->m_enode = deleted();
+        --m_size;
+        ++m_num_deleted;
+    }
+
+    void cg_table::flat_table::rehash(unsigned new_capacity) {
+        SASSERT((new_capacity & (new_capacity - 1)) == 0);
+        svector<entry> old_entries;
+        old_entries.swap(m_entries);
+        m_entries.resize(new_capacity, entry({ nullptr, 0, 0, 0, 0 }));
+        unsigned mask = new_capacity - 1;
+        for (entry const & e : old_entries) {
+            if (!e.m_enode || e.m_enode == deleted())
+                continue;
+            unsigned idx = e.m_hash & mask;
+            while (m_entries[idx].m_enode)
+                idx = (idx + 1) & mask;
+            m_entries[idx] = e;
+        }
+        m_num_deleted = 0;
+    }
+
+    void cg_table::flat_table::reset() {
+        m_entries.reset();
+        m_size = 0;
+        rehash(64);
+    }
+
     cg_table::cg_table(ast_manager & m):
         m_manager(m) {
     }
@@ -76,9 +165,7 @@ namespace smt {
         SASSERT(d->get_arity() >= 1);
         switch (d->get_arity()) {
         case 1:
-            r = TAG(void*, alloc(unary_table), UNARY);
-            SASSERT(GET_TAG(r) == UNARY);
-            return r;
+            return TAG(void*, nullptr, UNARY);
         case 2:
             if (d->is_flat_associative()) {
                 // applications of declarations that are flat-assoc (e.g., +) may have many arguments.
@@ -87,14 +174,10 @@ namespace smt {
                 return r;
             }
             else if (d->is_commutative()) {
-                r = TAG(void*, alloc(comm_table, cg_comm_hash(), cg_comm_eq(m_commutativity)), BINARY_COMM);
-                SASSERT(GET_TAG(r) == BINARY_COMM);
-                return r;
+                return TAG(void*, nullptr, BINARY_COMM);
             }
             else {
-                r = TAG(void*, alloc(binary_table), BINARY);
-                SASSERT(GET_TAG(r) == BINARY);
-                return r;
+                return TAG(void*, nullptr, BINARY);
             }
         default: 
             r = TAG(void*, alloc(table), NARY);
@@ -124,22 +207,11 @@ namespace smt {
     
     void cg_table::reset() {
         for (void* t : m_tables) {
-            switch (GET_TAG(t)) {
-            case UNARY:
-                dealloc(UNTAG(unary_table*, t));
-                break;
-            case BINARY:
-                dealloc(UNTAG(binary_table*, t));
-                break;
-            case BINARY_COMM:
-                dealloc(UNTAG(comm_table*, t));
-                break;
-            case NARY:
+            if (GET_TAG(t) == NARY)
                 dealloc(UNTAG(table*, t));
-                break;
-            }
         }
         m_tables.reset();
+        m_flat.reset();
         for (auto const& kv : m_func_decl2id) {
             m_manager.dec_ref(kv.m_key);
         }
@@ -150,46 +222,18 @@ namespace smt {
         for (auto const& kv : m_func_decl2id) {
             void * t = m_tables[kv.m_value];
             out << mk_pp(kv.m_key, m_manager) << ": ";
-            switch (GET_TAG(t)) {
-            case UNARY: 
-                display_unary(out, t);
-                break;            
-            case BINARY: 
-                display_binary(out, t);
-                break;
-            case BINARY_COMM: 
-                display_binary_comm(out, t);
-                break;            
-            case NARY: 
+            if (GET_TAG(t) == NARY)
                 display_nary(out, t);
-                break;
-            }
+            else
+                display_flat(out, kv.m_value);
         }        
     }
 
-    void cg_table::display_binary(std::ostream& out, void* t) const {
-        binary_table* tb = UNTAG(binary_table*, t);
-        out << "b ";
-        for (enode* n : *tb) {
-            out << n->get_owner_id() << " " << cg_binary_hash()(n) << " ";
-        }
-        out << "\n";
-    }
-    
-    void cg_table::display_binary_comm(std::ostream& out, void* t) const {
-        comm_table* tb = UNTAG(comm_table*, t);
-        out << "bc ";
-        for (enode* n : *tb) {
-            out << n->get_owner_id() << " ";
-        }
-        out << "\n";
-    }
-    
-    void cg_table::display_unary(std::ostream& out, void* t) const {
-        unary_table* tb = UNTAG(unary_table*, t);
-        out << "un ";
-        for (enode* n : *tb) {
-            out << n->get_owner_id() << " ";
+    void cg_table::display_flat(std::ostream& out, unsigned tid) const {
+        out << "flat ";
+        for (flat_table::entry const& e : m_flat.entries()) {
+            if (e.m_enode && e.m_decl == tid && e.m_enode != flat_table::deleted())
+                out << e.m_enode->get_owner_id() << " ";
         }
         out << "\n";
     }
@@ -211,42 +255,27 @@ namespace smt {
         SASSERT(!m_manager.is_or(n->get_expr()));
         enode * n_prime;
         void * t = get_table(n); 
-        switch (static_cast<table_kind>(GET_TAG(t))) {
-        case UNARY:
-            n_prime = UNTAG(unary_table*, t)->insert_if_not_there(n);
-            return enode_bool_pair(n_prime, false);
-        case BINARY:
-            n_prime = UNTAG(binary_table*, t)->insert_if_not_there(n);
-            TRACE("cg_table", tout << "insert: " << n->get_owner_id() << " " << cg_binary_hash()(n) << " inserted: " << (n == n_prime) << " " << n_prime->get_owner_id() << "\n";
-                  display_binary(tout, t); tout << "contains_ptr: " << contains_ptr(n) << "\n";); 
-            return enode_bool_pair(n_prime, false);
-        case BINARY_COMM:
-            m_commutativity = false;
-            n_prime = UNTAG(comm_table*, t)->insert_if_not_there(n);
-            return enode_bool_pair(n_prime, m_commutativity);
-        default:
+        table_kind k = static_cast<table_kind>(GET_TAG(t));
+        if (k == NARY) {
             n_prime = UNTAG(table*, t)->insert_if_not_there(n);
             return enode_bool_pair(n_prime, false);
         }
+        bool comm = k == BINARY_COMM;
+        m_commutativity = false;
+        n_prime = m_flat.insert_if_not_there(flat_table::mk_entry(n, k == UNARY, comm), comm, m_commutativity)->m_enode;
+        TRACE("cg_table", tout << "insert: " << n->get_owner_id() << " inserted: " << (n == n_prime) << " " << n_prime->get_owner_id() << "\n";);
+        return enode_bool_pair(n_prime, m_commutativity);
     }
 
     void cg_table::erase(enode * n) {
         SASSERT(n->get_num_args() > 0);
         void * t = get_table(n); 
-        switch (static_cast<table_kind>(GET_TAG(t))) {
-        case UNARY:
-            UNTAG(unary_table*, t)->erase(n);
-            break;
-        case BINARY:
-            TRACE("cg_table", tout << "erase: " << n->get_owner_id() << " " << cg_binary_hash()(n) << " contains: " << contains_ptr(n) << "\n";);
-            UNTAG(binary_table*, t)->erase(n);
-            break;
-        case BINARY_COMM:
-            UNTAG(comm_table*, t)->erase(n);
-            break;
-        default:
+        table_kind k = static_cast<table_kind>(GET_TAG(t));
+        if (k == NARY) 
             UNTAG(table*, t)->erase(n);
-            break;
+        else {
+            TRACE("cg_table", tout << "erase: " << n->get_owner_id() << " contains: " << contains_ptr(n) << "\n";);
+            m_flat.erase(flat_table::mk_entry(n, k == UNARY, k == BINARY_COMM), k == BINARY_COMM);
         }
     }
 
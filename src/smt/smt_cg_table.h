@@ -32,79 +32,46 @@ namespace smt {
        \brief Congruence table.
     */
     class cg_table {
-        struct cg_unary_hash {
-            unsigned operator()(enode * n) const {
-                SASSERT(n->get_num_args() == 1);
-                return n->get_arg(0)->get_root()->hash();
-            }
-        };
-
-        struct cg_unary_eq {
-            bool operator()(enode * n1, enode * n2) const {
-                SASSERT(n1->get_num_args() == 1);
-                SASSERT(n2->get_num_args() == 1);
-                SASSERT(n1->get_decl() == n2->get_decl());
-                return n1->get_arg(0)->get_root() == n2->get_arg(0)->get_root();
-            }
-        };
-
-        typedef chashtable<enode *, cg_unary_hash, cg_unary_eq> unary_table;
-        
-        struct cg_binary_hash {
-            unsigned operator()(enode * n) const {
-                SASSERT(n->get_num_args() == 2);
-                return combine_hash(n->get_arg(0)->get_root()->hash(), n->get_arg(1)->get_root()->hash());
-            }
-        };
 
-        struct cg_binary_eq {
-            bool operator()(enode * n1, enode * n2) const {
-                SASSERT(n1->get_num_args() == 2);
-                SASSERT(n2->get_num_args() == 2);
-                SASSERT(n1->get_decl() == n2->get_decl());
-                return 
-                    n1->get_arg(0)->get_root() == n2->get_arg(0)->get_root() &&
-                    n1->get_arg(1)->get_root() == n2->get_arg(1)->get_root();
-            }
-        };
-
-        typedef chashtable<enode*, cg_binary_hash, cg_binary_eq> binary_table;
-        
-        struct cg_comm_hash {
-            unsigned operator()(enode * n) const {
-                SASSERT(n->get_num_args() == 2);
-                unsigned h1 = n->get_arg(0)->get_root()->hash();
-                unsigned h2 = n->get_arg(1)->get_root()->hash();
-                if (h1 > h2)
-                    std::swap(h1, h2);
-                return hash_u((h1 << 16) | (h2 & 0xFFFF));
-            }
-        };
-        
-        struct cg_comm_eq {
-            bool & m_commutativity;
-            cg_comm_eq(bool & c):m_commutativity(c) {}
-            bool operator()(enode * n1, enode * n2) const {
-                SASSERT(n1->get_num_args() == 2);
-                SASSERT(n2->get_num_args() == 2);
-                SASSERT(n1->get_decl() == n2->get_decl());
-                enode * c1_1 = n1->get_arg(0)->get_root();
-                enode * c1_2 = n1->get_arg(1)->get_root();
-                enode * c2_1 = n2->get_arg(0)->get_root();
-                enode * c2_2 = n2->get_arg(1)->get_root();
-                if (c1_1 == c2_1 && c1_2 == c2_2) {
-                    return true;
-                }
-                if (c1_1 == c2_2 && c1_2 == c2_1) {
-                    m_commutativity = true;
-                    return true;
-                }
-                return false;
-            }
+        /**
+           \brief Open addressing table for applications with one or two arguments.
+           Entries store the owner ids of the argument roots when the
+           application is inserted, so hashing and comparing entries does not
+           access enodes. The ids remain valid while the entry is in the table
+           because the parents of an enode are erased from the congruence table
+           before its root changes, and inserted again afterwards.
+        */
+        class flat_table {
+        public:
+            struct entry {
+                enode *  m_enode;
+                unsigned m_hash;
+                unsigned m_decl;   // func_decl id assigned by cg_table
+                unsigned m_arg1;   // owner id of the root of the first argument
+                unsigned m_arg2;   // owner id of the root of the second argument, 0 for unary applications
+            };
+        private:
+            svector<entry> m_entries;
+            unsigned       m_size = 0;
+            unsigned       m_num_deleted = 0;
+
+            void rehash(unsigned new_capacity);
+        public:
+            flat_table() { rehash(64); }
+            static enode * deleted() { return reinterpret_cast<enode*>(1); }
+            static entry mk_entry(enode * n, bool unary, bool comm);
+            /**
+               \brief return the entry congruent to e, if any, and whether it
+               is congruent only modulo commutativity.
+            */
+            entry const * find(entry const & e, bool comm, bool & commutativity) const;
+            entry const * insert_if_not_there(entry const & e, bool comm, bool & commutativity);
+            void erase(entry const & e, bool comm);
+            void reset();
+            unsigned size() const { return m_size; }
+            svector<entry> const & entries() const { return m_entries; }
         };
 
-        typedef chashtable<enode*, cg_comm_hash, cg_comm_eq> comm_table;
-
         struct cg_hash {
             unsigned operator()(enode * n) const;
         };
@@ -117,7 +84,8 @@ namespace smt {
 
         ast_manager &                 m_manager;
         bool                          m_commutativity; //!< true if the last found congruence used commutativity
-        ptr_vector<void>              m_tables;
+        ptr_vector<void>              m_tables;        //!< tagged with the table kind, only NARY tables are allocated.
+        flat_table                    m_flat;          //!< applications of UNARY, BINARY and BINARY_COMM declarations.
         obj_map<func_decl, unsigned>  m_func_decl2id;
 
         enum table_kind {
@@ -153,61 +121,31 @@ namespace smt {
         void erase(enode * n);
 
         bool contains(enode * n) const {
-            SASSERT(n->get_num_args() > 0);
-            void * t = const_cast<cg_table*>(this)->get_table(n); 
-            switch (static_cast<table_kind>(GET_TAG(t))) {
-            case UNARY:
-                return UNTAG(unary_table*, t)->contains(n);
-            case BINARY:
-                return UNTAG(binary_table*, t)->contains(n);
-            case BINARY_COMM:
-                return UNTAG(comm_table*, t)->contains(n);
-            default:
-                return UNTAG(table*, t)->contains(n);
-            }
+            return find(n) != nullptr;
         }
 
         enode * find(enode * n) const {
             SASSERT(n->get_num_args() > 0);
-            enode * r = nullptr;
             void * t = const_cast<cg_table*>(this)->get_table(n); 
-            switch (static_cast<table_kind>(GET_TAG(t))) {
-            case UNARY:
-                return UNTAG(unary_table*, t)->find(n, r) ? r : nullptr;
-            case BINARY:
-                return UNTAG(binary_table*, t)->find(n, r) ? r : nullptr;
-            case BINARY_COMM:
-                return UNTAG(comm_table*, t)->find(n, r) ? r : nullptr;
-            default:
+            table_kind k = static_cast<table_kind>(GET_TAG(t));
+            if (k == NARY) {
+                enode * r = nullptr;
                 return UNTAG(table*, t)->find(n, r) ? r : nullptr;
             }
+            bool comm = false;
+            flat_table::entry const * e = m_flat.find(flat_table::mk_entry(n, k == UNARY, k == BINARY_COMM), k == BINARY_COMM, comm);
+            return e ? e->m_enode : nullptr;
         }
 
         bool contains_ptr(enode * n) const {
-            enode * r;
-            SASSERT(n->get_num_args() > 0);
-            void * t = const_cast<cg_table*>(this)->get_table(n); 
-            switch (static_cast<table_kind>(GET_TAG(t))) {
-            case UNARY:
-                return UNTAG(unary_table*, t)->find(n, r) && n == r;
-            case BINARY:
-                return UNTAG(binary_table*, t)->find(n, r) && n == r;
-            case BINARY_COMM:
-                return UNTAG(comm_table*, t)->find(n, r) && n == r;
-            default:
-                return UNTAG(table*, t)->find(n, r) && n == r;
-            }
+            return find(n) == n;
         }
 
         void reset();
 
         void display(std::ostream & out) const;
 
-        void display_binary(std::ostream& out, void* t) const;
-
-        void display_binary_comm(std::ostream& out, void* t) const;
-
-        void display_unary(std::ostream& out, void* t) const;
+        void display_flat(std::ostream& out, unsigned tid) const;
 
         void display_nary(std::ostream& out, void* t) const;
 
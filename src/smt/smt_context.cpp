@@ -1588,14 +1588,14 @@ namespace smt {
                 m_qmanager->relevant_eh(e);
             }
 
-            theory * propagated_th = nullptr;
+            // theories that do not implement relevant_eh are skipped.
+            theory_id propagated_th = null_theory_id;
             family_id fid = to_app(n)->get_family_id();
-            if (fid != m.get_basic_family_id()) {
+            if (fid != m.get_basic_family_id() && m_relevant_eh_theories.get(fid, false)) {
                 theory * th = get_theory(fid);
-                if (th != nullptr) {
-                    th->relevant_eh(to_app(n));
-                    propagated_th = th; // <<< mark that relevancy_eh was already invoked for theory th.
-                }
+                SASSERT(th);
+                th->relevant_eh(to_app(n));
+                propagated_th = fid; // <<< mark that relevancy_eh was already invoked for theory th.
             }
 
             if (e_internalized(n)) {
@@ -1603,10 +1603,9 @@ namespace smt {
                 theory_var_list * l = e->get_th_var_list();
                 while (l) {
                     theory_id  th_id = l->get_id();
-                    theory *   th    = get_theory(th_id);
                     // I don't want to invoke relevant_eh twice for the same n.
-                    if (th != propagated_th)
-                        th->relevant_eh(to_app(n));
+                    if (th_id != propagated_th && m_relevant_eh_theories.get(th_id, false))
+                        get_theory(th_id)->relevant_eh(to_app(n));
                     l = l->get_next();
                 }
             }
@@ -2889,6 +2888,7 @@ namespace smt {
         m_theories.register_plugin(th);
         th->init();
         m_theory_set.push_back(th);
+        m_relevant_eh_theories.setx(th->get_id(), th->has_relevant_eh(), false);
         {
 #ifdef Z3DEBUG
             // It is unsafe to invoke push_trail from the method push_scope_eh.
@@ -3837,6 +3837,8 @@ namespace smt {
             TRACE("mbqi_bug_detail", tout << "before instantiating quantifiers...\n";);
             if (!inconsistent()) 
                 m_qmanager->restart_eh();
+            if (m_par && !inconsistent())
+                m_par->import_clauses(*this);
             if (inconsistent()) {
                 VERIFY(!resolve_conflict());
                 status = l_false;
@@ -4181,6 +4183,7 @@ namespace smt {
             // I invoke pop_scope_core instead of pop_scope because I don't want
             // to reset cached generations... I need them to rebuild the literals
             // of the new conflict clause.
+            if (m_par) m_par->export_clause(*this, num_lits, lits);
             if (relevancy()) record_relevancy(num_lits, lits);
             unsigned num_bool_vars = pop_scope_core(m_scope_lvl - new_lvl);
             SASSERT(m_scope_lvl == new_lvl);
@@ -141,6 +141,7 @@ namespace smt {
         ptr_vector<enode>           m_enodes;
         plugin_manager<theory>      m_theories;     // mapping from theory_id -> theory
         ptr_vector<theory>          m_theory_set;   // set of theories for fast traversal
+        bool_vector                 m_relevant_eh_theories; // theory_id -> theory implements relevant_eh
         vector<enode_vector>        m_decl2enodes;  // decl -> enode (for decls with arity > 0)
         enode_vector                m_empty_vector;
         cg_table                    m_cg_table;
@@ -579,6 +580,10 @@ namespace smt {
             return m_qmanager->get_generation(q);
         }
 
+        q::quantifier_stat * get_quantifier_stat(quantifier * q) const {
+            return m_qmanager->get_stat(q);
+        }
+
         /**
            \brief Return true if the logical context internalized universal quantifiers.
         */
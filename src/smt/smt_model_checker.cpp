@@ -30,11 +30,16 @@ Revision History:
 #include "ast/array_decl_plugin.h"
 #include "ast/special_relations_decl_plugin.h"
 #include "ast/ast_smt2_pp.h"
+#include "ast/ast_translation.h"
+#include "ast/ast_util.h"
 #include "smt/smt_model_checker.h"
 #include "smt/smt_context.h"
 #include "smt/smt_model_finder.h"
 #include "model/model_pp.h"
 #include <tuple>
+#ifndef SINGLE_THREAD
+#include <thread>
+#endif
 
 namespace smt {
 
@@ -50,6 +55,7 @@ namespace smt {
         m_iteration_idx(0),
         m_curr_model(nullptr),
         m_fresh_exprs(m),
+        m_max_new_instances(UINT_MAX),
         m_pinned_exprs(m) {
     }
 
@@ -140,20 +146,19 @@ namespace smt {
     }
 
     /**
-       \brief Assert in m_aux_context, the constraint
+       \brief Return the constraint
 
          sk = e_1 OR ... OR sk = e_n
 
          where {e_1, ..., e_n} is the universe.
      */
-    void model_checker::restrict_to_universe(expr * sk, obj_hashtable<expr> const & universe) {
+    expr_ref model_checker::mk_universe_restriction(expr * sk, obj_hashtable<expr> const & universe) {
         SASSERT(!universe.empty());
         ptr_buffer<expr> eqs;
         for (expr * e : universe) {
             eqs.push_back(m.mk_eq(sk, e));
         }
-        expr_ref fml(m.mk_or(eqs.size(), eqs.data()), m);
-        m_aux_context->assert_expr(fml);
+        return expr_ref(m.mk_or(eqs.size(), eqs.data()), m);
     }
 
     /**
@@ -181,7 +186,7 @@ namespace smt {
             sks[num_decls - i - 1]        = sk;
             subst_args[num_decls - i - 1] = sk;
             if (m_curr_model->is_finite(s)) {
-                restrict_to_universe(sk, m_curr_model->get_known_universe(s));
+                m_aux_context->assert_expr(mk_universe_restriction(sk, m_curr_model->get_known_universe(s)));
             }
         }
 
@@ -194,6 +199,28 @@ namespace smt {
         return true;
     }
 
+    /**
+       \brief Store in fml the negation of q under m_curr_model as an existential formula.
+       The bound variables of finite sorts are restricted to their universe.
+       Unlike assert_neg_q_m, no skolem constants are created in m: they are
+       introduced by the context that checks fml.
+    */
+    bool model_checker::mk_exists_neg_q_m(quantifier * q, expr_ref & fml) {
+        expr_ref tmp(m);
+        if (!m_curr_model->eval(q->get_expr(), tmp, true))
+            return false;
+        unsigned num_decls = q->get_num_decls();
+        expr_ref_vector conjs(m);
+        for (unsigned i = 0; i < num_decls; i++) {
+            sort * s = q->get_decl_sort(i);
+            if (m_curr_model->is_finite(s))
+                conjs.push_back(mk_universe_restriction(m.mk_var(num_decls - i - 1, s), m_curr_model->get_known_universe(s)));
+        }
+        conjs.push_back(m.mk_not(tmp));
+        fml = m.mk_exists(num_decls, q->get_decl_sorts(), q->get_decl_names(), mk_and(conjs));
+        return true;
+    }
+
     bool model_checker::add_instance(quantifier * q, model * cex, expr_ref_vector & sks, bool use_inv) {
         if (cex == nullptr || sks.empty()) {
             TRACE("model_checker", tout << "no model is available\n";);
@@ -383,7 +410,7 @@ namespace smt {
                 break;
             }
             num_new_instances++;
-            if (num_new_instances >= m_max_cexs || !add_blocking_clause(cex.get(), sks)) {
+            if (num_new_instances >= m_max_cexs || m_new_instances.size() >= m_max_new_instances || !add_blocking_clause(cex.get(), sks)) {
                 TRACE("model_checker", tout << "Add blocking clause failed new-instances: " << num_new_instances << " max-cex: " << m_max_cexs << "\n";);
                 // add_blocking_clause failed... stop the search for new counter-examples...
                 break;
@@ -418,6 +445,155 @@ namespace smt {
         return !p.found;
     }
 
+    /**
+       \brief An auxiliary context that checks the negation of quantifiers
+       under the candidate model, in its own ast_manager.
+    */
+    struct model_checker::worker {
+        smt_params          m_params;
+        ast_manager         m;
+        scoped_ptr<context> m_ctx;
+        expr_ref_vector     m_fmls;    // negated quantifiers, translated from the main manager
+        unsigned_vector     m_jobs;    // m_jobs[i] is the position of the quantifier of m_fmls[i]
+        svector<lbool>      m_results;
+
+        worker(ast_manager & src, smt_params const & p):
+            m_params(p),
+            m(src, true),
+            m_fmls(m) {
+            m_params.m_array_fake_support = true;
+            // a worker checks formulas over different theories, install all of them.
+            m_params.m_auto_config = false;
+            m_params.m_mbqi_threads = 1;
+        }
+
+        void reset() {
+            m_fmls.reset();
+            m_jobs.reset();
+            m_results.reset();
+            if (!m_ctx) {
+                params_ref p;
+                p.set_bool("solver.axioms2files", false);
+                p.set_bool("solver.lemmas2console", false);
+                p.set_sym("solver.proof.log", symbol::null);
+                m_ctx = alloc(context, m, m_params, p);
+            }
+        }
+
+        void run() {
+            for (expr * fml : m_fmls) {
+                if (!m_ctx) {
+                    m_results.push_back(l_undef);
+                    continue;
+                }
+                try {
+                    m_ctx->push();
+                    m_ctx->assert_expr(fml);
+                    m_results.push_back(m_ctx->check());
+                    m_ctx->pop(1);
+                }
+                catch (z3_exception &) {
+                    // the context may be left at an inner scope, it is recreated on the next round.
+                    m_ctx = nullptr;
+                    m_results.push_back(l_undef);
+                }
+            }
+        }
+    };
+
+    /**
+       \brief Return true if the symbols of fml have the same meaning in
+       a manager that is a copy of m. Symbols with definitions that are
+       registered per manager, such as recursive functions and datatypes,
+       are excluded.
+    */
+    bool model_checker::is_worker_safe(expr * fml) {
+        family_id arith_fid = m.mk_family_id("arith");
+        family_id bv_fid = m.mk_family_id("bv");
+        family_id array_fid = m_autil.get_family_id();
+        ast_fast_mark1 visited;
+        struct proc {
+            family_id arith_fid, bv_fid, array_fid;
+            bool      safe = true;
+            proc(family_id a, family_id b, family_id c): arith_fid(a), bv_fid(b), array_fid(c) {}
+            void operator()(app * n) {
+                family_id fid = n->get_family_id();
+                safe &= fid == null_family_id || fid == basic_family_id || fid == model_value_family_id ||
+                    fid == arith_fid || fid == bv_fid || fid == array_fid;
+            }
+            void operator()(expr * e) {}
+        };
+        proc p(arith_fid, bv_fid, array_fid);
+        quick_for_each_expr(p, visited, fml);
+        return p.safe;
+    }
+
+    /**
+       \brief Check the negation of the quantifiers qs under m_curr_model concurrently.
+       result[i] is l_false if qs[i] is satisfied by m_curr_model, and l_true or l_undef
+       if qs[i] has to be checked by check(q), which also produces the instances.
+
+       Quantifiers are assigned to workers round robin and the instances are
+       produced sequentially in the order of qs, so the outcome does not depend
+       on the scheduling of the workers.
+    */
+    void model_checker::check_in_workers(ptr_vector<quantifier> const & qs, svector<lbool> & result) {
+        result.reset();
+        result.resize(qs.size(), l_undef);
+#ifndef SINGLE_THREAD
+        unsigned num_threads = std::min(m_params.m_mbqi_threads, qs.size());
+        // when most quantifiers failed in the previous round, the workers would
+        // mostly check quantifiers that check(q) checks again.
+        if (num_threads <= 1 || m_skip_workers || m.has_trace_stream())
+            return;
+        while (m_workers.size() < num_threads)
+            m_workers.push_back(alloc(worker, m, *m_fparams));
+
+        // translation updates reference counts of terms in m and happens on this thread.
+        scoped_ptr_vector<ast_translation> trs;
+        for (unsigned i = 0; i < num_threads; ++i) {
+            m_workers[i]->reset();
+            trs.push_back(alloc(ast_translation, m, m_workers[i]->m));
+        }
+        unsigned num_jobs = 0;
+        for (unsigned i = 0; i < qs.size(); ++i) {
+            expr_ref fml(m);
+            if (!mk_exists_neg_q_m(get_flat_quantifier(qs[i]), fml))
+                continue;
+            if (!is_worker_safe(fml))
+                continue;
+            worker & w = *m_workers[num_jobs % num_threads];
+            w.m_fmls.push_back((*trs[num_jobs % num_threads])(fml.get()));
+            w.m_jobs.push_back(i);
+            ++num_jobs;
+        }
+        trs.reset();
+        if (num_jobs <= 1)
+            return;
+        num_threads = std::min(num_threads, num_jobs);
+
+        {
+            scoped_limits sl(m.limit());
+            for (unsigned i = 0; i < num_threads; ++i)
+                sl.push_child(&m_workers[i]->m.limit());
+            vector<std::thread> threads;
+            for (unsigned i = 1; i < num_threads; ++i)
+                threads.push_back(std::thread([this, i]() { m_workers[i]->run(); }));
+            m_workers[0]->run();
+            for (auto & th : threads)
+                th.join();
+        }
+
+        for (unsigned i = 0; i < num_threads; ++i) {
+            worker & w = *m_workers[i];
+            for (unsigned j = 0; j < w.m_jobs.size(); ++j)
+                result[w.m_jobs[j]] = w.m_results[j];
+            w.m_fmls.reset();
+        }
+        IF_VERBOSE(10, verbose_stream() << "(smt.mbqi :threads " << num_threads << " :checked " << num_jobs
+                   << " :satisfied " << std::count(result.begin(), result.end(), l_false) << ")\n");
+#endif
+    }
 
     void model_checker::init_aux_context() {
         if (!m_fparams) {
@@ -474,6 +650,10 @@ namespace smt {
 
         init_aux_context();
 
+        // a budget of 0 is treated as 1, so that each round makes progress.
+        unsigned budget = std::max(1u, m_params.m_mbqi_max_round_instances);
+        m_max_new_instances = m_new_instances.size() + std::min(budget, UINT_MAX - m_new_instances.size());
+
         bool found_relevant = false;
         unsigned num_failures = 0;
 
@@ -515,30 +695,47 @@ namespace smt {
     //
 
     void model_checker::check_quantifiers(bool& found_relevant, unsigned& num_failures) {
+        ptr_vector<quantifier> qs;
         for (quantifier * q : *m_qm) {
-            if (!(m_qm->mbqi_enabled(q) &&
-                  m_context->is_relevant(q) &&
-                  m_context->get_assignment(q) == l_true &&
-                  (!m_context->get_fparams().m_ematching || !m.is_lambda_def(q)))) {
-                continue;
-            }
+            if (m_qm->mbqi_enabled(q) &&
+                m_context->is_relevant(q) &&
+                m_context->get_assignment(q) == l_true &&
+                (!m_context->get_fparams().m_ematching || !m.is_lambda_def(q)))
+                qs.push_back(q);
+        }
+
+        svector<lbool> results;
+        check_in_workers(qs, results);
+        unsigned num_round_failures = 0;
 
+        for (unsigned i = 0; i < qs.size(); ++i) {
+            quantifier * q = qs[i];
             TRACE("model_checker",
                   tout << "Check: " << mk_pp(q, m) << "\n";
-                  tout << m_context->get_assignment(q) << "\n";);
+                  tout << m_context->get_assignment(q) << " worker result: " << results[i] << "\n";);
 
             if (m_params.m_mbqi_trace && q->get_qid() != symbol::null) {
                 verbose_stream() << "(smt.mbqi :checking " << q->get_qid() << ")\n";
             }
             found_relevant = true;
-            if (!check(q)) {
+            bool ok;
+            if (results[i] == l_false && is_safe_for_mbqi(q))
+                ok = true;
+            else if (m_new_instances.size() >= m_max_new_instances)
+                // the instance budget of the round is exhausted, q is not checked.
+                ok = false;
+            else
+                ok = check(q);
+            if (!ok) {
                 if (m_params.m_mbqi_trace || get_verbosity_level() >= 5) {
                     IF_VERBOSE(0, verbose_stream() << "(smt.mbqi :failed " << q->get_qid() << ")\n");
                 }
                 TRACE("model_checker", tout << "checking quantifier " << mk_pp(q, m) << " failed\n";);
                 num_failures++;
+                num_round_failures++;
             }
         }
+        m_skip_workers = 2 * num_round_failures > qs.size();
     }
 
     void model_checker::init_search_eh() {
@@ -21,6 +21,7 @@ Revision History:
 #pragma once
 
 #include "util/obj_hashtable.h"
+#include "util/scoped_ptr_vector.h"
 #include "ast/ast.h"
 #include "ast/array_decl_plugin.h"
 #include "ast/normal_forms/defined_names.h"
@@ -53,6 +54,12 @@ namespace smt {
         proto_model *                               m_curr_model;
         obj_map<expr, expr *>                       m_value2expr;
         expr_ref_vector                             m_fresh_exprs;
+        unsigned                                    m_max_new_instances; // bound on m_new_instances in the current round
+
+        // auxiliary contexts, each with its own manager, used to check quantifiers concurrently.
+        struct worker;
+        scoped_ptr_vector<worker>                   m_workers;
+        bool                                        m_skip_workers = false; // most quantifiers failed in the last round
 
         friend class model_instantiation_set;
 
@@ -61,11 +68,14 @@ namespace smt {
         expr * get_term_from_ctx(expr * val);
         expr * get_type_compatible_term(expr * val);
         expr_ref replace_value_from_ctx(expr * e);
-        void restrict_to_universe(expr * sk, obj_hashtable<expr> const & universe);
+        expr_ref mk_universe_restriction(expr * sk, obj_hashtable<expr> const & universe);
+        bool mk_exists_neg_q_m(quantifier * q, expr_ref & fml);
         bool assert_neg_q_m(quantifier * q, expr_ref_vector & sks);
         bool add_blocking_clause(model * cex, expr_ref_vector & sks);
         bool check(quantifier * q);
         void check_quantifiers(bool& found_relevant, unsigned& num_failures);
+        bool is_worker_safe(expr * fml);
+        void check_in_workers(ptr_vector<quantifier> const & qs, svector<lbool> & result);
 
         struct instance {
             quantifier * m_q;
@@ -23,6 +23,123 @@ Author:
 #include "ast/ast_translation.h"
 #include "smt/smt_parallel.h"
 #include "smt/smt_lookahead.h"
+#include "ast/decl_collector.h"
+
+namespace smt {
+
+    /**
+       \brief An atom can be shared if all uninterpreted symbols in it occur in the
+       assertions of the worker. Fresh symbols introduced during search, such as
+       Skolem constants, have the same names in different workers but not the
+       same meaning.
+    */
+    bool parallel::is_shareable(worker& w, expr* atom) {
+        bool ok = true;
+        if (w.m_atom_ok.find(atom, ok))
+            return ok;
+        ptr_buffer<expr> todo;
+        expr_mark visited;
+        todo.push_back(atom);
+        while (ok && !todo.empty()) {
+            expr* e = todo.back();
+            todo.pop_back();
+            if (visited.is_marked(e))
+                continue;
+            visited.mark(e, true);
+            if (!is_app(e)) {
+                ok = false;
+                break;
+            }
+            app* a = to_app(e);
+            if (a->get_family_id() == null_family_id && !w.m_decls.contains(a->get_decl()))
+                ok = false;
+            for (expr* arg : *a)
+                todo.push_back(arg);
+        }
+        w.m_atoms.push_back(atom);
+        w.m_atom_ok.insert(atom, ok);
+        return ok;
+    }
+
+    void parallel::export_clause(context& pctx, unsigned num_lits, literal const* lits) {
+        if (num_lits > m_max_size)
+            return;
+        // glue: number of distinct decision levels in the clause
+        unsigned glue = 0;
+        for (unsigned i = 0; i < num_lits; ++i) {
+            unsigned lvl = pctx.get_assign_level(lits[i]);
+            unsigned j = 0;
+            for (; j < i && pctx.get_assign_level(lits[j]) != lvl; ++j)
+                ;
+            if (j == i && ++glue > m_max_glue)
+                return;
+        }
+        unsigned idx = pctx.m_par_index;
+        worker& w = *m_workers[idx];
+        expr_ref_vector clause(w.m);
+        for (unsigned i = 0; i < num_lits; ++i) {
+            expr* atom = pctx.bool_var2expr(lits[i].var());
+            if (!atom || !is_shareable(w, atom))
+                return;
+            clause.push_back(lits[i].sign() ? w.m.mk_not(atom) : atom);
+        }
+        w.m_out.push_back(mk_or(clause));
+        if (w.m_out.size() >= 32)
+            flush(idx, pctx);
+    }
+
+    void parallel::flush(unsigned idx, context& pctx) {
+        worker& w = *m_workers[idx];
+        if (w.m_out.empty())
+            return;
+        lock_guard lock(m_mux);
+        ast_translation tr(w.m, ctx.m);
+        for (expr* e : w.m_out) {
+            m_shared.push_back(tr(e));
+            m_shared_source.push_back(idx);
+        }
+        w.m_num_exported += w.m_out.size();
+        w.m_out.reset();
+    }
+
+    void parallel::import_clauses(context& pctx) {
+        unsigned idx = pctx.m_par_index;
+        worker& w = *m_workers[idx];
+        flush(idx, pctx);
+        expr_ref_vector clauses(w.m);
+        {
+            lock_guard lock(m_mux);
+            ast_translation tr(ctx.m, w.m);
+            for (; w.m_head < m_shared.size(); ++w.m_head)
+                if (m_shared_source[w.m_head] != idx)
+                    clauses.push_back(tr(m_shared.get(w.m_head)));
+        }
+        literal_vector lits;
+        for (expr* c : clauses) {
+            unsigned num_args = 1;
+            expr* const* args = &c;
+            if (w.m.is_or(c)) {
+                num_args = to_app(c)->get_num_args();
+                args = to_app(c)->get_args();
+            }
+            lits.reset();
+            for (unsigned i = 0; i < num_args; ++i) {
+                expr* atom = args[i];
+                bool sign = w.m.is_not(atom, atom);
+                if (!pctx.b_internalized(atom))
+                    break;
+                literal lit = pctx.get_literal(atom);
+                lits.push_back(sign ? ~lit : lit);
+            }
+            if (lits.size() != num_args)
+                continue;
+            pctx.mk_clause(lits.size(), lits.data(), nullptr, CLS_TH_LEMMA);
+            ++w.m_num_imported;
+            if (pctx.inconsistent())
+                break;
+        }
+    }
+}
 
 #ifdef SINGLE_THREAD
 
@@ -38,6 +155,27 @@ namespace smt {
 #include <thread>
 
 namespace smt {
+
+    /**
+       \brief Give each worker a different search configuration.
+       Worker 0 keeps the configuration of the main context.
+    */
+    static void diversify(smt_params& p, unsigned i) {
+        if (i == 0)
+            return;
+        static const phase_selection phases[4] = {
+            PS_CACHING_CONSERVATIVE, PS_CACHING, PS_THEORY, PS_CACHING_CONSERVATIVE2
+        };
+        static const restart_strategy restarts[4] = {
+            RS_IN_OUT_GEOMETRIC, RS_LUBY, RS_GEOMETRIC, RS_ARITHMETIC
+        };
+        p.m_phase_selection  = phases[i % 4];
+        p.m_restart_strategy = restarts[(i + i / 4) % 4];
+        if (p.m_restart_strategy == RS_GEOMETRIC)
+            p.m_restart_factor = 1.5;
+        if (i % 2 == 0)
+            p.m_random_var_freq = 0.02;
+    }
     
     lbool parallel::operator()(expr_ref_vector const& asms) {
 
@@ -79,7 +217,13 @@ namespace smt {
         
         for (unsigned i = 0; i < num_threads; ++i) {
             smt_params.push_back(ctx.get_fparams());
+            diversify(smt_params.back(), i);
         }
+        m_max_glue = ctx.get_fparams().m_threads_share_glue;
+        m_max_size = ctx.get_fparams().m_threads_share_size;
+        m_workers.reset();
+        m_shared.reset();
+        m_shared_source.reset();
         for (unsigned i = 0; i < num_threads; ++i) {
             ast_manager* new_m = alloc(ast_manager, m, true);
             pms.push_back(new_m);
@@ -90,6 +234,20 @@ namespace smt {
             ast_translation tr(m, *new_m);
             pasms.push_back(tr(asms));
             sl.push_child(&(new_m->limit()));
+
+            worker* w = alloc(worker, *new_m);
+            m_workers.push_back(w);
+            decl_collector dc(*new_m);
+            for (unsigned j = 0; j < new_ctx.get_num_asserted_formulas(); ++j)
+                dc.visit(new_ctx.get_asserted_formula(j));
+            for (expr* a : pasms.back())
+                dc.visit(a);
+            for (func_decl* f : dc.get_func_decls())
+                w->m_decls.insert(f);
+            if (m_max_glue > 0) {
+                new_ctx.m_par = this;
+                new_ctx.m_par_index = i;
+            }
         }
 
         auto cube = [](context& ctx, expr_ref_vector& lasms, expr_ref& c) {
@@ -230,8 +388,18 @@ namespace smt {
             thread_max_conflicts *= 2;            
         }
 
-        for (context* c : pctxs) {
-            c->collect_statistics(ctx.m_aux_stats);
+        for (unsigned i = 0; i < num_threads; ++i) {
+            context& pctx = *pctxs[i];
+            worker const& w = *m_workers[i];
+            pctx.collect_statistics(ctx.m_aux_stats);
+            // entries with the same key are summed over the threads when displayed
+            ctx.m_aux_stats.update("parallel clauses exported", w.m_num_exported);
+            ctx.m_aux_stats.update("parallel clauses imported", w.m_num_imported);
+            IF_VERBOSE(1, verbose_stream() << "(smt.thread " << i
+                       << " :conflicts " << pctx.m_stats.m_num_conflicts
+                       << " :decisions " << pctx.m_stats.m_num_decisions
+                       << " :exported " << w.m_num_exported
+                       << " :imported " << w.m_num_imported << ")\n";);
         }
 
         if (finished_id == UINT_MAX) {
@@ -19,16 +19,57 @@ Revision History:
 #pragma once
 
 #include "smt/smt_context.h"
+#include "util/mutex.h"
+#include "util/scoped_ptr_vector.h"
 
 namespace smt {
 
     class parallel {
-        context& ctx;
+        /**
+           \brief Per worker state of the learned clause exchange.
+           Learned clauses are buffered in the manager of the worker and
+           translated into the shared manager in batches.
+        */
+        struct worker {
+            ast_manager&             m;
+            expr_ref_vector          m_out;       // clauses waiting to be exported
+            obj_hashtable<func_decl> m_decls;     // uninterpreted symbols that can be shared
+            obj_map<expr, bool>      m_atom_ok;   // cache: atom only uses shareable symbols
+            expr_ref_vector          m_atoms;     // pins the keys of m_atom_ok
+            unsigned                 m_head = 0;  // next shared clause to import
+            unsigned                 m_num_exported = 0;
+            unsigned                 m_num_imported = 0;
+            worker(ast_manager& m): m(m), m_out(m), m_atoms(m) {}
+        };
+
+        context&                  ctx;
+        scoped_ptr_vector<worker> m_workers;
+        expr_ref_vector           m_shared;          // shared clauses in the manager of ctx
+        unsigned_vector           m_shared_source;   // worker that exported each shared clause
+        unsigned                  m_max_glue = 0;
+        unsigned                  m_max_size = 0;
+        mutex                     m_mux;
+
+        bool is_shareable(worker& w, expr* atom);
+        void flush(unsigned idx, context& pctx);
+
     public:
-        parallel(context& ctx): ctx(ctx) {}
+        parallel(context& ctx): ctx(ctx), m_shared(ctx.get_manager()) {}
 
         lbool operator()(expr_ref_vector const& asms);
 
+        /**
+           \brief Called by worker contexts on a new learned clause.
+           Clauses of low glue are queued for the other workers.
+        */
+        void export_clause(context& pctx, unsigned num_lits, literal const* lits);
+
+        /**
+           \brief Called by worker contexts at restarts. Queued clauses are flushed
+           and the clauses shared by other workers are added as lemmas.
+        */
+        void import_clauses(context& pctx);
+
     };
 
 }
@@ -187,6 +187,15 @@ namespace smt {
                 out.width(3);
                 out << max_generation << " : " << max_cost << "\n";
             }
+            if (s->get_num_match_attempts() > 0) {
+                out << "[quantifier_matches] ";
+                out.width(10);
+                out << q->get_qid().str() << " : ";
+                out.width(6);
+                out << s->get_num_match_attempts() << " : ";
+                out.width(6);
+                out << s->get_num_matches() << " : " << s->get_match_time() << "\n";
+            }
         }
 
         void del(quantifier * q) {
@@ -564,6 +573,7 @@ namespace smt {
 
     void quantifier_manager::collect_statistics(::statistics & st) const {
         m_imp->m_qi_queue.collect_statistics(st);
+        m_imp->m_plugin->collect_statistics(st);
     }
 
     void quantifier_manager::reset_statistics() {
@@ -624,6 +634,11 @@ namespace smt {
 
         quantifier_manager_plugin * mk_fresh() override { return alloc(default_qm_plugin); }
 
+        void collect_statistics(::statistics & st) const override {
+            m_mam->collect_statistics(st);
+            m_lazy_mam->collect_statistics(st);
+        }
+
         bool model_based() const override { return m_fparams->m_mbqi; }
 
         bool mbqi_enabled(quantifier *q) const override {
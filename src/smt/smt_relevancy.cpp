@@ -127,18 +127,21 @@ namespace smt {
         expr_ref_vector                m_relevant_exprs; 
         uint_set                       m_is_relevant;
         typedef list<relevancy_eh *>   relevancy_ehs;
-        obj_map<expr, relevancy_ehs *> m_relevant_ehs;
-        obj_map<expr, relevancy_ehs *> m_watches[2];
-        struct eh_trail {
-            enum class kind { POS_WATCH, NEG_WATCH, HANDLER };
-            kind   m_kind;
-            expr * m_node;
-            eh_trail(expr * n):m_kind(kind::HANDLER), m_node(n) {}
-            eh_trail(expr * n, bool val):m_kind(val ? kind::POS_WATCH : kind::NEG_WATCH), m_node(n) {}
-            kind get_kind() const { return m_kind; }
-            expr * get_node() const { return m_node; }
-        };
-        svector<eh_trail>              m_trail;
+        // handler and watch lists indexed by expression id.
+        ptr_vector<relevancy_ehs>      m_relevant_ehs;
+        ptr_vector<relevancy_ehs>      m_watches[2];
+        // expressions with a non-empty handler or watch list, kept alive
+        // such that their ids are not reused while the lists exist.
+        expr_ref_vector                m_pinned;
+        /**
+           \brief A trail entry packs the id of the expression and the kind
+           of the list that was extended.
+        */
+        enum eh_kind { NEG_WATCH = 0, POS_WATCH = 1, HANDLER = 2 };
+        static unsigned mk_trail(unsigned id, eh_kind k) { return (id << 2) | k; }
+        static unsigned trail_id(unsigned t) { return t >> 2; }
+        static eh_kind trail_kind(unsigned t) { return static_cast<eh_kind>(t & 3); }
+        unsigned_vector                m_trail;
         struct scope {
             unsigned m_relevant_exprs_lim;
             unsigned m_trail_lim;
@@ -147,48 +150,33 @@ namespace smt {
         bool                           m_propagating = false;
 
         relevancy_propagator_imp(context & ctx):
-            relevancy_propagator(ctx), m_relevant_exprs(ctx.get_manager()) {}
+            relevancy_propagator(ctx), m_relevant_exprs(ctx.get_manager()), m_pinned(ctx.get_manager()) {}
 
-        ~relevancy_propagator_imp() override {
-            ast_manager & m = get_manager();
-            unsigned i = m_trail.size();
-            while (i != 0) {
-                --i;
-                m.dec_ref(m_trail[i].get_node());
-            }
+        ptr_vector<relevancy_ehs> & get_lists(eh_kind k) {
+            return k == HANDLER ? m_relevant_ehs : m_watches[k];
         }
 
         relevancy_ehs * get_handlers(expr * n) {
-            relevancy_ehs * r = nullptr;
-            m_relevant_ehs.find(n, r);
-            SASSERT(m_relevant_ehs.contains(n) || r == 0);
-            return r;
-        }
-
-        void set_handlers(expr * n, relevancy_ehs * ehs) {
-            if (ehs == nullptr)
-                m_relevant_ehs.erase(n);
-            else
-                m_relevant_ehs.insert(n, ehs);
+            return m_relevant_ehs.get(n->get_id(), nullptr);
         }
 
         relevancy_ehs * get_watches(expr * n, bool val) {
-            relevancy_ehs * r = nullptr;
-            m_watches[val ? 1 : 0].find(n, r);
-            SASSERT(m_watches[val ? 1 : 0].contains(n) || r == 0);
-            return r;
+            return m_watches[val ? 1 : 0].get(n->get_id(), nullptr);
         }
 
-        void set_watches(expr * n, bool val, relevancy_ehs * ehs) {
+        /**
+           \brief Prepend eh to the list of kind k of n and record it in the trail.
+        */
+        void push_eh(expr * n, eh_kind k, relevancy_eh * eh) {
+            SASSERT(eh);
+            ptr_vector<relevancy_ehs> & lists = get_lists(k);
+            unsigned id = n->get_id();
+            lists.reserve(id + 1, nullptr);
+            relevancy_ehs * ehs = lists[id];
             if (ehs == nullptr)
-                m_watches[val ? 1 : 0].erase(n);
-            else
-                m_watches[val ? 1 : 0].insert(n, ehs);
-        }
-
-        void push_trail(eh_trail const & t) {
-            get_manager().inc_ref(t.get_node());
-            m_trail.push_back(t);
+                m_pinned.push_back(n);
+            lists[id] = new (get_region()) relevancy_ehs(eh, ehs);
+            m_trail.push_back(mk_trail(id, k));
         }
         
         void add_handler(expr * source, relevancy_eh * eh) override {
@@ -198,9 +186,7 @@ namespace smt {
                 eh->operator()(*this, source);
             }
             else {
-                SASSERT(eh);
-                push_trail(eh_trail(source));
-                set_handlers(source, new (get_region()) relevancy_ehs(eh, get_handlers(source)));
+                push_eh(source, HANDLER, eh);
             }
         }
         
@@ -214,9 +200,7 @@ namespace smt {
             case l_false:
                 return;
             case l_undef:
-                SASSERT(eh);
-                set_watches(n, val, new (get_region()) relevancy_ehs(eh, get_watches(n, val)));
-                push_trail(eh_trail(n, val));
+                push_eh(n, val ? POS_WATCH : NEG_WATCH, eh);
                 break;
             case l_true:
                 eh->operator()(*this, n, val);
@@ -282,22 +266,27 @@ namespace smt {
             m_qhead = m_relevant_exprs.size();
         }
 
+        /**
+           \brief Remove the handlers and watches added after old_lim.
+           An expression is unpinned when its list becomes empty. Lists become
+           empty in the reverse order in which they were first extended, so
+           it is always the last pinned expression.
+        */
         void undo_trail(unsigned old_lim) {
             SASSERT(old_lim <= m_trail.size());
-            ast_manager & m = get_manager();
             unsigned i = m_trail.size();
             while (i != old_lim) {
                 --i;
-                eh_trail & t = m_trail[i];
-                expr * n = t.get_node();
-                relevancy_ehs * ehs;
-                switch (t.get_kind()) {
-                case eh_trail::kind::POS_WATCH: ehs = get_watches(n, true); SASSERT(ehs); set_watches(n, true, ehs->tail()); break;
-                case eh_trail::kind::NEG_WATCH: ehs = get_watches(n, false); SASSERT(ehs); set_watches(n, false, ehs->tail()); break;
-                case eh_trail::kind::HANDLER:   ehs = get_handlers(n); SASSERT(ehs); set_handlers(n, ehs->tail()); break;
-                default: UNREACHABLE(); break;
+                unsigned t = m_trail[i];
+                unsigned id = trail_id(t);
+                ptr_vector<relevancy_ehs> & lists = get_lists(trail_kind(t));
+                relevancy_ehs * ehs = lists[id];
+                SASSERT(ehs);
+                lists[id] = ehs->tail();
+                if (lists[id] == nullptr) {
+                    SASSERT(m_pinned.back()->get_id() == id);
+                    m_pinned.pop_back();
                 }
-                m.dec_ref(n);
             }
             m_trail.shrink(old_lim);
         }
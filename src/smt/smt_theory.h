@@ -251,10 +251,17 @@ namespace smt {
 
         /**
            \brief This method is invoked when the theory application n
-           is marked as relevant.
+           is marked as relevant. Theories that override it must also
+           override has_relevant_eh.
          */
         virtual void relevant_eh(app * n) {
         }
+
+        /**
+           \brief Return true if relevant_eh has to be invoked for this theory.
+           smt::context skips the callback for theories that return false.
+         */
+        virtual bool has_relevant_eh() const { return false; }
         
         /**
            \brief This method is invoked when a new backtracking point
@@ -812,6 +812,7 @@ class theory_arith : public theory, public theory_opt, private Ext {
   void pop_scope_eh(unsigned num_scopes) override;
 
   void relevant_eh(app* n) override;
+  bool has_relevant_eh() const override { return true; }
 
   void restart_eh() override;
   void init_search_eh() override;
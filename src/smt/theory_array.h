@@ -60,6 +60,7 @@ namespace smt {
         void new_eq_eh(theory_var v1, theory_var v2) override;
         void new_diseq_eh(theory_var v1, theory_var v2) override;
         void relevant_eh(app * n) override;
+        bool has_relevant_eh() const override { return true; }
         void push_scope_eh() override;
         void pop_scope_eh(unsigned num_scopes) override;
         final_check_status final_check_eh() override;
@@ -242,6 +242,7 @@ namespace smt {
         virtual void expand_diseq(theory_var v1, theory_var v2);
         void assign_eh(bool_var v, bool is_true) override;
         void relevant_eh(app * n) override;
+        bool has_relevant_eh() const override { return true; }
         void push_scope_eh() override;
         void pop_scope_eh(unsigned num_scopes) override;
         final_check_status final_check_eh() override;
@@ -124,6 +124,7 @@ namespace smt {
         void new_diseq_eh(theory_var v1, theory_var v2) override;
         void assign_eh(bool_var v, bool is_true) override;
         void relevant_eh(app * n) override;
+        bool has_relevant_eh() const override { return true; }
         void push_scope_eh() override;
         void pop_scope_eh(unsigned num_scopes) override;
         final_check_status final_check_eh() override;
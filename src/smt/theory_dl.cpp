@@ -173,6 +173,8 @@ namespace smt {
         }
 
         
+        bool has_relevant_eh() const override { return true; }
+
         void relevant_eh(app * n) override {
             if (u().is_finite_sort(n)) {
                 sort* s = n->get_sort();
@@ -105,6 +105,7 @@ namespace smt {
 
         void assign_eh(bool_var v, bool is_true) override;
         void relevant_eh(app * n) override;
+        bool has_relevant_eh() const override { return true; }
         void init_model(model_generator & m) override;
         void finalize_model(model_generator & mg) override;
 
@@ -60,6 +60,7 @@ namespace smt {
         void restart_eh() override;
 
         void relevant_eh(app* e) override;
+        bool has_relevant_eh() const override { return true; }
 
         void init_search_eh() override;
 
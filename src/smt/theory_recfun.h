@@ -91,6 +91,7 @@ namespace smt {
         bool internalize_term(app * term) override;
         void reset_eh() override;
         void relevant_eh(app * n) override;
+        bool has_relevant_eh() const override { return true; }
         char const * get_name() const override;
         final_check_status final_check_eh() override;
         void assign_eh(bool_var v, bool is_true) override;
@@ -393,6 +393,7 @@ namespace smt {
         void pop_scope_eh(unsigned num_scopes) override;
         void restart_eh() override;
         void relevant_eh(app* n) override;
+        bool has_relevant_eh() const override { return true; }
         bool should_research(expr_ref_vector &) override;
         void add_theory_assumptions(expr_ref_vector & assumptions) override;
         theory* mk_fresh(context* new_ctx) override { return alloc(theory_seq, *new_ctx); }
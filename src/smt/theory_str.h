@@ -760,6 +760,7 @@ protected:
     void add_theory_assumptions(expr_ref_vector & assumptions) override;
     lbool validate_unsat_core(expr_ref_vector & unsat_core) override;
     void relevant_eh(app * n) override;
+    bool has_relevant_eh() const override { return true; }
     void assign_eh(bool_var v, bool is_true) override;
     void push_scope_eh() override;
     void pop_scope_eh(unsigned num_scopes) override;
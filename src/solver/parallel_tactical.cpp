@@ -29,6 +29,7 @@ Notes:
 --*/
 
 #include "util/scoped_ptr_vector.h"
+#include "util/stopwatch.h"
 #include "ast/ast_pp.h"
 #include "ast/ast_util.h"
 #include "ast/ast_translation.h"
@@ -74,43 +75,94 @@ class parallel_tactic : public tactic {
 
     class solver_state; 
 
+    /**
+       \brief Work-stealing task queue.
+
+       Each worker owns a deque of tasks. A worker takes the most recently
+       added task from its own deque, so that it keeps working depth first on
+       the cubes it split itself. When its deque is empty it steals the task
+       with the largest estimated hardness from another worker.
+
+       Tasks run for a long time compared to queue operations, so the deques
+       share one lock that also protects the termination bookkeeping.
+    */
     class task_queue {
+        struct worker_queue {
+            ptr_vector<solver_state> m_tasks;
+            unsigned                 m_num_tasks = 0;    // tasks executed by worker
+            unsigned                 m_num_steals = 0;   // tasks stolen from other workers
+            double                   m_busy = 0;         // seconds spent on tasks
+            double                   m_idle = 0;         // seconds spent waiting for tasks
+        };
         std::mutex                   m_mutex;
         std::condition_variable      m_cond;
-        ptr_vector<solver_state>     m_tasks;
+        vector<worker_queue>         m_queues;
         ptr_vector<solver_state>     m_active;
+        unsigned                     m_num_queued;
         unsigned                     m_num_waiters;
         std::atomic<bool>            m_shutdown;
 
-        void inc_wait() {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            ++m_num_waiters;
+        solver_state* steal(unsigned id) {
+            unsigned victim = UINT_MAX, idx = 0;
+            double best = -1;
+            for (unsigned j = 0; j < m_queues.size(); ++j) {
+                if (j == id)
+                    continue;
+                auto const& tasks = m_queues[j].m_tasks;
+                for (unsigned i = 0; i < tasks.size(); ++i) {
+                    double h = tasks[i]->hardness();
+                    if (h > best) {
+                        best = h;
+                        victim = j;
+                        idx = i;
+                    }
+                }
+            }
+            if (victim == UINT_MAX)
+                return nullptr;
+            auto& tasks = m_queues[victim].m_tasks;
+            solver_state* st = tasks[idx];
+            tasks.erase(tasks.begin() + idx);
+            ++m_queues[id].m_num_steals;
+            return st;
         }
 
-        void dec_wait() {
+        solver_state* try_get_task(unsigned id) {
             std::lock_guard<std::mutex> lock(m_mutex);
-            --m_num_waiters;
-        }
-
-        solver_state* try_get_task() {
+            if (m_num_queued == 0)
+                return nullptr;
+            auto& tasks = m_queues[id].m_tasks;
             solver_state* st = nullptr;
-            std::lock_guard<std::mutex> lock(m_mutex);
-            if (!m_tasks.empty()) {
-                st = m_tasks.back();
-                m_tasks.pop_back();
-                m_active.push_back(st);
+            if (!tasks.empty()) {
+                st = tasks.back();
+                tasks.pop_back();
+            }
+            else {
+                st = steal(id);
             }
+            SASSERT(st);
+            --m_num_queued;
+            ++m_queues[id].m_num_tasks;
+            st->set_worker(id);
+            m_active.push_back(st);
             return st;
         }
 
     public:
 
         task_queue(): 
+            m_num_queued(0),
             m_num_waiters(0), 
             m_shutdown(false) {}             
 
         ~task_queue() { reset(); }
 
+        void set_num_workers(unsigned n) {
+            SASSERT(m_num_queued == 0);
+            m_queues.reset();
+            m_queues.resize(std::max(n, 1u));
+        }
+
         void shutdown() {
             if (!m_shutdown) {
                 std::lock_guard<std::mutex> lock(m_mutex);
@@ -124,70 +176,104 @@ class parallel_tactic : public tactic {
 
         bool in_shutdown() const { return m_shutdown; }
 
+        /**
+           \brief add task to the deque of the worker that created it.
+        */
         void add_task(solver_state* task) {
             std::lock_guard<std::mutex> lock(m_mutex);
-            m_tasks.push_back(task);
+            SASSERT(task->worker() < m_queues.size());
+            m_queues[task->worker()].m_tasks.push_back(task);
+            ++m_num_queued;
             if (m_num_waiters > 0) {
                 m_cond.notify_one();
             }            
         } 
 
+        /**
+           \brief some worker is waiting and no task is available for it.
+        */
         bool is_idle() {
             std::lock_guard<std::mutex> lock(m_mutex);
-            return m_tasks.empty() && m_num_waiters > 0;
+            return m_num_queued == 0 && m_num_waiters > 0;
         }
 
-        solver_state* get_task() { 
-            while (!m_shutdown) {
-                inc_wait();
-                solver_state* st = try_get_task();
-                if (st) {
-                    dec_wait();
-                    return st;
-                }
-                {
-                    std::unique_lock<std::mutex> lock(m_mutex);
-                    if (!m_shutdown) {
-                        m_cond.wait(lock);
-                    }
+        solver_state* get_task(unsigned id) { 
+            stopwatch sw;
+            sw.start();
+            solver_state* st = nullptr;
+            while (!m_shutdown && !st) {
+                st = try_get_task(id);
+                if (st) 
+                    break;
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (!m_shutdown && m_num_queued == 0) {
+                    ++m_num_waiters;
+                    m_cond.wait(lock);
+                    --m_num_waiters;
                 }
-                dec_wait();
             }
-            return nullptr;
+            sw.stop();
+            m_queues[id].m_idle += sw.get_seconds();
+            return st;
         }
 
-        void task_done(solver_state* st) {
+        void task_done(unsigned id, solver_state* st, double seconds) {
             std::lock_guard<std::mutex> lock(m_mutex);
+            m_queues[id].m_busy += seconds;
             m_active.erase(st);
-            if (m_tasks.empty() && m_active.empty()) {
+            if (m_num_queued == 0 && m_active.empty()) {
                 m_shutdown = true;
                 m_cond.notify_all();
             }
         }
 
         void stats(::statistics& st) {
-            for (auto* t : m_tasks) 
-                t->get_solver().collect_statistics(st);
+            for (auto const& q : m_queues) 
+                for (auto* t : q.m_tasks) 
+                    t->get_solver().collect_statistics(st);
             for (auto* t : m_active) 
                 t->get_solver().collect_statistics(st);
+            unsigned steals = 0;
+            for (auto const& q : m_queues)
+                steals += q.m_num_steals;
+            st.update("par steals", steals);
         }
 
         void reset() {
-            for (auto* t : m_tasks) 
-                dealloc(t);
+            for (auto& q : m_queues) {
+                for (auto* t : q.m_tasks) 
+                    dealloc(t);
+                q.m_tasks.reset();
+                q.m_num_tasks = q.m_num_steals = 0;
+                q.m_busy = q.m_idle = 0;
+            }
             for (auto* t : m_active) 
                 dealloc(t);
-            m_tasks.reset();
             m_active.reset();
+            m_num_queued = 0;
             m_num_waiters = 0;
             m_shutdown = false;
         }
 
         std::ostream& display(std::ostream& out) {
             std::lock_guard<std::mutex> lock(m_mutex);
-            out << "num_tasks " << m_tasks.size() << " active: " << m_active.size() << "\n";
-            for (solver_state* st : m_tasks) {
-                st->display(out);
+            out << "num_tasks " << m_num_queued << " active: " << m_active.size() << "\n";
+            for (auto const& q : m_queues)
+                for (solver_state* st : q.m_tasks) 
+                    st->display(out);
+            return out;
+        }
+
+        /**
+           \brief display the share of time each worker spent on tasks.
+        */
+        std::ostream& display_utilization(std::ostream& out) {
+            for (unsigned i = 0; i < m_queues.size(); ++i) {
+                auto const& q = m_queues[i];
+                double total = q.m_busy + q.m_idle;
+                out << "(tactic.parallel :worker " << i << " :tasks " << q.m_num_tasks 
+                    << " :steals " << q.m_num_steals << " :busy " << q.m_busy << " :idle " << q.m_idle
+                    << " :utilization " << (total > 0 ? 100.0 * q.m_busy / total : 0) << "%)\n";
             }
             return out;
         }
@@ -220,8 +306,21 @@ class parallel_tactic : public tactic {
         ref<solver>     m_solver;                 // solver state
         unsigned        m_depth;                  // number of nested calls to cubing
         double          m_width;                  // estimate of fraction of problem handled by state
+        double          m_conflicts;              // conflicts of the last simplification, estimate of hardness
+        unsigned        m_worker;                 // worker that owns the state
         bool            m_giveup;
 
+        void update_conflicts() {
+            statistics st;
+            get_solver().collect_statistics(st);
+            for (unsigned i = 0; i < st.size(); ++i) {
+                if (st.is_uint(i) && (strcmp(st.get_key(i), "sat conflicts") == 0 || strcmp(st.get_key(i), "conflicts") == 0)) {
+                    m_conflicts = std::max(1.0, static_cast<double>(st.get_uint_value(i)));
+                    return;
+                }
+            }
+        }
+
     public:
         solver_state(ast_manager* m, solver* s, params_ref const& p): 
             m_manager(m),
@@ -231,6 +330,8 @@ class parallel_tactic : public tactic {
             m_solver(s),
             m_depth(0),
             m_width(1.0),
+            m_conflicts(1.0),
+            m_worker(0),
             m_giveup(false)
         {
         }
@@ -261,6 +362,8 @@ class parallel_tactic : public tactic {
             for (expr* c : m_assumptions) st->m_assumptions.push_back(tr(c));
             st->m_depth = m_depth;
             st->m_width = m_width;
+            st->m_conflicts = m_conflicts;
+            st->m_worker = m_worker;
             return st;
         }
 
@@ -292,6 +395,17 @@ class parallel_tactic : public tactic {
 
         unsigned get_depth() const { return m_depth; }
 
+        unsigned worker() const { return m_worker; }
+
+        void set_worker(unsigned w) { m_worker = w; }
+
+        /**
+           \brief estimate of the remaining work: the number of cubes, weighted by the
+           conflicts needed for the last simplification and the share of the search
+           space covered by the state.
+        */
+        double hardness() const { return m_conflicts * std::max(1u, m_cubes.size()) / m_width; }
+
         lbool simplify() {
             lbool r = l_undef;
             IF_VERBOSE(2, verbose_stream() << "(parallel.tactic simplify-1)\n";);
@@ -302,6 +416,7 @@ class parallel_tactic : public tactic {
             IF_VERBOSE(2, verbose_stream() << "(parallel.tactic simplify-2)\n";);
             set_simplify_params(false);        // remove blocked
             r = get_solver().check_sat(m_assumptions);
+            update_conflicts();
             return r;            
         }
 
@@ -396,6 +511,10 @@ private:
     int           m_exn_code;
     std::string   m_exn_msg;
     std::string   m_reason_undef;
+    // shape of the cube tree: branches closed at each depth
+    unsigned_vector m_closed_unsat;
+    unsigned_vector m_closed_sat;
+    unsigned_vector m_closed_undef;
 
     void init() {
         parallel_params pp(m_params);
@@ -409,6 +528,9 @@ private:
         m_backtrack_frequency = pp.conquer_backtrack_frequency();
         m_conquer_delay = pp.conquer_delay();
         m_exn_code = 0;
+        m_closed_unsat.reset();
+        m_closed_sat.reset();
+        m_closed_undef.reset();
         m_params.set_bool("override_incremental", true);
         m_core = nullptr;        
     }
@@ -449,12 +571,22 @@ private:
         }
     }
 
+    void record_leaf(unsigned_vector& leaves, unsigned depth) {
+        leaves.reserve(depth + 1, 0);
+        ++leaves[depth];
+    }
+
     void close_branch(solver_state& s, lbool status) {
         double f = 100.0 / s.get_width();
         {
             std::lock_guard<std::mutex> lock(m_mutex);
             m_progress += f;
             --m_branches;
+            switch (status) {
+            case l_true:  record_leaf(m_closed_sat, s.get_depth()); break;
+            case l_false: record_leaf(m_closed_unsat, s.get_depth()); break;
+            default:      record_leaf(m_closed_undef, s.get_depth()); break;
+            }
         }
         log_branches(status);
     }
@@ -494,6 +626,13 @@ private:
         m_last_depth = s.get_depth();
     }
 
+    void inc_conquered(solver_state& s) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_num_unsat;
+        m_last_depth = s.get_depth();
+        record_leaf(m_closed_unsat, s.get_depth() + 1);
+    }
+
     void report_unsat(solver_state& s) {        
         inc_unsat(s);
         close_branch(s, l_false);
@@ -592,7 +731,7 @@ private:
                     IF_VERBOSE(0, verbose_stream() << "(tactic.parallel :backtrack " << cutoff << " -> " << c.size() << ")\n");
                     cutoff = c.size();
                 }
-                inc_unsat(s);
+                inc_conquered(s);
                 log_branches(l_false);
                 break;
 
@@ -611,7 +750,9 @@ private:
                 break;
 
             }
-            if (cubes.size() >= conquer_batch_size()) {
+            // hand out cubes early when other workers are starved, so that
+            // long running cubes are re-split among idle workers.
+            if (cubes.size() >= conquer_batch_size() || (!cubes.empty() && m_queue.is_idle())) {
                 spawn_cubes(s, 10*width, cubes);
                 first = false;
                 cubes.reset();
@@ -698,12 +839,15 @@ private:
         return memory::above_high_watermark();
     }
 
-    void run_solver() {
+    void run_solver(unsigned id) {
         try {
-            while (solver_state* st = m_queue.get_task()) {
+            while (solver_state* st = m_queue.get_task(id)) {
+                stopwatch sw;
+                sw.start();
                 cube_and_conquer(*st);                
                 collect_statistics(*st);
-                m_queue.task_done(st);
+                sw.stop();
+                m_queue.task_done(id, st, sw.get_seconds());
                 if (!st->m().inc()) m_queue.shutdown();
                 IF_VERBOSE(2, display(verbose_stream()););
                 dealloc(st);
@@ -737,10 +881,11 @@ private:
         add_branches(1);
         vector<std::thread> threads;
         for (unsigned i = 0; i < m_num_threads; ++i) 
-            threads.push_back(std::thread([this]() { run_solver(); }));
+            threads.push_back(std::thread([this, i]() { run_solver(i); }));
         for (std::thread& t : threads) 
             t.join();
         m_queue.stats(m_stats);
+        IF_VERBOSE(1, m_queue.display_utilization(verbose_stream()); display_tree(verbose_stream()););
         m_manager.limit().reset_cancel();
         if (m_exn_code == -1) 
             throw default_exception(std::move(m_exn_msg));
@@ -760,6 +905,21 @@ private:
         return l_false;
     }
 
+    /**
+       \brief display the shape of the cube tree as the number of branches closed at each depth.
+    */
+    std::ostream& display_tree(std::ostream& out) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        unsigned max_depth = std::max(m_closed_unsat.size(), std::max(m_closed_sat.size(), m_closed_undef.size()));
+        auto get = [](unsigned_vector const& v, unsigned d) { return d < v.size() ? v[d] : 0; };
+        for (unsigned d = 0; d < max_depth; ++d) {
+            unsigned u = get(m_closed_unsat, d), t = get(m_closed_sat, d), x = get(m_closed_undef, d);
+            if (u + t + x > 0)
+                out << "(tactic.parallel :depth " << d << " :unsat " << u << " :sat " << t << " :undef " << x << ")\n";
+        }
+        return out;
+    }
+
     std::ostream& display(std::ostream& out) {
         unsigned n_models, n_unsat;
         double n_progress;
@@ -796,6 +956,7 @@ public:
             throw default_exception("parallel tactic does not work with trace");
         solver* s = m_solver->translate(m, m_params);
         solver_state* st = alloc(solver_state, nullptr, s, m_params);
+        m_queue.set_num_workers(m_num_threads);
         m_queue.add_task(st);
         expr_ref_vector clauses(m);
         ptr_vector<expr> assumptions;
@@ -845,6 +1006,9 @@ public:
     void cleanup() override {
         m_queue.reset();
         m_models.reset();
+        m_closed_unsat.reset();
+        m_closed_sat.reset();
+        m_closed_undef.reset();
     }
 
     tactic* translate(ast_manager& m) override {
@@ -860,6 +1024,8 @@ public:
 
     void collect_statistics(statistics & st) const override {
         st.copy(m_stats);
+        unsigned max_depth = std::max(m_closed_unsat.size(), std::max(m_closed_sat.size(), m_closed_undef.size()));
+        st.update("par max depth", max_depth > 0 ? max_depth - 1 : 0);
         st.update("par unsat", m_num_unsat);
         st.update("par models", m_models.size());
         st.update("par progress", m_progress);
@@ -17,6 +17,10 @@ Revision History:
 
 --*/
 #include "ast/ast.h"
+#ifndef SINGLE_THREAD
+#include <thread>
+#include <vector>
+#endif
 
 static void tst1() {
     ast_manager m;
@@ -131,6 +135,48 @@ static void tst5() {
     m.del(arr3);
 }
 
+#ifndef SINGLE_THREAD
+static void tst6() {
+    // build the same terms from several threads sharing one manager
+    ast_manager m;
+    family_id fid = m.get_basic_family_id();
+    sort_ref b(m.mk_bool_sort(), m);
+    expr_ref a(m.mk_const(symbol("a"), b.get()), m);
+    unsigned num_threads = 4, num_terms = 200;
+    vector<expr_ref_vector> results;
+    for (unsigned i = 0; i < num_threads; ++i)
+        results.push_back(expr_ref_vector(m));
+    m.set_concurrent(true);
+    ENSURE(m.is_concurrent());
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < num_threads; ++i) {
+        threads.push_back(std::thread([&, i]() {
+            expr_ref t(a, m);
+            for (unsigned j = 0; j < num_terms; ++j) {
+                expr_ref c(m.mk_const(symbol(j), b.get()), m);
+                expr_ref tmp(m.mk_app(fid, OP_AND, t.get(), c.get()), m);
+                // dropped right away, reclaimed when leaving the concurrent mode
+                expr_ref junk(m.mk_app(fid, OP_OR, c.get(), tmp.get()), m);
+                t = m.mk_app(fid, j % 2 == 0 ? OP_OR : OP_AND, tmp.get(), a.get());
+                results[i].push_back(t);
+            }
+        }));
+    }
+    for (auto & th : threads)
+        th.join();
+    m.set_concurrent(false);
+    ENSURE(!m.is_concurrent());
+    for (unsigned i = 1; i < num_threads; ++i)
+        for (unsigned j = 0; j < num_terms; ++j)
+            ENSURE(results[i].get(j) == results[0].get(j));
+    expr_ref c0(m.mk_const(symbol(0u), b.get()), m);
+    expr_ref t0(m.mk_app(fid, OP_AND, a.get(), c0.get()), m);
+    t0 = m.mk_app(fid, OP_OR, t0.get(), a.get());
+    ENSURE(t0.get() == results[0].get(0));
+    for (auto & r : results)
+        r.reset();
+}
+#endif
 
 struct foo {
     unsigned       m_id; 
@@ -153,5 +199,8 @@ void tst_ast() {
     tst3();
     tst4();
     tst5();
+#ifndef SINGLE_THREAD
+    tst6();
+#endif
 }
 
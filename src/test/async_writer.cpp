@@ -0,0 +1,42 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    async_writer.cpp
+
+Abstract:
+
+    Test writing a stream from a background thread.
+
+--*/
+#include "util/async_writer.h"
+#include "util/util.h"
+#include <sstream>
+#include <iostream>
+
+static void tst_async_writer(size_t capacity, unsigned num_records) {
+    std::ostringstream expected, out;
+    random_gen r(0);
+    {
+        async_writer w(out, capacity);
+        for (unsigned i = 0; i < num_records; ++i) {
+            std::string rec = "a " + std::to_string(r()) + " " + std::to_string(i) + " 0\n";
+            expected << rec;
+            w.write(rec);
+            if (i == num_records / 2) {
+                w.flush();
+                ENSURE(out.str() == expected.str());
+            }
+        }
+        ENSURE(w.num_bytes() == expected.str().size());
+        std::cout << "bytes: " << w.num_bytes() << " stalls: " << w.num_stalls() << "\n";
+    }
+    ENSURE(out.str() == expected.str());
+}
+
+void tst_async_writer() {
+    tst_async_writer(1 << 16, 100000);
+    tst_async_writer(1 << 22, 10000);
+    tst_async_writer(1 << 16, 0);
+}
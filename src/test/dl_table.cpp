@@ -6,6 +6,8 @@ Copyright (c) 2015 Microsoft Corporation
 #include "muz/rel/dl_table.h"
 #include "muz/fp/dl_register_engine.h"
 #include "muz/rel/dl_relation_manager.h"
+#include "util/stopwatch.h"
+#include "util/util.h"
 #include <iostream>
 
 typedef datalog::table_base* (*mk_table_fn)(datalog::relation_manager& m, datalog::table_signature& sig);
@@ -16,6 +18,18 @@ static datalog::table_base* mk_bv_table(datalog::relation_manager& m, datalog::t
     return p->mk_empty(sig);
 }
 
+static datalog::table_base* mk_columnar_table(datalog::relation_manager& m, datalog::table_signature& sig) {
+    datalog::table_plugin * p = m.get_table_plugin(symbol("columnar"));
+    ENSURE(p);
+    return p->mk_empty(sig);
+}
+
+static datalog::table_base* mk_sparse_table(datalog::relation_manager& m, datalog::table_signature& sig) {
+    datalog::table_plugin * p = m.get_table_plugin(symbol("sparse"));
+    ENSURE(p);
+    return p->mk_empty(sig);
+}
+
 static void test_table(mk_table_fn mk_table) {
     datalog::table_signature sig;
     sig.push_back(2);
@@ -96,6 +110,120 @@ void test_dl_bitvector_table() {
     test_table(mk_bv_table);
 }
 
+void test_dl_columnar_table() {
+    test_table(mk_columnar_table);
+}
+
+static void fill_random(datalog::table_base& t, unsigned rows, unsigned range, random_gen& rand) {
+    datalog::table_fact f;
+    for (unsigned i = 0; i < rows; ++i) {
+        f.reset();
+        for (unsigned j = 0; j < t.get_signature().size(); ++j)
+            f.push_back(rand(range));
+        t.add_fact(f);
+    }
+}
+
+/**
+   \brief Check columnar joins against sparse tables on random facts and
+   report the time taken by both.
+*/
+static void test_columnar_joins(unsigned rows, unsigned range) {
+    smt_params params;
+    ast_manager ast_m;
+    reg_decl_plugins(ast_m);
+    datalog::register_engine re;
+    datalog::context ctx(ast_m, re, params);
+    datalog::relation_manager & m = ctx.get_rel_context()->get_rmanager();
+    datalog::table_signature sig;
+    for (unsigned i = 0; i < 3; ++i)
+        sig.push_back(range);
+
+    mk_table_fn mk_tables[2] = { mk_sparse_table, mk_columnar_table };
+    datalog::table_base* results[2][3];
+    for (unsigned k = 0; k < 2; ++k) {
+        random_gen rand(7);
+        datalog::table_base* t1 = mk_tables[k](m, sig);
+        datalog::table_base* t2 = mk_tables[k](m, sig);
+        fill_random(*t1, rows, range, rand);
+        fill_random(*t2, rows, range, rand);
+        unsigned cols1[2] = { 0, 2 };
+        unsigned cols2[2] = { 1, 0 };
+        unsigned removed[2] = { 1, 3 };
+        stopwatch sw;
+        sw.start();
+        datalog::table_join_fn * j1 = m.mk_join_fn(*t1, *t2, 1, cols1, cols2);
+        datalog::table_join_fn * j2 = m.mk_join_fn(*t1, *t2, 2, cols1, cols2);
+        datalog::table_join_fn * j3 = m.mk_join_project_fn(*t1, *t2, 1, cols1, cols2, 2, removed);
+        results[k][0] = (*j1)(*t1, *t2);
+        results[k][1] = (*j2)(*t1, *t2);
+        results[k][2] = (*j3)(*t1, *t2);
+        sw.stop();
+        std::cout << t1->get_plugin().get_name() << " joins: " << sw.get_seconds() << "s, rows:";
+        for (unsigned i = 0; i < 3; ++i)
+            std::cout << " " << results[k][i]->get_size_estimate_rows();
+        std::cout << "\n";
+        dealloc(j1);
+        dealloc(j2);
+        dealloc(j3);
+        t1->deallocate();
+        t2->deallocate();
+    }
+    datalog::table_fact f;
+    for (unsigned i = 0; i < 3; ++i) {
+        ENSURE(results[0][i]->get_size_estimate_rows() == results[1][i]->get_size_estimate_rows());
+        for (auto const& row : *results[0][i]) {
+            row.get_fact(f);
+            ENSURE(results[1][i]->contains_fact(f));
+        }
+        results[0][i]->deallocate();
+        results[1][i]->deallocate();
+    }
+}
+
+static void test_columnar_remove() {
+    smt_params params;
+    ast_manager ast_m;
+    reg_decl_plugins(ast_m);
+    datalog::register_engine re;
+    datalog::context ctx(ast_m, re, params);
+    datalog::relation_manager & m = ctx.get_rel_context()->get_rmanager();
+    datalog::table_signature sig;
+    sig.push_back(100);
+    sig.push_back(100);
+    datalog::table_base* t = mk_columnar_table(m, sig);
+    datalog::table_fact f;
+    for (unsigned i = 0; i < 100; ++i) {
+        f.reset();
+        f.push_back(i);
+        f.push_back(i % 7);
+        t->add_fact(f);
+    }
+    for (unsigned i = 0; i < 100; i += 3) {
+        f.reset();
+        f.push_back(i);
+        f.push_back(i % 7);
+        t->remove_fact(f);
+    }
+    for (unsigned i = 0; i < 100; ++i) {
+        f.reset();
+        f.push_back(i);
+        f.push_back(i % 7);
+        ENSURE(t->contains_fact(f) == (i % 3 != 0));
+    }
+    ENSURE(t->get_size_estimate_rows() == 66);
+    datalog::table_base* c = t->clone();
+    ENSURE(c->get_size_estimate_rows() == 66);
+    t->reset();
+    ENSURE(t->empty());
+    ENSURE(c->contains_fact(f) == (99 % 3 != 0));
+    t->deallocate();
+    c->deallocate();
+}
+
 void tst_dl_table() {
     test_dl_bitvector_table();
+    test_dl_columnar_table();
+    test_columnar_remove();
+    test_columnar_joins(2000, 200);
 }
@@ -148,6 +148,7 @@ int main(int argc, char ** argv) {
     bool test_all = false;
     parse_cmd_line_args(argc, argv, do_display_usage, test_all);
     TST(random);
+    TST(async_writer);
     TST(symbol_table);
     TST(region);
     TST(symbol);
@@ -202,7 +203,9 @@ int main(int argc, char ** argv) {
     TST(api_bug);
     TST(arith_rewriter);
     TST(check_assumptions);
+    TST(smt_cg_table);
     TST(smt_context);
+    TST(smt_quantifier);
     TST(theory_dl);
     TST(model_retrieval);
     TST(model_based_opt);
@@ -248,6 +251,14 @@ int main(int argc, char ** argv) {
     TST(theory_pb);
     TST(simplex);
     TST(sat_user_scope);
+    TST(sat_cube_and_conquer);
+    TST(sat_ddfw);
+    TST(sat_xor_gauss);
+    TST(sat_vivify);
+    TST(sat_scc);
+    TST(sat_restart);
+    TST(sat_simplifier);
+    TST(sat_proof_trim);
     TST_ARGV(ddnf);
     TST(ddnf1);
     TST(model_evaluator);
@@ -255,6 +266,8 @@ int main(int argc, char ** argv) {
     TST(pb2bv);
     TST_ARGV(sat_lookahead);
     TST_ARGV(sat_local_search);
+    TST_ARGV(sat_propagate);
+    TST_ARGV(sat_parallel);
     TST_ARGV(cnf_backbones);
     TST(bdd);
     TST(pdd);
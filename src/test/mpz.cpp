@@ -21,6 +21,10 @@ Revision History:
 #include "util/rational.h"
 #include "util/timeit.h"
 #include "util/scoped_numeral.h"
+#include "util/mpn.h"
+#include "util/stopwatch.h"
+#include "util/vector.h"
+#include "util/util.h"
 #include <iostream>
 
 static void tst1() {
@@ -504,8 +508,137 @@ static void tst_pw2() {
     }
 }
 
+// reference schoolbook multiplication over 32 bit digits (Knuth's Algorithm M).
+static void ref_mul(mpn_digit const * a, unsigned lnga, mpn_digit const * b, unsigned lngb, mpn_digit * c) {
+    for (unsigned i = 0; i < lnga + lngb; i++)
+        c[i] = 0;
+    for (unsigned j = 0; j < lngb; j++) {
+        mpn_digit k = 0;
+        for (unsigned i = 0; i < lnga; i++) {
+            uint64_t t = (uint64_t)a[i] * b[j] + c[i+j] + k;
+            c[i+j] = (mpn_digit)t;
+            k = (mpn_digit)(t >> 32);
+        }
+        c[j+lnga] = k;
+    }
+}
+
+static void mk_random_digits(random_gen & r, unsigned n, unsigned_vector & ds) {
+    ds.reset();
+    for (unsigned i = 0; i < n; i++) 
+        ds.push_back((r() << 17) ^ (r() << 2) ^ r());
+    // exercise carry chains
+    if (n > 0 && r() % 4 == 0)
+        ds[r() % n] = UINT_MAX;
+    if (n > 0 && ds.back() == 0)
+        ds.back() = 1;
+}
+
+static void tst_mpn_kernels() {
+    mpn_manager m;
+    random_gen r(0);
+    unsigned sizes[] = { 1, 2, 3, 4, 5, 8, 17, 63, 64, 65, 66, 97, 130, 257, 600 };
+    unsigned_vector a, b, c1, c2, q, rem, t;
+    for (unsigned sa : sizes) {
+        for (unsigned sb : sizes) {
+            mk_random_digits(r, sa, a);
+            mk_random_digits(r, sb, b);
+            c1.resize(sa + sb);
+            c2.resize(sa + sb);
+            m.mul(a.data(), sa, b.data(), sb, c1.data());
+            ref_mul(a.data(), sa, b.data(), sb, c2.data());
+            ENSURE(c1 == c2);
+
+            unsigned sz;
+            c1.resize(std::max(sa, sb) + 1);
+            m.add(a.data(), sa, b.data(), sb, c1.data(), c1.size(), &sz);
+            mpn_digit borrow;
+            c2.resize(std::max(sa, sb));
+            m.sub(c1.data(), sz, b.data(), sb, c2.data(), &borrow);
+            ENSURE(borrow == 0);
+            for (unsigned i = 0; i < c2.size(); ++i) 
+                ENSURE(c2[i] == (i < sa ? a[i] : 0));
+
+            if (sa >= sb) {
+                q.resize(sa - sb + 1);
+                rem.resize(sb);
+                m.div(a.data(), sa, b.data(), sb, q.data(), rem.data());
+                t.resize(sa + 1);
+                ref_mul(q.data(), q.size(), b.data(), sb, t.data());
+                m.add(t.data(), sa, rem.data(), sb, t.data(), sa + 1, &sz);
+                for (unsigned i = 0; i < sa; ++i)
+                    ENSURE(t[i] == a[i]);
+                ENSURE(m.compare(rem.data(), sb, b.data(), sb) < 0);
+            }
+        }
+    }
+}
+
+/**
+   \brief Compare the multiplication kernels of mpn_manager with the reference schoolbook multiplication.
+*/
+static void bench_mpn_mul() {
+    mpn_manager m;
+    random_gen r(0);
+    unsigned_vector a, b, c;
+    for (unsigned n : { 8u, 32u, 128u, 512u, 2048u }) {
+        unsigned rounds = std::max(1u, (1u << 22) / (n * n));
+        mk_random_digits(r, n, a);
+        mk_random_digits(r, n, b);
+        c.resize(2 * n);
+        stopwatch sw1, sw2;
+        sw1.start();
+        for (unsigned i = 0; i < rounds; ++i)
+            ref_mul(a.data(), n, b.data(), n, c.data());
+        sw1.stop();
+        sw2.start();
+        for (unsigned i = 0; i < rounds; ++i)
+            m.mul(a.data(), n, b.data(), n, c.data());
+        sw2.stop();
+        std::cout << "mul " << n << "x" << n << " digits, " << rounds << " rounds: reference " << sw1.get_seconds() 
+                  << "s mpn " << sw2.get_seconds() << "s\n";
+    }
+}
+
+/**
+   \brief Timing of mpz/mpq operations on large operands.
+*/
+static void bench_mpz_ops() {
+    unsynch_mpz_manager m;
+    unsynch_mpq_manager qm;
+    scoped_mpz a(m), b(m), c(m), d(m);
+    scoped_mpq x(qm), y(qm), z(qm);
+    for (unsigned pw : { 256u, 1024u, 2048u }) {
+        m.power(mpz(3), pw, a);
+        m.power(mpz(7), pw / 2, b);
+        m.inc(b);
+        stopwatch sw;
+        sw.start();
+        for (unsigned i = 0; i < 50; ++i) {
+            m.mul(a, b, c);
+            m.div(c, b, d);
+            ENSURE(m.eq(d, a));
+            m.add(c, a, d);
+            m.sub(d, a, d);
+            ENSURE(m.eq(d, c));
+            m.gcd(a, b, d);
+        }
+        qm.set(x, a, b);
+        qm.set(y, b, a);
+        for (unsigned i = 0; i < 50; ++i) {
+            qm.mul(x, y, z);
+            qm.add(z, x, z);
+        }
+        sw.stop();
+        std::cout << "mpz/mpq 3^" << pw << " ops: " << sw.get_seconds() << "s\n";
+    }
+}
+
 void tst_mpz() {
     disable_trace("mpz");
+    tst_mpn_kernels();
+    bench_mpn_mul();
+    bench_mpz_ops();
     enable_trace("mpz_2k");
     tst_pw2();
     tst5();
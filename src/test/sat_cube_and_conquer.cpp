@@ -0,0 +1,102 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    sat_cube_and_conquer.cpp
+
+Abstract:
+
+    Tests for the cube and conquer driver on random 3-SAT instances.
+    The result is compared with the plain CDCL solver.
+    Unsatisfiable instances are combined with a satisfiable component
+    over separate variables. Cube literals of that component are not
+    part of the cores of refuted cubes, so the workers refute cubes
+    and later cubes that contain a core are pruned.
+
+--*/
+#include "sat/sat_solver.h"
+#include "sat/sat_cube_and_conquer.h"
+#include "test/sat_random_cnf.h"
+#include "util/statistics.h"
+#include <cstring>
+#include <iostream>
+
+static unsigned get_stat(statistics const& st, char const* key) {
+    unsigned r = 0;
+    for (unsigned i = 0; i < st.size(); ++i)
+        if (st.is_uint(i) && strcmp(st.get_key(i), key) == 0)
+            r += st.get_uint_value(i);
+    return r;
+}
+
+static void tst_cube_and_conquer(unsigned num_vars, unsigned num_clauses, unsigned seed, unsigned num_workers) {
+    params_ref p;
+    p.set_uint("lookahead.cube.depth", 4);
+    reslimit limit1, limit2;
+    sat::solver s1(p, limit1), s2(p, limit2);
+    vector<sat::literal_vector> clauses;
+    mk_random_3sat(s1, num_vars, num_clauses, seed, clauses);
+    clauses.reset();
+    mk_random_3sat(s2, num_vars, num_clauses, seed, clauses);
+
+    lbool expected = s1.check();
+    sat::cube_and_conquer cc(s2, num_workers);
+    unsigned num_decided = 0;
+    std::function<void(sat::cube_and_conquer::cube_info const&)> on_cube =
+        [&](sat::cube_and_conquer::cube_info const& info) {
+        ENSURE(info.m_size <= 4);
+        ++num_decided;
+    };
+    cc.set(on_cube);
+    lbool r = cc();
+    std::cout << "cube and conquer " << num_vars << " " << num_clauses << " workers " << num_workers 
+              << " expected " << expected << " result " << r << " cubes decided " << num_decided << "\n";
+    ENSURE(r == expected);
+    if (r == l_true)
+        ENSURE(satisfies_all(s2, clauses));
+}
+
+/**
+   \brief solve an unsatisfiable random instance over 150 variables together
+   with a satisfiable one over another 150 variables. 
+   Return the number of pruned cubes.
+*/
+static unsigned tst_cube_and_conquer_cores(unsigned seed, unsigned num_workers) {
+    params_ref p;
+    p.set_uint("lookahead.cube.depth", 4);
+    reslimit limit;
+    sat::solver s(p, limit);
+    vector<sat::literal_vector> clauses;
+    mk_random_3sat(s, 150, 700, seed, clauses);
+    mk_random_3sat(s, 150, 570, seed + 1, clauses);
+
+    sat::cube_and_conquer cc(s, num_workers);
+    lbool r = cc();
+    statistics st;
+    cc.collect_statistics(st);
+    unsigned num_refuted = get_stat(st, "cube-and-conquer refuted");
+    unsigned num_pruned = get_stat(st, "cube-and-conquer pruned");
+    std::cout << "cube and conquer cores seed " << seed << " workers " << num_workers << " result " << r 
+              << " cubes " << get_stat(st, "cube-and-conquer cubes") << " refuted " << num_refuted 
+              << " pruned " << num_pruned << "\n";
+    ENSURE(r == l_false);
+    ENSURE(num_refuted > 0);
+    return num_pruned;
+}
+
+void tst_sat_cube_and_conquer() {
+    // below and above the satisfiability threshold of random 3-SAT
+    tst_cube_and_conquer(60, 200, 1, 1);
+    tst_cube_and_conquer(60, 200, 1, 3);
+    tst_cube_and_conquer(150, 700, 2, 1);
+    tst_cube_and_conquer(150, 700, 2, 3);
+    tst_cube_and_conquer(80, 400, 5, 4);
+
+    // a single worker records the core of each cube before it takes the next cube.
+    unsigned num_pruned = 0;
+    for (unsigned seed = 1; seed <= 4; ++seed)
+        num_pruned += tst_cube_and_conquer_cores(seed, 1);
+    ENSURE(num_pruned > 0);
+    tst_cube_and_conquer_cores(1, 3);
+}
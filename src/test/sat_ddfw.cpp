@@ -0,0 +1,84 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    sat_ddfw.cpp
+
+Abstract:
+
+    Tests for the ddfw local search and for the exchange of best
+    assignments between ddfw threads.
+
+--*/
+#include "sat/sat_solver.h"
+#include "sat/sat_ddfw.h"
+#include "util/statistics.h"
+#include "util/util.h"
+#include <iostream>
+
+static void tst_ddfw_shared() {
+    sat::ddfw_shared shared(100);
+    bool_vector a(100, false), b(100, true), c(100, false);
+    unsigned seq = 0;
+    ENSURE(!shared.fetch(seq, c));
+    a[3] = a[64] = a[99] = true;
+    ENSURE(shared.publish(10, a));
+    ENSURE(shared.best() == 10);
+    // only strictly better assignments are published
+    ENSURE(!shared.publish(10, b));
+    ENSURE(shared.fetch(seq, c));
+    ENSURE(c == a);
+    ENSURE(!shared.fetch(seq, c));
+    ENSURE(shared.publish(2, b));
+    ENSURE(shared.fetch(seq, c));
+    ENSURE(c == b);
+}
+
+static void tst_ddfw_planted(unsigned num_vars, unsigned num_clauses, unsigned seed) {
+    reslimit limit;
+    params_ref p;
+    sat::solver s(p, limit);
+    random_gen r(seed);
+    bool_vector planted;
+    for (unsigned v = 0; v < num_vars; ++v) {
+        s.mk_var();
+        planted.push_back(r(2) == 0);
+    }
+    vector<sat::literal_vector> clauses;
+    while (clauses.size() < num_clauses) {
+        sat::literal_vector cls;
+        for (unsigned i = 0; i < 3; ++i)
+            cls.push_back(sat::literal(r(num_vars), r(2) == 0));
+        bool sat = false;
+        for (sat::literal l : cls)
+            sat |= planted[l.var()] != l.sign();
+        if (!sat || cls[0].var() == cls[1].var() || cls[0].var() == cls[2].var() || cls[1].var() == cls[2].var())
+            continue;
+        s.mk_clause(cls.size(), cls.data());
+        clauses.push_back(cls);
+    }
+    sat::ddfw d;
+    d.updt_params(p);
+    // a different seed than the generator, otherwise the initial assignment is the planted one.
+    d.set_seed(seed + 17);
+    d.add(s);
+    lbool res = d.check(0, nullptr, nullptr);
+    statistics st;
+    d.collect_statistics(st);
+    st.display(std::cout);
+    ENSURE(res == l_true);
+    sat::model const& mdl = d.get_model();
+    for (auto const& cls : clauses) {
+        bool sat = false;
+        for (sat::literal l : cls)
+            sat |= mdl[l.var()] == (l.sign() ? l_false : l_true);
+        ENSURE(sat);
+    }
+}
+
+void tst_sat_ddfw() {
+    tst_ddfw_shared();
+    tst_ddfw_planted(200, 600, 1);
+    tst_ddfw_planted(500, 1800, 3);
+}
@@ -0,0 +1,73 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    sat_parallel.cpp
+
+Abstract:
+
+    Scaling benchmark for the parallel SAT portfolio.
+
+    Usage: test-z3 sat_parallel <file.cnf> [max_threads] [max_conflicts]
+
+    Runs the portfolio with 1, 2, 4, ... up to max_threads threads and
+    reports the conflict rate of the solver that finished first.
+    Contention on shared state shows up as a drop of the per-thread rate.
+
+--*/
+#include "sat/sat_solver.h"
+#include "sat/dimacs.h"
+#include "util/statistics.h"
+#include "util/stopwatch.h"
+#include "util/error_codes.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+
+static unsigned get_conflicts(sat::solver const& s) {
+    statistics st;
+    s.collect_statistics(st);
+    for (unsigned i = 0; i < st.size(); ++i)
+        if (st.is_uint(i) && strcmp(st.get_key(i), "sat conflicts") == 0)
+            return st.get_uint_value(i);
+    return 0;
+}
+
+void tst_sat_parallel(char ** argv, int argc, int& i) {
+    if (argc < i + 2) {
+        std::cout << "require dimacs file name\n";
+        return;
+    }
+    char const* file_name = argv[i + 1];
+    unsigned max_threads = 8, max_conflicts = 50000;
+    ++i;
+    if (i + 1 < argc)
+        max_threads = atoi(argv[++i]);
+    if (i + 1 < argc)
+        max_conflicts = atoi(argv[++i]);
+
+    std::cout << "threads  result  time(s)  conflicts/sec/thread  conflicts/sec\n";
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        reslimit limit;
+        params_ref params;
+        params.set_uint("threads", threads);
+        params.set_uint("max_conflicts", max_conflicts);
+        sat::solver solver(params, limit);
+        std::ifstream in(file_name);
+        if (in.bad() || in.fail()) {
+            std::cerr << "(error \"failed to open file '" << file_name << "'\")" << std::endl;
+            exit(ERR_OPEN_FILE);
+        }
+        if (!parse_dimacs(in, std::cerr, solver))
+            return;
+
+        stopwatch sw;
+        sw.start();
+        lbool r = solver.check();
+        sw.stop();
+        double secs = sw.get_seconds();
+        double rate = secs > 0 ? get_conflicts(solver) / secs : 0;
+        std::cout << threads << "  " << r << "  " << secs << "  " << rate << "  " << rate * threads << "\n";
+    }
+}
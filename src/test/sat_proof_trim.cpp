@@ -0,0 +1,109 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    sat_proof_trim.cpp
+
+Abstract:
+
+    Tests for proof trimming. DRAT proofs with known cores are replayed
+    in the trimmer, as the DRAT front-end does with drat.trim=true, and
+    the core steps are compared with the expected ones.
+
+--*/
+#include "sat/sat_proof_trim.h"
+#include "sat/dimacs.h"
+#include <iostream>
+#include <sstream>
+
+/**
+   Replay a DRAT proof with 'i' lines for input clauses.
+   Steps are numbered from 1 in the order they occur in the proof.
+   Return the steps in the core.
+*/
+static unsigned_vector trim_proof(std::string const& proof, unsigned num_threads) {
+    params_ref p;
+    p.set_uint("threads", num_threads);
+    reslimit lim;
+    sat::proof_trim trim(p, lim);
+    std::istringstream in(proof);
+    dimacs::drat_parser drat(in, std::cerr);
+    unsigned id = 0;
+    for (auto const& r : drat) {
+        trim.init_clause();
+        for (sat::literal lit : r.m_lits) {
+            while (lit.var() >= trim.num_vars())
+                trim.mk_var();
+            trim.add_literal(lit.var(), lit.sign());
+        }
+        ++id;
+        if (r.m_status.is_deleted())
+            trim.del();
+        else if (r.m_status.is_input())
+            trim.assume(id);
+        else
+            trim.infer(id);
+    }
+    ENSURE(trim.has_empty_clause());
+    unsigned_vector core;
+    for (auto const& [step, deps] : trim.trim())
+        core.push_back(step);
+    return core;
+}
+
+static void tst_trim_small() {
+    // 1-4 refute x1, 5-6 and the lemma 7 are not needed,
+    // the lemma 9 (x1) follows from 1 and 2 and conflicts with 3 and 4.
+    // The deletion after the empty clause is ignored.
+    std::string proof =
+        "i 1 2 0\n"
+        "i 1 -2 0\n"
+        "i -1 3 0\n"
+        "i -1 -3 0\n"
+        "i 4 5 0\n"
+        "i -4 5 0\n"
+        "5 0\n"
+        "d 4 5 0\n"
+        "1 0\n"
+        "0\n"
+        "d 1 2 0\n";
+    unsigned_vector core = trim_proof(proof, 1);
+    std::cout << "trim core " << core << "\n";
+    unsigned expected[6] = { 1, 2, 3, 4, 9, 10 };
+    ENSURE(core == unsigned_vector(6, expected));
+}
+
+/**
+   A chain of n implications followed by the unit p1 puts n literals on the
+   trail before x is derived, so the trail position of the lemma x is searched
+   in chunks when the trail is long enough. The unit comes after the chain,
+   so trimming removes the chain from the trail in one step.
+*/
+static void tst_trim_long_trail(unsigned n) {
+    std::ostringstream strm;
+    for (unsigned i = 1; i < n; ++i)
+        strm << "i -" << i << " " << (i + 1) << " 0\n";
+    strm << "i 1 0\n";
+    unsigned x = n + 1, u = n + 2, w = n + 3;
+    strm << "i " << x << " " << u << " 0\n";
+    strm << "i " << x << " -" << u << " 0\n";
+    strm << "i -" << x << " " << w << " 0\n";
+    strm << "i -" << x << " -" << w << " 0\n";
+    strm << x << " 0\n";
+    strm << "0\n";
+    unsigned_vector expected;
+    for (unsigned i = 1; i <= 6; ++i)
+        expected.push_back(n + i);
+    for (unsigned num_threads : { 1, 4 }) {
+        unsigned_vector core = trim_proof(strm.str(), num_threads);
+        std::cout << "trim long trail " << n << " threads " << num_threads << " core " << core << "\n";
+        ENSURE(core == expected);
+    }
+}
+
+void tst_sat_proof_trim() {
+    tst_trim_small();
+    tst_trim_long_trail(100);
+    tst_trim_long_trail(40000);
+}
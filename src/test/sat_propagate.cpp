@@ -0,0 +1,90 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    sat_propagate.cpp
+
+Abstract:
+
+    Benchmark for unit propagation throughput of the SAT core.
+
+    Usage: test-z3 sat_propagate <file.cnf> [max_conflicts]
+
+    Reports propagations per second together with the size of
+    the watch lists, so that runs against different watch layouts
+    can be compared on the same DIMACS input.
+
+--*/
+#include "sat/sat_solver.h"
+#include "sat/sat_watched.h"
+#include "sat/dimacs.h"
+#include "util/statistics.h"
+#include "util/stopwatch.h"
+#include "util/error_codes.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+
+static unsigned get_stat(statistics const& st, char const* key) {
+    for (unsigned i = 0; i < st.size(); ++i)
+        if (st.is_uint(i) && strcmp(st.get_key(i), key) == 0)
+            return st.get_uint_value(i);
+    return 0;
+}
+
+void tst_sat_propagate(char ** argv, int argc, int& i) {
+    if (argc < i + 2) {
+        std::cout << "require dimacs file name\n";
+        return;
+    }
+    char const* file_name = argv[i + 1];
+    unsigned max_conflicts = 100000;
+    ++i;
+    if (i + 1 < argc) {
+        max_conflicts = atoi(argv[i + 1]);
+        ++i;
+    }
+
+    reslimit limit;
+    params_ref params;
+    params.set_uint("max_conflicts", max_conflicts);
+    sat::solver solver(params, limit);
+    {
+        std::ifstream in(file_name);
+        if (in.bad() || in.fail()) {
+            std::cerr << "(error \"failed to open file '" << file_name << "'\")" << std::endl;
+            exit(ERR_OPEN_FILE);
+        }
+        if (!parse_dimacs(in, std::cerr, solver))
+            return;
+    }
+
+    size_t num_watches = 0;
+    for (unsigned v = 0; v < solver.num_vars(); ++v) {
+        num_watches += solver.get_wlist(sat::literal(v, false)).size();
+        num_watches += solver.get_wlist(sat::literal(v, true)).size();
+    }
+
+    stopwatch sw;
+    sw.start();
+    lbool r = solver.check();
+    sw.stop();
+
+    statistics st;
+    solver.collect_statistics(st);
+    double props =
+        (double)get_stat(st, "sat propagations 2ary") +
+        (double)get_stat(st, "sat propagations 3ary") +
+        (double)get_stat(st, "sat propagations nary");
+    double secs = sw.get_seconds();
+
+    std::cout << "result:              " << r << "\n";
+    std::cout << "watch entry size:    " << sizeof(sat::watched) << " bytes\n";
+    std::cout << "initial watches:     " << num_watches << " (" << (num_watches * sizeof(sat::watched)) / 1024 << " KB)\n";
+    std::cout << "conflicts:           " << get_stat(st, "sat conflicts") << "\n";
+    std::cout << "propagations:        " << props << "\n";
+    std::cout << "time:                " << secs << " s\n";
+    if (secs > 0)
+        std::cout << "propagations/sec:    " << props / secs << "\n";
+}
@@ -0,0 +1,43 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    sat_random_cnf.cpp
+
+Abstract:
+
+    Random CNF instances shared by the SAT solver tests.
+
+--*/
+#include "test/sat_random_cnf.h"
+#include "util/util.h"
+
+void mk_random_3sat(sat::solver& s, unsigned num_vars, unsigned num_clauses, unsigned seed, vector<sat::literal_vector>& clauses) {
+    random_gen r(seed);
+    unsigned first = s.num_vars();
+    for (unsigned v = 0; v < num_vars; ++v)
+        s.mk_var();
+    for (unsigned n = 0; n < num_clauses; ) {
+        sat::literal_vector cls;
+        for (unsigned i = 0; i < 3; ++i)
+            cls.push_back(sat::literal(first + r(num_vars), r(2) == 0));
+        if (cls[0].var() == cls[1].var() || cls[0].var() == cls[2].var() || cls[1].var() == cls[2].var())
+            continue;
+        s.mk_clause(cls.size(), cls.data());
+        clauses.push_back(cls);
+        ++n;
+    }
+}
+
+bool satisfies_all(sat::solver& s, vector<sat::literal_vector> const& clauses) {
+    sat::model const& mdl = s.get_model();
+    for (auto const& cls : clauses) {
+        bool sat = false;
+        for (sat::literal l : cls)
+            sat |= mdl[l.var()] == (l.sign() ? l_false : l_true);
+        if (!sat)
+            return false;
+    }
+    return true;
+}
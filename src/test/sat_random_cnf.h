@@ -0,0 +1,26 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    sat_random_cnf.h
+
+Abstract:
+
+    Random CNF instances shared by the SAT solver tests.
+
+--*/
+#pragma once
+
+#include "sat/sat_solver.h"
+
+/**
+   \brief add num_vars fresh variables and num_clauses random 3-clauses over them to s.
+   The clauses are also appended to \c clauses.
+*/
+void mk_random_3sat(sat::solver& s, unsigned num_vars, unsigned num_clauses, unsigned seed, vector<sat::literal_vector>& clauses);
+
+/**
+   \brief return true if the model of s satisfies all clauses.
+*/
+bool satisfies_all(sat::solver& s, vector<sat::literal_vector> const& clauses);
@@ -0,0 +1,70 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    sat_restart.cpp
+
+Abstract:
+
+    Tests for trail reuse on restarts and chronological backtracking
+    on random 3-SAT instances. The result is compared with the default
+    configuration, and the levels and propagations that were kept are
+    reported.
+
+--*/
+#include "sat/sat_solver.h"
+#include "test/sat_random_cnf.h"
+#include "util/statistics.h"
+#include <cstring>
+#include <iostream>
+
+static unsigned get_stat(statistics const& st, char const* key) {
+    unsigned r = 0;
+    for (unsigned i = 0; i < st.size(); ++i)
+        if (st.is_uint(i) && strcmp(st.get_key(i), key) == 0)
+            r += st.get_uint_value(i);
+    return r;
+}
+
+static lbool solve(unsigned num_vars, unsigned num_clauses, unsigned seed, bool reuse, statistics& st) {
+    params_ref p;
+    if (reuse) {
+        p.set_bool("restart.reuse_trail", true);
+        p.set_uint("backtrack.conflicts", 0);
+        p.set_uint("backtrack.scopes", 2);
+    }
+    reslimit limit;
+    sat::solver s(p, limit);
+    vector<sat::literal_vector> clauses;
+    mk_random_3sat(s, num_vars, num_clauses, seed, clauses);
+    lbool r = s.check();
+    s.collect_statistics(st);
+    if (r == l_true)
+        ENSURE(satisfies_all(s, clauses));
+    return r;
+}
+
+static void tst_restart_reuse(unsigned num_vars, unsigned num_clauses, unsigned seed, unsigned& reused, unsigned& saved) {
+    statistics st1, st2;
+    lbool expected = solve(num_vars, num_clauses, seed, false, st1);
+    lbool r = solve(num_vars, num_clauses, seed, true, st2);
+    unsigned num_reused = get_stat(st2, "sat reused levels");
+    unsigned num_saved = get_stat(st2, "sat saved propagations");
+    std::cout << "restart reuse " << num_vars << " " << num_clauses << " expected " << expected << " result " << r
+              << " reused levels " << num_reused << " saved propagations " << num_saved
+              << " (default " << get_stat(st1, "sat saved propagations") << ")\n";
+    ENSURE(r == expected);
+    reused += num_reused;
+    saved += num_saved;
+}
+
+void tst_sat_restart() {
+    unsigned reused = 0, saved = 0;
+    // below, at and above the satisfiability threshold of random 3-SAT
+    tst_restart_reuse(120, 480, 1, reused, saved);
+    tst_restart_reuse(150, 640, 2, reused, saved);
+    tst_restart_reuse(150, 700, 3, reused, saved);
+    ENSURE(reused > 0);
+    ENSURE(saved > 0);
+}
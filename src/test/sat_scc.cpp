@@ -0,0 +1,130 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    sat_scc.cpp
+
+Abstract:
+
+    Tests for SCC based equivalence reduction. Instances with many
+    equivalent literals are reduced sequentially and with several threads,
+    and the results are compared. Instances with a planted solution are
+    satisfiable, and their models are checked against the input clauses.
+    Exceptions raised while processing a chunk of parallel_for are
+    rethrown on the calling thread.
+
+--*/
+#include "sat/sat_solver.h"
+#include "sat/sat_parallel_for.h"
+#include "util/statistics.h"
+#include "util/util.h"
+#include <atomic>
+#include <iostream>
+
+static void add_clause(sat::solver& s, vector<sat::literal_vector>& clauses, std::initializer_list<sat::literal> const& lits) {
+    sat::literal_vector cls;
+    for (sat::literal l : lits)
+        cls.push_back(l);
+    s.mk_clause(cls.size(), cls.data());
+    clauses.push_back(cls);
+}
+
+/**
+   With planted, the literals of each group are true in a random assignment
+   of the groups, and only random clauses that this assignment satisfies are added.
+*/
+static void mk_instance(sat::solver& s, unsigned num_vars, unsigned num_bin, unsigned num_ter, unsigned seed, bool planted, vector<sat::literal_vector>& clauses) {
+    random_gen r(seed);
+    for (unsigned v = 0; v < num_vars; ++v)
+        s.mk_var();
+    bool_vector value(num_vars, false);
+    auto is_true = [&](sat::literal l) { return value[l.var()] != l.sign(); };
+    // implication cycles over groups of 4 variables make the group equivalent
+    for (unsigned v = 0; v + 4 <= num_vars; v += 4) {
+        sat::literal lits[4];
+        bool group_value = r(2) == 0;
+        for (unsigned i = 0; i < 4; ++i) {
+            lits[i] = sat::literal(v + i, r(2) == 0);
+            value[v + i] = group_value != lits[i].sign();
+        }
+        for (unsigned i = 0; i < 4; ++i)
+            add_clause(s, clauses, { ~lits[i], lits[(i + 1) % 4] });
+    }
+    for (unsigned i = 0; i < num_bin; ++i) {
+        sat::literal a(r(num_vars), r(2) == 0), b(r(num_vars), r(2) == 0);
+        if (a.var() != b.var() && (!planted || is_true(a) || is_true(b)))
+            add_clause(s, clauses, { a, b });
+    }
+    for (unsigned i = 0; i < num_ter; ++i) {
+        sat::literal a(r(num_vars), r(2) == 0), b(r(num_vars), r(2) == 0), c(r(num_vars), r(2) == 0);
+        if (a.var() != b.var() && a.var() != c.var() && b.var() != c.var() && (!planted || is_true(a) || is_true(b) || is_true(c)))
+            add_clause(s, clauses, { a, b, c });
+    }
+}
+
+static void tst_scc(unsigned num_vars, unsigned num_bin, unsigned num_ter, unsigned seed, bool planted = false) {
+    unsigned elim[2] = { 0, 0 };
+    lbool result[2] = { l_undef, l_undef };
+    for (unsigned k = 0; k < 2; ++k) {
+        params_ref p;
+        p.set_uint("scc.threads", k == 0 ? 1 : 4);
+        reslimit limit;
+        sat::solver s(p, limit);
+        vector<sat::literal_vector> clauses;
+        mk_instance(s, num_vars, num_bin, num_ter, seed, planted, clauses);
+        elim[k] = s.scc_bin();
+        result[k] = s.check();
+        if (result[k] == l_true) {
+            sat::model const& mdl = s.get_model();
+            for (auto const& cls : clauses) {
+                bool sat = false;
+                for (sat::literal l : cls)
+                    sat |= mdl[l.var()] == (l.sign() ? l_false : l_true);
+                ENSURE(sat);
+            }
+        }
+    }
+    std::cout << "scc " << num_vars << " " << num_bin << " " << num_ter << " elim " << elim[0] << " " << elim[1] 
+              << " result " << result[0] << " " << result[1] << "\n";
+    ENSURE(elim[0] == elim[1]);
+    ENSURE(result[0] == result[1]);
+    if (planted) {
+        ENSURE(elim[0] > 0);
+        ENSURE(result[0] == l_true);
+    }
+}
+
+static void tst_parallel_for_exception() {
+    for (unsigned failing : { 0u, 3u }) {
+        std::atomic<unsigned> num_done(0);
+        bool caught = false;
+        try {
+            sat::parallel_for(4, 100, [&](unsigned begin, unsigned end) {
+                if (begin <= failing && failing < end)
+                    throw default_exception("chunk failed");
+                num_done += end - begin;
+            });
+        }
+        catch (default_exception& ex) {
+            caught = true;
+            ENSURE(std::string(ex.msg()) == "chunk failed");
+        }
+        ENSURE(caught);
+#ifndef SINGLE_THREAD
+        // the other three chunks of 25 are completed.
+        ENSURE(num_done == 75);
+#endif
+    }
+}
+
+void tst_sat_scc() {
+    tst_parallel_for_exception();
+    tst_scc(100, 20, 200, 1);
+    tst_scc(20000, 4000, 40000, 2);
+    tst_scc(40000, 30000, 60000, 3);
+    tst_scc(40000, 44000, 60000, 4);
+    // satisfiable, above the size at which SCCs and clauses are processed in parallel
+    tst_scc(40000, 30000, 60000, 5, true);
+    tst_scc(40000, 60000, 100000, 6, true);
+}
@@ -0,0 +1,60 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    sat_simplifier.cpp
+
+Abstract:
+
+    Tests for bounded variable elimination during in-processing.
+    Variables that produced too many resolvents are not resolved again
+    in later rounds when their occurrences did not change.
+
+--*/
+#include "sat/sat_solver.h"
+#include "test/sat_random_cnf.h"
+#include "util/statistics.h"
+#include <cstring>
+#include <iostream>
+
+static unsigned get_stat(statistics const& st, char const* key) {
+    unsigned r = 0;
+    for (unsigned i = 0; i < st.size(); ++i)
+        if (st.is_uint(i) && strcmp(st.get_key(i), key) == 0)
+            r += st.get_uint_value(i);
+    return r;
+}
+
+static lbool solve(unsigned num_vars, unsigned num_clauses, unsigned seed, bool elim_vars, statistics& st) {
+    params_ref p;
+    p.set_bool("elim_vars", elim_vars);
+    p.set_uint("next_simplify", 200);
+    reslimit limit;
+    sat::solver s(p, limit);
+    vector<sat::literal_vector> clauses;
+    mk_random_3sat(s, num_vars, num_clauses, seed, clauses);
+    lbool r = s.check();
+    s.collect_statistics(st);
+    if (r == l_true)
+        ENSURE(satisfies_all(s, clauses));
+    return r;
+}
+
+static void tst_elim_vars_skipped(unsigned num_vars, unsigned num_clauses, unsigned seed) {
+    statistics st1, st2;
+    lbool expected = solve(num_vars, num_clauses, seed, false, st1);
+    lbool r = solve(num_vars, num_clauses, seed, true, st2);
+    unsigned rounds = get_stat(st2, "sat elim var rounds");
+    unsigned skipped = get_stat(st2, "sat elim var skipped");
+    std::cout << "elim vars " << num_vars << " " << num_clauses << " expected " << expected << " result " << r
+              << " rounds " << rounds << " skipped " << skipped << "\n";
+    ENSURE(r == expected);
+    ENSURE(rounds >= 2);
+    ENSURE(skipped > 0);
+}
+
+void tst_sat_simplifier() {
+    tst_elim_vars_skipped(150, 640, 1);
+    tst_elim_vars_skipped(150, 700, 2);
+}
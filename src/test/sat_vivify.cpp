@@ -0,0 +1,54 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    sat_vivify.cpp
+
+Abstract:
+
+    Tests for vivification of learned clauses on random 3-SAT instances.
+    In-processing is triggered early so that learned clauses get vivified,
+    and the result is compared with a solver that neither vivifies nor
+    keeps learned clauses by glue tier.
+
+--*/
+#include "sat/sat_solver.h"
+#include "test/sat_random_cnf.h"
+#include "util/statistics.h"
+#include <iostream>
+
+static lbool solve(unsigned num_vars, unsigned num_clauses, unsigned seed, bool vivify, statistics& st) {
+    params_ref p;
+    p.set_bool("vivify", vivify);
+    p.set_bool("gc.tiers", vivify);
+    p.set_uint("next_simplify", 200);
+    p.set_uint("gc.initial", 300);
+    reslimit limit;
+    sat::solver s(p, limit);
+    vector<sat::literal_vector> clauses;
+    mk_random_3sat(s, num_vars, num_clauses, seed, clauses);
+    lbool r = s.check();
+    s.collect_statistics(st);
+    if (r == l_true)
+        ENSURE(satisfies_all(s, clauses));
+    return r;
+}
+
+static void tst_vivify(unsigned num_vars, unsigned num_clauses, unsigned seed) {
+    statistics st1, st2;
+    lbool expected = solve(num_vars, num_clauses, seed, false, st1);
+    lbool r = solve(num_vars, num_clauses, seed, true, st2);
+    std::cout << "vivify " << num_vars << " " << num_clauses << " expected " << expected << " result " << r << "\n";
+    st2.display(std::cout);
+    ENSURE(r == expected);
+}
+
+void tst_sat_vivify() {
+    // below, at and above the satisfiability threshold of random 3-SAT
+    tst_vivify(120, 480, 1);
+    tst_vivify(150, 640, 2);
+    tst_vivify(150, 640, 3);
+    tst_vivify(120, 560, 4);
+    tst_vivify(200, 860, 7);
+}
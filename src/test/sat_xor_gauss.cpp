@@ -0,0 +1,129 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    sat_xor_gauss.cpp
+
+Abstract:
+
+    Tests for Gauss-Jordan elimination on bit matrices and
+    a benchmark on parity-chain CNFs with and without xor.gauss,
+    and with a matrix size limit that skips the elimination.
+
+--*/
+#include "math/simplex/bit_matrix.h"
+#include "sat/sat_solver.h"
+#include "util/stopwatch.h"
+#include "util/util.h"
+#include <iostream>
+
+static void tst_bit_matrix_solve() {
+    // x0 + x1 = 1, x1 + x2 = 0, x0 + x2 + x70 = 1, x70 + x130 = 1
+    // columns 0..130, column 131 is the right-hand side
+    bit_matrix bm;
+    bm.reset(132);
+    auto r1 = bm.add_row(); r1.set(0); r1.set(1); r1.set(131);
+    auto r2 = bm.add_row(); r2.set(1); r2.set(2);
+    auto r3 = bm.add_row(); r3.set(0); r3.set(2); r3.set(70); r3.set(131);
+    auto r4 = bm.add_row(); r4.set(70); r4.set(130); r4.set(131);
+    bm.solve();
+    // every pivot occurs in exactly one row.
+    unsigned_vector pivots;
+    for (auto const& r : bm) {
+        if (r.is_zero())
+            continue;
+        unsigned c = r.first();
+        ENSURE(c < 131);
+        pivots.push_back(c);
+    }
+    for (unsigned c : pivots) {
+        unsigned n = 0;
+        for (auto const& r : bm)
+            n += r[c];
+        ENSURE(n == 1);
+    }
+    // x70 = 0, x130 = 1 are determined.
+    for (auto const& r : bm) {
+        if (r.first() == 70) {
+            unsigned n = 0;
+            for (unsigned c : r) 
+                n += c != 131;
+            ENSURE(n == 1 && !r[131]);
+        }
+        if (r.first() == 130) 
+            ENSURE(r[131]);
+    }
+}
+
+static void add_xor(sat::solver& s, sat::bool_var a, sat::bool_var b, sat::bool_var c, bool parity) {
+    for (unsigned m = 0; m < 8; ++m) {
+        bool pa = m & 1, pb = (m >> 1) & 1, pc = (m >> 2) & 1;
+        if ((pa ^ pb ^ pc) == parity)
+            continue;
+        // block the assignment a = pa, b = pb, c = pc
+        sat::literal lits[3] = { sat::literal(a, pa), sat::literal(b, pb), sat::literal(c, pc) };
+        s.mk_clause(3, lits);
+    }
+}
+
+/**
+   Two parity chains over the same variables x_0 .. x_{n-1},
+   visited in different orders. The chains agree on the parity of
+   the variables if \c sat holds, otherwise the formula is unsatisfiable.
+*/
+static void mk_parity_chains(sat::solver& s, unsigned n, bool sat, random_gen& rand) {
+    sat::bool_var_vector xs;
+    for (unsigned i = 0; i < n; ++i)
+        xs.push_back(s.mk_var());
+    for (unsigned chain = 0; chain < 2; ++chain) {
+        sat::bool_var_vector order(xs);
+        shuffle(order.size(), order.data(), rand);
+        sat::bool_var acc = order[0];
+        for (unsigned i = 1; i < n; ++i) {
+            sat::bool_var t = s.mk_var();
+            add_xor(s, acc, order[i], t, false);
+            acc = t;
+        }
+        sat::literal lit(acc, chain == 1 && !sat);
+        s.mk_clause(1, &lit);
+    }
+}
+
+static lbool solve_parity_chains(unsigned n, bool sat, bool gauss, unsigned seed, double& secs, unsigned max_cells = 100000000) {
+    reslimit limit;
+    params_ref p;
+    p.set_bool("xor.gauss", gauss);
+    p.set_uint("xor.gauss.max_cells", max_cells);
+    p.set_uint("max_conflicts", 1000000);
+    sat::solver s(p, limit);
+    random_gen rand(seed);
+    mk_parity_chains(s, n, sat, rand);
+    stopwatch sw;
+    sw.start();
+    lbool r = s.check();
+    sw.stop();
+    secs = sw.get_seconds();
+    return r;
+}
+
+static void tst_parity_chains() {
+    for (unsigned n : { 8, 16, 24 }) {
+        for (bool gauss : { false, true }) {
+            double t_sat = 0, t_unsat = 0;
+            ENSURE(l_true == solve_parity_chains(n, true, gauss, n, t_sat));
+            ENSURE(l_false == solve_parity_chains(n, false, gauss, n, t_unsat));
+            std::cout << "parity chain " << n << (gauss ? " gauss" : " cdcl ") 
+                      << " sat: " << t_sat << "s unsat: " << t_unsat << "s\n";
+        }
+    }
+    // systems above the size limit are left to search.
+    double t = 0;
+    ENSURE(l_true == solve_parity_chains(16, true, true, 3, t, 1));
+    ENSURE(l_false == solve_parity_chains(16, false, true, 3, t, 1));
+}
+
+void tst_sat_xor_gauss() {
+    tst_bit_matrix_solve();
+    tst_parity_chains();
+}
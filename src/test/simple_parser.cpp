@@ -25,6 +25,23 @@ Revision History:
 #include "parsers/util/cost_parser.h"
 
 
+static void check_compiled_cost(ast_manager & m, cost_parser & p, char const * str, bool affine) {
+    expr_ref r(m);
+    VERIFY(p.parse_string(str, r));
+    cost_evaluator eval(m);
+    compiled_cost cost(m);
+    cost.compile(r);
+    ENSURE(cost.is_affine() == affine);
+    float vals[2] = { 0.0f, 0.0f };
+    for (int x = -3; x <= 3; ++x) {
+        for (int y = -3; y <= 3; ++y) {
+            vals[0] = static_cast<float>(x);
+            vals[1] = static_cast<float>(y);
+            ENSURE(eval(r, 2, vals) == cost(2, vals));
+        }
+    }
+}
+
 void tst_simple_parser() {
     ast_manager    m;
     reg_decl_plugins(m);
@@ -60,5 +77,10 @@ void tst_simple_parser() {
     TRACE("simple_parser", 
           tout << mk_pp(r, m) << "\n";
           tout << "val: " << eval(r, 2, vals) << "\n";);
+    check_compiled_cost(m, p, "(+ x y)", true);
+    check_compiled_cost(m, p, "(+ x (* 10 (- y 2)))", true);
+    check_compiled_cost(m, p, "(+ x (* y x))", false);
+    check_compiled_cost(m, p, "(ite (and (> x 1) (<= y 2)) (/ x 2) (- 0 y))", false);
+    check_compiled_cost(m, p, "(ite (or (= x y) (not (< y 0))) 2 10)", false);
 }
 
@@ -0,0 +1,91 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    smt_cg_table.cpp
+
+Abstract:
+
+    Micro-benchmark for the congruence table on random UF instances.
+    Constants are merged in nested scopes and checked against
+    disequalities between unary and binary applications. Models of
+    satisfiable scopes are validated.
+
+--*/
+#include "smt/smt_context.h"
+#include "ast/reg_decl_plugins.h"
+#include "model/model.h"
+#include "util/stopwatch.h"
+#include "util/util.h"
+#include <iostream>
+
+static void tst_random_uf(unsigned num_consts, unsigned num_terms, unsigned num_scopes, unsigned seed) {
+    ast_manager m;
+    reg_decl_plugins(m);
+    smt_params params;
+    smt::context ctx(m, params);
+    random_gen r(seed);
+
+    sort_ref s(m.mk_uninterpreted_sort(symbol("U")), m);
+    sort * dom[2] = { s, s };
+    func_decl_ref f(m.mk_func_decl(symbol("f"), 1, dom, s), m);
+    func_decl_ref g(m.mk_func_decl(symbol("g"), 2, dom, s), m);
+
+    expr_ref_vector consts(m), terms(m);
+    for (unsigned i = 0; i < num_consts; ++i)
+        consts.push_back(m.mk_const(symbol(("c" + std::to_string(i)).c_str()), s));
+    auto rnd_const = [&]() { return consts.get(r(num_consts)); };
+    for (unsigned i = 0; i < num_terms; ++i) {
+        switch (r(3)) {
+        case 0: terms.push_back(m.mk_app(f, rnd_const())); break;
+        case 1: terms.push_back(m.mk_app(g, rnd_const(), rnd_const())); break;
+        default: terms.push_back(m.mk_app(g, m.mk_app(f, rnd_const()), rnd_const())); break;
+        }
+    }
+
+    // disequalities between applications are shared by all scopes.
+    expr_ref_vector asserted(m);
+    for (unsigned i = 0; i < num_terms / 8; ++i) {
+        expr_ref diseq(m.mk_not(m.mk_eq(terms.get(r(num_terms)), terms.get(r(num_terms)))), m);
+        ctx.assert_expr(diseq);
+        asserted.push_back(diseq);
+    }
+
+    stopwatch sw;
+    sw.start();
+    unsigned num_sat = 0, num_unsat = 0;
+    for (unsigned i = 0; i < num_scopes; ++i) {
+        ctx.push();
+        unsigned sz = asserted.size();
+        for (unsigned j = 0; j < num_consts / 4; ++j) {
+            expr_ref eq(m.mk_eq(rnd_const(), rnd_const()), m);
+            ctx.assert_expr(eq);
+            asserted.push_back(eq);
+        }
+        lbool res = ctx.check();
+        ENSURE(res != l_undef);
+        if (res == l_true) {
+            ++num_sat;
+            model_ref mdl;
+            ctx.get_model(mdl);
+            ENSURE(mdl);
+            for (expr * e : asserted)
+                ENSURE(mdl->is_true(e));
+        }
+        else
+            ++num_unsat;
+        ctx.pop(1);
+        asserted.shrink(sz);
+    }
+    sw.stop();
+    std::cout << "random uf consts: " << num_consts << " terms: " << num_terms
+              << " sat: " << num_sat << " unsat: " << num_unsat
+              << " time: " << sw.get_seconds() << "s\n";
+}
+
+void tst_smt_cg_table() {
+    tst_random_uf(50, 200, 20, 0);
+    tst_random_uf(200, 1000, 20, 1);
+    tst_random_uf(1000, 4000, 10, 2);
+}
@@ -0,0 +1,186 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    smt_quantifier.cpp
+
+Abstract:
+
+    Tests for quantifier instantiation in the SMT core.
+    E-matching code trees of quantifiers that are asserted again after
+    backtracking are reused. Model checking with several MBQI threads
+    produces the same result and the same clauses as a single thread.
+    Queued instances are ordered by cost and generation, and instances
+    that simplify to the same lemma are asserted once.
+
+--*/
+#include "smt/smt_context.h"
+#include "smt/qi_queue.h"
+#include "ast/reg_decl_plugins.h"
+#include "ast/arith_decl_plugin.h"
+#include "ast/ast_pp.h"
+#include "util/statistics.h"
+#include <cctype>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+static unsigned get_stat(statistics const& st, char const* key) {
+    unsigned r = 0;
+    for (unsigned i = 0; i < st.size(); ++i)
+        if (st.is_uint(i) && strcmp(st.get_key(i), key) == 0)
+            r += st.get_uint_value(i);
+    return r;
+}
+
+// forall x. f(g(x)) = x with the pattern f(g(x)) is asserted in several scopes.
+static void tst_code_tree_reuse() {
+    smt_params params;
+    params.m_mbqi = false;
+    ast_manager m;
+    reg_decl_plugins(m);
+    smt::context ctx(m, params);
+
+    sort * s = m.mk_uninterpreted_sort(symbol("S"));
+    func_decl_ref f(m.mk_func_decl(symbol("f"), 1, &s, s), m);
+    func_decl_ref g(m.mk_func_decl(symbol("g"), 1, &s, s), m);
+    expr_ref x(m.mk_var(0, s), m);
+    expr_ref fgx(m.mk_app(f, m.mk_app(g, x.get())), m);
+    app_ref pat(m.mk_pattern(to_app(fgx)), m);
+    expr * pats[1] = { pat.get() };
+    symbol name("x");
+    quantifier_ref q(m.mk_forall(1, &s, &name, m.mk_eq(fgx, x), 0, symbol("fg"), symbol::null, 1, pats), m);
+
+    for (unsigned i = 0; i < 3; ++i) {
+        expr_ref a(m.mk_fresh_const("a", s), m);
+        ctx.push();
+        ctx.assert_expr(q);
+        ctx.assert_expr(m.mk_not(m.mk_eq(m.mk_app(f, m.mk_app(g, a.get())), a)));
+        ENSURE(ctx.check() == l_false);
+        ctx.pop(1);
+    }
+
+    statistics st;
+    ctx.collect_statistics(st);
+    ENSURE(get_stat(st, "mam reused code trees") > 0);
+}
+
+// Names of fresh constants carry a counter of the manager, replace "!<digits>" by "!".
+static std::string strip_fresh_ids(std::string const& s) {
+    std::string r;
+    for (unsigned i = 0; i < s.size(); ++i) {
+        r.push_back(s[i]);
+        if (s[i] == '!')
+            while (i + 1 < s.size() && isdigit(s[i + 1]))
+                ++i;
+    }
+    return r;
+}
+
+/**
+   Check with MBQI only, and record the clauses of the main context in the
+   order they are created. The instances produced by model checking are
+   part of these clauses.
+*/
+static lbool check_mbqi(bool unsat, unsigned threads, vector<std::string> & clauses) {
+    smt_params params;
+    params.m_ematching = false;
+    params.m_mbqi_threads = threads;
+    ast_manager m;
+    reg_decl_plugins(m);
+    arith_util a(m);
+    smt::context ctx(m, params);
+
+    sort * I = a.mk_int();
+    func_decl_ref f(m.mk_func_decl(symbol("f"), 1, &I, I), m);
+    func_decl_ref g(m.mk_func_decl(symbol("g"), 1, &I, I), m);
+    func_decl_ref h(m.mk_func_decl(symbol("h"), 1, &I, I), m);
+    expr_ref x(m.mk_var(0, I), m);
+    expr_ref zero(a.mk_int(0), m), one(a.mk_int(1), m);
+    symbol name("x");
+    auto mk_forall = [&](expr * body) { return expr_ref(m.mk_forall(1, &I, &name, body), m); };
+    ctx.assert_expr(mk_forall(a.mk_ge(m.mk_app(f, x.get()), zero)));
+    ctx.assert_expr(mk_forall(a.mk_ge(m.mk_app(g, x.get()), m.mk_app(f, x.get()))));
+    ctx.assert_expr(mk_forall(m.mk_implies(a.mk_gt(x, a.mk_int(10)), m.mk_eq(m.mk_app(h, x.get()), one))));
+    expr_ref c1(m.mk_const(symbol("c1"), I), m), c2(m.mk_const(symbol("c2"), I), m), c3(m.mk_const(symbol("c3"), I), m);
+    ctx.assert_expr(a.mk_lt(m.mk_app(g, c1.get()), a.mk_int(5)));
+    ctx.assert_expr(m.mk_eq(m.mk_app(h, c2.get()), a.mk_int(2)));
+    if (unsat)
+        ctx.assert_expr(a.mk_gt(m.mk_app(f, c3.get()), m.mk_app(g, c3.get())));
+
+    user_propagator::on_clause_eh_t on_clause = [&](void*, expr*, unsigned, unsigned const*, unsigned n, expr* const* lits) {
+        std::ostringstream strm;
+        for (unsigned i = 0; i < n; ++i)
+            strm << mk_pp(lits[i], m) << " ";
+        clauses.push_back(strip_fresh_ids(strm.str()));
+    };
+    ctx.register_on_clause(nullptr, on_clause);
+    return ctx.check();
+}
+
+static void tst_mbqi_threads(bool unsat) {
+    vector<std::string> clauses1, clauses4;
+    lbool r1 = check_mbqi(unsat, 1, clauses1);
+    lbool r4 = check_mbqi(unsat, 4, clauses4);
+    ENSURE(r1 == (unsat ? l_false : l_true));
+    ENSURE(r1 == r4);
+    ENSURE(clauses1 == clauses4);
+}
+
+// Entries come out by the integral part of the cost, then by generation, and stable otherwise.
+static void tst_qi_queue_order() {
+    typedef smt::qi_queue::entry entry;
+    svector<entry> es, tmp;
+    unsigned_vector offsets;
+    float    costs[9] = { 3.5f, 1.7f, 70.0f, 1.2f, 0.0f, 3.1f, 1.9f, 63.0f, 0.5f };
+    unsigned gens[9]  = { 0,    2,    1,     2,    4,    0,    1,    0,     100 };
+    for (unsigned i = 0; i < 9; ++i)
+        es.push_back(entry(nullptr, costs[i], gens[i]));
+    smt::qi_queue::sort_entries(es, tmp, offsets);
+    // 70 and 63 share the last cost bucket, 1.7 and 1.2 keep their relative order.
+    float    exp_costs[9] = { 0.0f, 0.5f, 1.9f, 1.7f, 1.2f, 3.5f, 3.1f, 63.0f, 70.0f };
+    unsigned exp_gens[9]  = { 4,    100,  1,    2,    2,    0,    0,    0,     1 };
+    ENSURE(es.size() == 9);
+    for (unsigned i = 0; i < 9; ++i) {
+        ENSURE(es[i].m_cost == exp_costs[i]);
+        ENSURE(es[i].m_generation == exp_gens[i]);
+    }
+}
+
+// forall x. p or x > 5 with the pattern f(x) is instantiated with 1 and 2, both instances simplify to p.
+static void tst_duplicate_instances() {
+    smt_params params;
+    params.m_mbqi = false;
+    ast_manager m;
+    reg_decl_plugins(m);
+    arith_util a(m);
+    smt::context ctx(m, params);
+
+    sort * I = a.mk_int();
+    func_decl_ref f(m.mk_func_decl(symbol("f"), 1, &I, I), m);
+    expr_ref p(m.mk_const(symbol("p"), m.mk_bool_sort()), m);
+    expr_ref x(m.mk_var(0, I), m);
+    expr_ref fx(m.mk_app(f, x.get()), m);
+    app_ref pat(m.mk_pattern(to_app(fx)), m);
+    expr * pats[1] = { pat.get() };
+    symbol name("x");
+    quantifier_ref q(m.mk_forall(1, &I, &name, m.mk_or(p, a.mk_gt(x, a.mk_int(5))), 0, symbol("px"), symbol::null, 1, pats), m);
+
+    ctx.assert_expr(q);
+    ctx.assert_expr(m.mk_not(m.mk_eq(m.mk_app(f, a.mk_int(1)), m.mk_app(f, a.mk_int(2)))));
+    ctx.assert_expr(m.mk_not(p));
+    ENSURE(ctx.check() == l_false);
+
+    statistics st;
+    ctx.collect_statistics(st);
+    ENSURE(get_stat(st, "duplicate quant instantiations") > 0);
+}
+
+void tst_smt_quantifier() {
+    tst_qi_queue_order();
+    tst_duplicate_instances();
+    tst_code_tree_reuse();
+    tst_mbqi_threads(false);
+    tst_mbqi_threads(true);
+}
@@ -19,6 +19,11 @@ Revision History:
 #include<iostream>
 #include "util/symbol.h"
 #include "util/debug.h"
+#include "util/stopwatch.h"
+#include "util/vector.h"
+#ifndef SINGLE_THREAD
+#include <thread>
+#endif
 
 static void tst1() {
     symbol s1("foo");
@@ -51,8 +56,64 @@ static void tst1() {
     ENSURE(lt(symbol("zzz"), symbol("zzzb")));
 }
 
+#ifndef SINGLE_THREAD
+/**
+   \brief Create symbols from several threads. Half of the names are shared between the threads, 
+   the other half is private to each thread. Threads must agree on the interned strings.
+*/
+static void tst_concurrent(unsigned num_threads, unsigned num_symbols, unsigned rounds) {
+    vector<ptr_vector<char const>> results(num_threads);
+    stopwatch sw;
+    sw.start();
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < num_threads; ++t) {
+        threads.push_back(std::thread([&, t]() {
+            std::string name;
+            for (unsigned r = 0; r < rounds; ++r) {
+                for (unsigned i = 0; i < num_symbols; ++i) {
+                    name = (i % 2 == 0) ? "shared!" + std::to_string(i) : "t" + std::to_string(t) + "!" + std::to_string(i);
+                    symbol s(name.c_str());
+                    if (r == 0)
+                        results[t].push_back(s.bare_str());
+                    else if (s.bare_str() != results[t][i])
+                        results[t][i] = nullptr;
+                }
+            }
+        }));
+    }
+    for (auto& th : threads)
+        th.join();
+    sw.stop();
+    for (unsigned t = 0; t < num_threads; ++t) {
+        for (unsigned i = 0; i < num_symbols; ++i) {
+            ENSURE(results[t][i] != nullptr);
+            if (i % 2 == 0) {
+                ENSURE(results[t][i] == results[0][i]);
+            }
+            else {
+                ENSURE(t == 0 || results[t][i] != results[0][i]);
+            }
+        }
+    }
+    double secs = sw.get_seconds();
+    unsigned total = num_threads * num_symbols * rounds;
+    std::cout << "threads: " << num_threads << " symbols: " << total << " time: " << secs << "s";
+    if (secs > 0)
+        std::cout << " symbols/sec: " << total / secs;
+    std::cout << "\n";
+}
+
+static void tst2() {
+    for (unsigned num_threads = 1; num_threads <= 8; num_threads *= 2)
+        tst_concurrent(num_threads, 20000, 5);
+}
+#endif
+
 void tst_symbol() {
     tst1();
+#ifndef SINGLE_THREAD
+    tst2();
+#endif
 }
 
 
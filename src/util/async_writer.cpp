@@ -0,0 +1,118 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    async_writer.cpp
+
+Abstract:
+
+    Write a byte stream to an std::ostream from a background thread.
+
+--*/
+
+#include "util/async_writer.h"
+#include "util/memory_manager.h"
+#include "util/util.h"
+#include <cstring>
+#include <chrono>
+
+#ifdef SINGLE_THREAD
+
+async_writer::async_writer(std::ostream & out, size_t capacity): m_out(out) {}
+
+async_writer::~async_writer() {
+    flush();
+}
+
+void async_writer::publish() {
+    m_out.write(m_batch.data(), m_batch.size());
+    m_bytes += m_batch.size();
+    m_batch.reset();
+}
+
+void async_writer::flush() {
+    publish();
+    m_out.flush();
+}
+
+unsigned async_writer::num_stalls() const {
+    return 0;
+}
+
+#else
+
+async_writer::async_writer(std::ostream & out, size_t capacity): 
+    m_out(out),
+    m_capacity(next_power_of_two(static_cast<unsigned>(std::max<size_t>(capacity, 1 << 16)))),
+    m_mask(m_capacity - 1) {
+    m_ring = static_cast<char*>(memory::allocate(m_capacity));
+    m_thread = std::thread([this]() { run(); });
+}
+
+async_writer::~async_writer() {
+    publish();
+    m_done.store(true, std::memory_order_release);
+    m_thread.join();
+    memory::deallocate(m_ring);
+}
+
+void async_writer::run() {
+    unsigned idle = 0;
+    while (true) {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        uint64_t tail = m_tail.load(std::memory_order_acquire);
+        if (head == tail) {
+            if (m_done.load(std::memory_order_acquire) && m_tail.load(std::memory_order_acquire) == head)
+                break;
+            // back off: spin briefly, then sleep so an idle proof stream costs no CPU
+            if (++idle < 64)
+                std::this_thread::yield();
+            else
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            continue;
+        }
+        idle = 0;
+        size_t offset = static_cast<size_t>(head & m_mask);
+        size_t n = static_cast<size_t>(std::min<uint64_t>(tail - head, m_capacity - offset));
+        m_out.write(m_ring + offset, n);
+        m_head.store(head + n, std::memory_order_release);
+    }
+    m_out.flush();
+}
+
+void async_writer::publish() {
+    char const * data = m_batch.data();
+    size_t n = m_batch.size();
+    m_bytes += n;
+    while (n > 0) {
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        uint64_t head = m_head.load(std::memory_order_acquire);
+        size_t space = m_capacity - static_cast<size_t>(tail - head);
+        if (space == 0) {
+            ++m_stalls;
+            std::this_thread::yield();
+            continue;
+        }
+        size_t offset = static_cast<size_t>(tail & m_mask);
+        size_t k = std::min(std::min(n, space), m_capacity - offset);
+        memcpy(m_ring + offset, data, k);
+        m_tail.store(tail + k, std::memory_order_release);
+        data += k;
+        n -= k;
+    }
+    m_batch.reset();
+}
+
+void async_writer::flush() {
+    publish();
+    uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    while (m_head.load(std::memory_order_acquire) != tail)
+        std::this_thread::yield();
+}
+
+unsigned async_writer::num_stalls() const {
+    return m_stalls;
+}
+
+#endif
@@ -0,0 +1,75 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    async_writer.h
+
+Abstract:
+
+    Write a byte stream to an std::ostream from a background thread.
+
+    The producer collects bytes in a private batch and publishes full
+    batches into a single-producer/single-consumer ring without taking
+    a lock. A writer thread drains the ring into the stream. The
+    producer only waits when the ring is full.
+
+    In single threaded builds bytes are written directly.
+
+--*/
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include "util/vector.h"
+#ifndef SINGLE_THREAD
+#include <thread>
+#endif
+
+class async_writer {
+    std::ostream &        m_out;
+    svector<char>         m_batch;         // owned by the producer
+#ifndef SINGLE_THREAD
+    char *                m_ring = nullptr;
+    size_t                m_capacity;
+    size_t                m_mask;
+    std::atomic<uint64_t> m_head { 0 };    // advanced by the writer thread
+    std::atomic<uint64_t> m_tail { 0 };    // advanced by the producer
+    std::atomic<bool>     m_done { false };
+    std::thread           m_thread;
+    unsigned              m_stalls = 0;
+    void run();
+#endif
+    uint64_t              m_bytes = 0;
+    void publish();
+public:
+    /**
+       \brief Create a writer with a ring of at least \c capacity bytes.
+    */
+    async_writer(std::ostream & out, size_t capacity = 1 << 22);
+    ~async_writer();
+    async_writer(async_writer const &) = delete;
+    async_writer & operator=(async_writer const &) = delete;
+
+    void write(char const * data, size_t n) {
+        m_batch.append(static_cast<unsigned>(n), data);
+        if (m_batch.size() >= (1 << 16))
+            publish();
+    }
+
+    void write(std::string const & s) { write(s.data(), s.size()); }
+
+    /**
+       \brief Block until all bytes written so far reached the stream.
+    */
+    void flush();
+
+    uint64_t num_bytes() const { return m_bytes + m_batch.size(); }
+
+    /**
+       \brief Number of times the producer found the ring full.
+    */
+    unsigned num_stalls() const;
+};
@@ -0,0 +1,95 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    mapped_file.cpp
+
+Abstract:
+
+    Read-only view of the contents of a file.
+
+--*/
+#include "util/mapped_file.h"
+#include "util/memory_manager.h"
+#include <algorithm>
+#include <fstream>
+#ifndef _WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mapped_file::mapped_file(char const * file_name) {
+#ifndef _WINDOWS
+    int fd = ::open(file_name, O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            m_size = static_cast<size_t>(st.st_size);
+            if (m_size == 0) {
+                m_open = true;
+            }
+            else {
+                void * p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+                    madvise(p, m_size, MADV_SEQUENTIAL);
+#endif
+                    m_data   = static_cast<char const *>(p);
+                    m_mapped = true;
+                    m_open   = true;
+                }
+            }
+        }
+        ::close(fd);
+        if (m_open)
+            return;
+        m_size = 0;
+    }
+#endif
+    // fall back to reading the whole file.
+    // The size is not known in advance for pipes, so the buffer grows until the end of the input.
+    std::ifstream in(file_name, std::ios::binary);
+    if (in.bad() || in.fail())
+        return;
+    char * buffer = nullptr;
+    size_t capacity = 0;
+    while (in) {
+        if (m_size == capacity) {
+            capacity = std::max(static_cast<size_t>(1 << 16), 2 * capacity);
+            void * mem = buffer ? memory::reallocate(buffer, capacity) : memory::allocate(capacity);
+            buffer = static_cast<char *>(mem);
+        }
+        in.read(buffer + m_size, capacity - m_size);
+        m_size += static_cast<size_t>(in.gcount());
+    }
+    if (in.bad() || m_size == 0) {
+        if (buffer)
+            memory::deallocate(buffer);
+        m_size = 0;
+        if (in.bad())
+            return;
+    }
+    else
+        m_data = buffer;
+    m_open = true;
+}
+
+mapped_file::~mapped_file() {
+    close();
+}
+
+void mapped_file::close() {
+    if (!m_data)
+        return;
+#ifndef _WINDOWS
+    if (m_mapped)
+        munmap(const_cast<char *>(m_data), m_size);
+    else
+#endif
+        memory::deallocate(const_cast<char *>(m_data));
+    m_data = nullptr;
+    m_size = 0;
+}
@@ -0,0 +1,39 @@
+/*++
+Copyright (c) 2024 Microsoft Corporation
+
+Module Name:
+
+    mapped_file.h
+
+Abstract:
+
+    Read-only view of the contents of a file.
+
+    Regular files are memory mapped where the platform supports it, so
+    that parsers can scan the bytes in place. Other inputs, such as pipes,
+    are read up to the end of the input into a heap buffer.
+
+--*/
+#pragma once
+
+#include <cstddef>
+
+class mapped_file {
+    char const * m_data = nullptr;
+    size_t       m_size = 0;
+    bool         m_mapped = false;
+    bool         m_open = false;
+
+    void close();
+public:
+    mapped_file(char const * file_name);
+    ~mapped_file();
+    mapped_file(mapped_file const &) = delete;
+    mapped_file & operator=(mapped_file const &) = delete;
+
+    bool is_open() const { return m_open; }
+    bool is_mapped() const { return m_mapped; }
+    char const * begin() const { return m_data; }
+    char const * end() const { return m_data + m_size; }
+    size_t size() const { return m_size; }
+};
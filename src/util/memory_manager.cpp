@@ -52,14 +52,15 @@ out_of_memory_error::out_of_memory_error():z3_error(ERR_MEMOUT) {
 }
 
 
-static DECLARE_INIT_MUTEX(g_memory_mux);
+// The global counters are only updated when a thread reconciles its local counters.
+// They are atomic so that reconciliation and the memory limit checks do not take a lock.
 static atomic<bool> g_memory_out_of_memory(false);
 static bool       g_memory_initialized       = false;
-static long long  g_memory_alloc_size        = 0;
+static atomic<long long> g_memory_alloc_size(0);
 static long long  g_memory_max_size          = 0;
-static long long  g_memory_max_used_size     = 0;
+static atomic<long long> g_memory_max_used_size(0);
 static long long  g_memory_watermark         = 0;
-static long long  g_memory_alloc_count       = 0;
+static atomic<long long> g_memory_alloc_count(0);
 static long long  g_memory_max_alloc_count   = 0;
 static bool       g_exit_when_out_of_memory  = false;
 static char const * g_out_of_memory_msg      = "ERROR: out of memory";
@@ -130,7 +131,6 @@ void memory::set_high_watermark(size_t watermark) {
 bool memory::above_high_watermark() {
     if (g_memory_watermark == 0)
         return false;
-    lock_guard lock(*g_memory_mux);
     return g_memory_watermark < g_memory_alloc_size;
 }
 
@@ -151,9 +151,6 @@ void memory::finalize(bool shutdown) {
     if (g_memory_initialized) {
         g_finalizing = true;
         mem_finalize();
-        // we leak the mutex since we need it to be always live since memory may
-        // be reinitialized again
-        //delete g_memory_mux;
         g_memory_initialized = false;
         g_finalizing = false;
 
@@ -164,23 +161,14 @@ void memory::finalize(bool shutdown) {
 }
 
 unsigned long long memory::get_allocation_size() {
-    long long r;
-    {
-        lock_guard lock(*g_memory_mux);
-        r = g_memory_alloc_size;
-    }
+    long long r = g_memory_alloc_size;
     if (r < 0)
         r = 0;
     return r;
 }
 
 unsigned long long memory::get_max_used_memory() {
-    unsigned long long r;
-    {
-        lock_guard lock(*g_memory_mux);
-        r = g_memory_max_used_size;
-    }
-    return r;
+    return g_memory_max_used_size;
 }
 
 #if defined(_WINDOWS)
@@ -251,28 +239,91 @@ static void synchronize_counters(bool allocating) {
     g_synch_counter++;
 #endif
 
-    bool out_of_mem = false;
-    bool counts_exceeded = false;
-    {
-        lock_guard lock(*g_memory_mux);
-        g_memory_alloc_size += g_memory_thread_alloc_size;
-        g_memory_alloc_count += g_memory_thread_alloc_count;
-        if (g_memory_alloc_size > g_memory_max_used_size)
-            g_memory_max_used_size = g_memory_alloc_size;
-        if (g_memory_max_size != 0 && g_memory_alloc_size > g_memory_max_size)
-            out_of_mem = true;
-        if (g_memory_max_alloc_count != 0 && g_memory_alloc_count > g_memory_max_alloc_count)
-            counts_exceeded = true;
-    }
+    long long alloc_size  = g_memory_alloc_size.fetch_add(g_memory_thread_alloc_size, std::memory_order_relaxed) + g_memory_thread_alloc_size;
+    long long alloc_count = g_memory_alloc_count.fetch_add(g_memory_thread_alloc_count, std::memory_order_relaxed) + g_memory_thread_alloc_count;
+    long long max_used = g_memory_max_used_size.load(std::memory_order_relaxed);
+    while (alloc_size > max_used && !g_memory_max_used_size.compare_exchange_weak(max_used, alloc_size, std::memory_order_relaxed))
+        ;
     g_memory_thread_alloc_size = 0;
-    if (out_of_mem && allocating) {
+    g_memory_thread_alloc_count = 0;
+    if (allocating && g_memory_max_size != 0 && alloc_size > g_memory_max_size) {
         throw_out_of_memory();
     }
-    if (counts_exceeded && allocating) {
+    if (allocating && g_memory_max_alloc_count != 0 && alloc_count > g_memory_max_alloc_count) {
         throw_alloc_counts_exceeded();
     }
 }
 
+// Small blocks released by a thread are kept in a thread local cache, bucketed by size class,
+// and handed out again by allocate on the same thread. The cache is flushed when the thread exits.
+// Blocks in the cache are not counted as allocated memory.
+#define CACHE_CLASS_BITS  3
+#define CACHE_NUM_CLASSES 32  // sizes up to 256 bytes
+#define CACHE_MAX_BLOCKS  64  // per size class
+
+struct thread_cache {
+    void *   m_free[CACHE_NUM_CLASSES];
+    unsigned m_num_free[CACHE_NUM_CLASSES];
+    bool     m_disabled;
+};
+
+thread_local thread_cache g_memory_thread_cache;
+
+struct thread_cache_flush {
+    bool m_active = false;
+    ~thread_cache_flush() {
+        thread_cache & c = g_memory_thread_cache;
+        c.m_disabled = true;
+        for (unsigned i = 0; i < CACHE_NUM_CLASSES; ++i) {
+            while (c.m_free[i]) {
+                void * p = c.m_free[i];
+                c.m_free[i] = *static_cast<void**>(p);
+#ifdef HAS_MALLOC_USABLE_SIZE
+                free(p);
+#else
+                free(static_cast<size_t*>(p) - 1);
+#endif
+            }
+            c.m_num_free[i] = 0;
+        }
+    }
+};
+
+thread_local thread_cache_flush g_memory_thread_cache_flush;
+
+// p is the address returned by allocate and sz the size of the block including the header, if any. 
+// A block is filed under the largest class it can serve. The free list is linked through the
+// first word after the header.
+static bool cache_push(void * p, size_t sz) {
+    size_t cls = sz >> CACHE_CLASS_BITS;
+    if (cls == 0 || cls > CACHE_NUM_CLASSES)
+        return false;
+    thread_cache & c = g_memory_thread_cache;
+    --cls;
+    if (c.m_disabled || c.m_num_free[cls] >= CACHE_MAX_BLOCKS)
+        return false;
+    // registers the destructor that flushes the cache at thread exit.
+    g_memory_thread_cache_flush.m_active = true;
+    *static_cast<void**>(p) = c.m_free[cls];
+    c.m_free[cls] = p;
+    c.m_num_free[cls]++;
+    return true;
+}
+
+static void * cache_pop(size_t s) {
+    size_t cls = (s + (1 << CACHE_CLASS_BITS) - 1) >> CACHE_CLASS_BITS;
+    if (cls == 0 || cls > CACHE_NUM_CLASSES)
+        return nullptr;
+    thread_cache & c = g_memory_thread_cache;
+    --cls;
+    void * r = c.m_free[cls];
+    if (r) {
+        c.m_free[cls] = *static_cast<void**>(r);
+        c.m_num_free[cls]--;
+    }
+    return r;
+}
+
 void memory::deallocate(void * p) {
 #ifdef HAS_MALLOC_USABLE_SIZE
     size_t sz      = malloc_usable_size(p);
@@ -283,7 +334,8 @@ void memory::deallocate(void * p) {
     void * real_p  = reinterpret_cast<void*>(sz_p);
 #endif
     g_memory_thread_alloc_size -= sz;
-    free(real_p);
+    if (!cache_push(p, sz))
+        free(real_p);
     if (g_memory_thread_alloc_size < -SYNCH_THRESHOLD) {
         synchronize_counters(false);
     }
@@ -298,7 +350,18 @@ void * memory::allocate(size_t s) {
     if (g_memory_thread_alloc_size > SYNCH_THRESHOLD) {
         synchronize_counters(true);
     }
-    void * r = malloc(s);
+    void * r = cache_pop(s);
+    if (r != nullptr) {
+#ifdef HAS_MALLOC_USABLE_SIZE
+        g_memory_thread_alloc_size += malloc_usable_size(r) - s;
+        return r;
+#else
+        // the block keeps the size it was allocated with.
+        g_memory_thread_alloc_size += *(static_cast<size_t*>(r) - 1) - s;
+        return r;
+#endif
+    }
+    r = malloc(s);
     if (r == nullptr) {
         throw_out_of_memory();
         return nullptr;
@@ -24,6 +24,26 @@ Revision History:
 typedef uint64_t mpn_double_digit;
 static_assert(sizeof(mpn_double_digit) == 2 * sizeof(mpn_digit), "size alignment");
 
+#define DIGIT_BITS (sizeof(mpn_digit)*8)
+#define HALF_BITS (sizeof(mpn_digit)*4)
+
+// Additions and subtractions process two digits at a time as one 64 bit limb.
+// Limbs are assembled explicitly, so the digit order does not depend on the endianness.
+typedef uint64_t mpn_limb;
+
+static inline mpn_limb to_limb(mpn_digit const * a) {
+    return static_cast<mpn_limb>(a[0]) | (static_cast<mpn_limb>(a[1]) << DIGIT_BITS);
+}
+
+static inline void from_limb(mpn_limb l, mpn_digit * c) {
+    c[0] = static_cast<mpn_digit>(l);
+    c[1] = static_cast<mpn_digit>(l >> DIGIT_BITS);
+}
+
+#if defined(__SIZEOF_INT128__) 
+#define MPN_USE_LIMB_MUL
+#endif
+
 int mpn_manager::compare(mpn_digit const * a, unsigned lnga, 
                          mpn_digit const * b, unsigned lngb) const {
     int res = 0;
@@ -57,7 +77,20 @@ bool mpn_manager::add(mpn_digit const * a, unsigned lnga,
     mpn_digit k = 0;
     mpn_digit r;
     bool c1, c2;
-    for (unsigned j = 0; j < len; j++) {
+    unsigned j = 0;
+    // two digits at a time where both operands are defined.
+    // c may be equal to a or b, so the digits are read before they are written.
+    unsigned common = std::min(lnga, lngb);
+    mpn_limb kl = 0;
+    for (; j + 1 < common; j += 2) {
+        mpn_limb u = to_limb(a + j), v = to_limb(b + j);
+        mpn_limb rl = u + v; 
+        mpn_limb sl = rl + kl;
+        kl = (rl < u) | (sl < rl);
+        from_limb(sl, c + j);
+    }
+    k = static_cast<mpn_digit>(kl);
+    for (; j < len; j++) {
         mpn_digit u_j = (j < lnga) ? a[j] : 0;
         mpn_digit v_j = (j < lngb) ? b[j] : 0;
         r = u_j + v_j; c1 = r < u_j;
@@ -81,7 +114,18 @@ bool mpn_manager::sub(mpn_digit const * a, unsigned lnga,
     mpn_digit & k = *pborrow; k = 0;
     mpn_digit r;
     bool c1, c2;
-    for (unsigned j = 0; j < len; j++) {
+    unsigned j = 0;
+    unsigned common = std::min(lnga, lngb);
+    mpn_limb kl = 0;
+    for (; j + 1 < common; j += 2) {
+        mpn_limb u = to_limb(a + j), v = to_limb(b + j);
+        mpn_limb rl = u - v; 
+        mpn_limb sl = rl - kl;
+        kl = (rl > u) | (sl > rl);
+        from_limb(sl, c + j);
+    }
+    k = static_cast<mpn_digit>(kl);
+    for (; j < len; j++) {
         mpn_digit u_j = (j < lnga) ? a[j] : 0;
         mpn_digit v_j = (j < lngb) ? b[j] : 0;
         r = u_j - v_j; c1 = r > u_j;
@@ -92,18 +136,168 @@ bool mpn_manager::sub(mpn_digit const * a, unsigned lnga,
     return true; // return k != 0?
 }
 
+#ifdef MPN_USE_LIMB_MUL
+
+/**
+   Multiplication kernels over 64 bit limbs. 
+   The products of two limbs are computed with 128 bit arithmetic.
+*/
+namespace {
+
+    typedef unsigned __int128 mpn_quad_digit;
+
+    // operands with fewer digits than this are multiplied digit by digit,
+    // for smaller operands the conversion to limbs does not pay off.
+    const unsigned LIMB_MUL_THRESHOLD = 16;
+
+    // operands with fewer limbs than this are multiplied using the schoolbook method.
+    const unsigned KARATSUBA_THRESHOLD = 32;
+
+    // c[0 .. la+lb) := a * b
+    void limb_mul_basecase(mpn_limb const * a, unsigned la, mpn_limb const * b, unsigned lb, mpn_limb * c) {
+        for (unsigned i = 0; i < la; i++)
+            c[i] = 0;
+        for (unsigned j = 0; j < lb; j++) {
+            mpn_limb v_j = b[j];
+            mpn_limb k = 0;
+            for (unsigned i = 0; i < la; i++) {
+                mpn_quad_digit t = (mpn_quad_digit)a[i] * v_j + c[i+j] + k;
+                c[i+j] = (mpn_limb)t;
+                k = (mpn_limb)(t >> 64);
+            }
+            c[j+la] = k;
+        }
+    }
+
+    // c[0 .. lc) += a[0 .. la), returns the carry out. Requires la <= lc.
+    mpn_limb limb_add_to(mpn_limb * c, unsigned lc, mpn_limb const * a, unsigned la) {
+        mpn_limb k = 0;
+        unsigned i = 0;
+        for (; i < la; i++) {
+            mpn_limb r = c[i] + a[i];
+            mpn_limb s = r + k;
+            k = (r < a[i]) | (s < r);
+            c[i] = s;
+        }
+        for (; k && i < lc; i++) {
+            c[i] += 1;
+            k = c[i] == 0;
+        }
+        return k;
+    }
+
+    // c[0 .. lc) -= a[0 .. la), returns the borrow out. Requires la <= lc.
+    mpn_limb limb_sub_from(mpn_limb * c, unsigned lc, mpn_limb const * a, unsigned la) {
+        mpn_limb k = 0;
+        unsigned i = 0;
+        for (; i < la; i++) {
+            mpn_limb r = c[i] - a[i];
+            mpn_limb s = r - k;
+            k = (r > c[i]) | (s > r);
+            c[i] = s;
+        }
+        for (; k && i < lc; i++) {
+            k = c[i] == 0;
+            c[i] -= 1;
+        }
+        return k;
+    }
+
+    void limb_mul(mpn_limb const * a, unsigned la, mpn_limb const * b, unsigned lb, mpn_limb * c);
+
+    // c[0 .. la+lb) := a * b, for la much larger than lb: multiply slices of a of length lb.
+    void limb_mul_unbalanced(mpn_limb const * a, unsigned la, mpn_limb const * b, unsigned lb, mpn_limb * c) {
+        sbuffer<mpn_limb> t(2 * lb, 0);
+        for (unsigned i = 0; i < la + lb; i++)
+            c[i] = 0;
+        for (unsigned i = 0; i < la; i += lb) {
+            unsigned n = std::min(lb, la - i);
+            limb_mul(a + i, n, b, lb, t.data());
+            limb_add_to(c + i, la + lb - i, t.data(), n + lb);
+        }
+    }
+
+    /**
+       c[0 .. la+lb) := a * b using Karatsuba's method:
+
+       a = a0 + a1*B^h, b = b0 + b1*B^h
+       a*b = z0 + ((a0 + a1)*(b0 + b1) - z0 - z2)*B^h + z2*B^2h
+       where z0 = a0*b0, z2 = a1*b1
+    */
+    void limb_mul_karatsuba(mpn_limb const * a, unsigned la, mpn_limb const * b, unsigned lb, mpn_limb * c) {
+        unsigned h = (la + 1) / 2;
+        SASSERT(h < lb && lb <= la);
+        mpn_limb const * a0 = a, * a1 = a + h;
+        mpn_limb const * b0 = b, * b1 = b + h;
+        unsigned la1 = la - h, lb1 = lb - h;
+
+        // z0 goes into c[0 .. 2h), z2 into c[2h .. la+lb)
+        limb_mul(a0, h, b0, h, c);
+        limb_mul(a1, la1, b1, lb1, c + 2*h);
+
+        sbuffer<mpn_limb> sa(h + 1, 0), sb(h + 1, 0), z1(2*h + 2, 0);
+        for (unsigned i = 0; i < h; i++) 
+            sa[i] = a0[i], sb[i] = b0[i];
+        sa[h] = limb_add_to(sa.data(), h, a1, la1);
+        sb[h] = limb_add_to(sb.data(), h, b1, lb1);
+        limb_mul(sa.data(), h + 1, sb.data(), h + 1, z1.data());
+        limb_sub_from(z1.data(), 2*h + 2, c, 2*h);
+        limb_sub_from(z1.data(), 2*h + 2, c + 2*h, la1 + lb1);
+        // z1 < B^(la+lb-h), the high limbs are zero.
+        unsigned lz1 = 2*h + 2;
+        while (lz1 > 0 && z1[lz1 - 1] == 0) 
+            --lz1;
+        limb_add_to(c + h, la + lb - h, z1.data(), lz1);
+    }
+
+    void limb_mul(mpn_limb const * a, unsigned la, mpn_limb const * b, unsigned lb, mpn_limb * c) {
+        if (la < lb) {
+            std::swap(a, b);
+            std::swap(la, lb);
+        }
+        if (lb < KARATSUBA_THRESHOLD)
+            limb_mul_basecase(a, la, b, lb, c);
+        else if (lb <= (la + 1) / 2)
+            limb_mul_unbalanced(a, la, b, lb, c);
+        else
+            limb_mul_karatsuba(a, la, b, lb, c);
+    }
+
+    void to_limbs(mpn_digit const * a, unsigned lng, sbuffer<mpn_limb> & r) {
+        r.resize((lng + 1) / 2);
+        for (unsigned i = 0; i + 1 < lng; i += 2)
+            r[i/2] = to_limb(a + i);
+        if (lng % 2 == 1)
+            r[lng/2] = a[lng - 1];
+    }
+}
+
+#endif
+
 bool mpn_manager::mul(mpn_digit const * a, unsigned lnga,
                       mpn_digit const * b, unsigned lngb,
                       mpn_digit * c) const {
     trace(a, lnga, b, lngb, "*");
+
+#ifdef MPN_USE_LIMB_MUL
+    if (lnga >= LIMB_MUL_THRESHOLD && lngb >= LIMB_MUL_THRESHOLD) {
+        sbuffer<mpn_limb> la, lb, lc;
+        to_limbs(a, lnga, la);
+        to_limbs(b, lngb, lb);
+        lc.resize(la.size() + lb.size());
+        limb_mul(la.data(), la.size(), lb.data(), lb.size(), lc.data());
+        // the product fits in lnga+lngb digits, the padding digits are zero.
+        for (unsigned i = 0; i < lnga + lngb; i++)
+            c[i] = static_cast<mpn_digit>(lc[i/2] >> (i % 2 == 0 ? 0 : DIGIT_BITS));
+        trace_nl(c, lnga+lngb);
+        return true;
+    }
+#endif
+
     // Essentially Knuth's Algorithm M. 
-    // Perhaps implement a more efficient version, see e.g., Knuth, Section 4.3.3.    
     unsigned i;
     mpn_digit k;
 
-#define DIGIT_BITS (sizeof(mpn_digit)*8)
-#define HALF_BITS (sizeof(mpn_digit)*4)
-
     for (unsigned i = 0; i < lnga; i++)
         c[i] = 0;
 
@@ -164,12 +358,12 @@ bool mpn_manager::div(mpn_digit const * numer, unsigned lnum,
             rem[i] = (i < lnum) ? numer[i] : 0;       
     }        
     else  {
-        mpn_sbuffer u, v, t_ms, t_ab;
+        mpn_sbuffer u, v, t_ab;
         unsigned d = div_normalize(numer, lnum, denom, lden, u, v);
         if (lden == 1)
             res = div_1(u, v[0], quot);
         else
-            res = div_n(u, v, quot, rem, t_ms, t_ab);
+            res = div_n(u, v, quot, rem, t_ab);
         div_unnormalize(u, v, d, rem);    
     }
 
@@ -283,7 +477,7 @@ bool mpn_manager::div_1(mpn_sbuffer & numer, mpn_digit const denom,
 
 bool mpn_manager::div_n(mpn_sbuffer & numer, mpn_sbuffer const & denom,
                         mpn_digit * quot, mpn_digit * rem,
-                        mpn_sbuffer & ms, mpn_sbuffer & ab) const {
+                        mpn_sbuffer & ab) const {
     SASSERT(denom.size() > 1);
 
     // This is essentially Knuth's Algorithm D.
@@ -292,8 +486,7 @@ bool mpn_manager::div_n(mpn_sbuffer & numer, mpn_sbuffer const & denom,
 
     SASSERT(numer.size() == m+n);
 
-    ms.resize(n+1);
-    
+
     mpn_double_digit q_hat, temp, r_hat;
     mpn_digit borrow;
 
@@ -311,9 +504,26 @@ bool mpn_manager::div_n(mpn_sbuffer & numer, mpn_sbuffer const & denom,
         SASSERT(q_hat < BASE);        
         // Replace numer[j+n]...numer[j] with 
         // numer[j+n]...numer[j] - q * (denom[n-1]...denom[0])
+        // The product is subtracted as it is computed, one digit at a time.
         mpn_digit q_hat_small = (mpn_digit)q_hat;
-        mul(&q_hat_small, 1, denom.data(), n, ms.data());
-        sub(&numer[j], n+1, ms.data(), n+1, &numer[j], &borrow);
+        mpn_digit carry = 0;
+        borrow = 0;
+        for (unsigned i = 0; i < n; i++) {
+            mpn_double_digit p = (mpn_double_digit)q_hat_small * denom[i] + carry;
+            carry = (mpn_digit)(p >> DIGIT_BITS);
+            mpn_digit u = numer[j+i];
+            mpn_digit r = u - (mpn_digit)p;
+            mpn_digit t = r - borrow;
+            borrow = (r > u) | (t > r);
+            numer[j+i] = t;
+        }
+        {
+            mpn_digit u = numer[j+n];
+            mpn_digit r = u - carry;
+            mpn_digit t = r - borrow;
+            borrow = (r > u) | (t > r);
+            numer[j+n] = t;
+        }
         quot[j] = q_hat_small;
         if (borrow) {
             quot[j]--;
@@ -324,7 +534,6 @@ bool mpn_manager::div_n(mpn_sbuffer & numer, mpn_sbuffer const & denom,
                 numer[j+i] = ab[i];
         }
         TRACE("mpn_div", tout << "q_hat=" << q_hat << " r_hat=" << r_hat;
-                         tout << " ms="; display_raw(tout, ms.data(), n);
                          tout << " new numer="; display_raw(tout, numer.data(), m+n+1);
                          tout << " borrow=" << borrow;
                          tout << std::endl; );
@@ -68,7 +68,7 @@ private:
 
     bool div_n(mpn_sbuffer & numer, mpn_sbuffer const & denom,
                mpn_digit * quot, mpn_digit * rem,
-               mpn_sbuffer & ms, mpn_sbuffer & ab) const;
+               mpn_sbuffer & ab) const;
 
     void trace(mpn_digit const * a, unsigned lnga,
                mpn_digit const * b, unsigned lngb,
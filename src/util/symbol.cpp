@@ -19,11 +19,13 @@ Revision History:
 
 #include "util/symbol.h"
 #include "util/mutex.h"
-#include "util/str_hashtable.h"
+#include "util/hash.h"
+#include "util/vector.h"
 #include "util/region.h"
 #include "util/string_buffer.h"
 #include <cstring>
 #include <optional>
+#include <atomic>
 #ifndef SINGLE_THREAD
 #include <thread>
 #endif
@@ -35,43 +37,119 @@ const symbol symbol::null;
 
 /**
    \brief Symbol table manager. It stores the symbol strings created at runtime.
+
+   Strings are kept in an open addressing table whose slots are only ever filled.
+   Lookups of existing symbols probe the table without taking the lock.
+   Insertions take the lock, and publish the new string with a release store.
+   When the table grows, the old slot array is retired but kept alive until the
+   table is destroyed, because readers may still be probing it.
 */
 namespace {
 class internal_symbol_table {
-    region        m_region; //!< Region used to store symbol strings.
-    str_hashtable m_table;  //!< Table of created symbol strings.
+    struct slot_array {
+        unsigned                  m_capacity;
+        std::atomic<char const *> m_slots[0];
+    };
+
+    region                 m_region;      //!< Region used to store symbol strings.
+    std::atomic<slot_array*> m_table;     //!< Table of created symbol strings.
+    ptr_vector<slot_array> m_retired;     //!< Tables replaced by a larger one.
+    unsigned               m_num_entries = 0;
     DECLARE_MUTEX(lock);
+
+    static slot_array * mk_slot_array(unsigned capacity) {
+        void * mem = memory::allocate(sizeof(slot_array) + capacity * sizeof(std::atomic<char const *>));
+        slot_array * r = static_cast<slot_array*>(mem);
+        r->m_capacity = capacity;
+        for (unsigned i = 0; i < capacity; ++i)
+            new (r->m_slots + i) std::atomic<char const *>(nullptr);
+        return r;
+    }
+
+    static unsigned get_hash(char const * s) {
+        return static_cast<unsigned>(reinterpret_cast<size_t const *>(s)[-1]);
+    }
+
+    static size_t get_length(char const * s) {
+        return reinterpret_cast<size_t const *>(s)[-2];
+    }
+
+    static bool matches(char const * s, char const * d, size_t l, unsigned h) {
+        return get_hash(s) == h && get_length(s) == l && memcmp(s, d, l) == 0;
+    }
+
+    /**
+       \brief Return the position of d in t, or of the empty slot where d belongs.
+    */
+    static unsigned find(slot_array const * t, char const * d, size_t l, unsigned h, char const *& result) {
+        unsigned mask = t->m_capacity - 1;
+        unsigned idx = h & mask;
+        while (true) {
+            result = t->m_slots[idx].load(std::memory_order_acquire);
+            if (!result || matches(result, d, l, h))
+                return idx;
+            idx = (idx + 1) & mask;
+        }
+    }
+
+    slot_array * expand(slot_array * t) {
+        slot_array * n = mk_slot_array(2 * t->m_capacity);
+        unsigned mask = n->m_capacity - 1;
+        for (unsigned i = 0; i < t->m_capacity; ++i) {
+            char const * s = t->m_slots[i].load(std::memory_order_relaxed);
+            if (!s)
+                continue;
+            unsigned idx = get_hash(s) & mask;
+            while (n->m_slots[idx].load(std::memory_order_relaxed))
+                idx = (idx + 1) & mask;
+            n->m_slots[idx].store(s, std::memory_order_relaxed);
+        }
+        m_retired.push_back(t);
+        m_table.store(n, std::memory_order_release);
+        return n;
+    }
     
 public:
 
-    internal_symbol_table() {
+    internal_symbol_table():
+        m_table(mk_slot_array(256)) {
         ALLOC_MUTEX(lock);
     }
 
     ~internal_symbol_table() {
+        for (slot_array * t : m_retired)
+            memory::deallocate(t);
+        memory::deallocate(m_table.load());
         DEALLOC_MUTEX(lock);
     }
 
-    char const * get_str(char const * d) {
+    char const * get_str(char const * d, size_t l) {
+        unsigned h = string_hash(d, static_cast<unsigned>(l), 17);
         const char * result;
+        find(m_table.load(std::memory_order_acquire), d, l, h, result);
+        if (result)
+            return result;
+
         lock_guard _lock(*lock);
-        str_hashtable::entry * e;
-        if (m_table.insert_if_not_there_core(d, e)) {
-            // new entry
-            size_t l   = strlen(d);
-            // store the hash-code before the string
-            size_t * mem = static_cast<size_t*>(m_region.allocate(l + 1 + sizeof(size_t)));
-            *mem = e->get_hash();
-            mem++;
-            result = reinterpret_cast<const char*>(mem);
-            memcpy(mem, d, l+1);
-            // update the entry with the new ptr.
-            e->set_data(result);
-        }
-        else {
-            result = e->get_data();
+        slot_array * t = m_table.load(std::memory_order_relaxed);
+        unsigned idx = find(t, d, l, h, result);
+        if (result)
+            return result;
+        if (2 * (m_num_entries + 1) > t->m_capacity) {
+            t = expand(t);
+            idx = find(t, d, l, h, result);
         }
-        SASSERT(m_table.contains(result));
+        // new entry
+        // store the length and the hash-code before the string
+        size_t * mem = static_cast<size_t*>(m_region.allocate(l + 1 + 2 * sizeof(size_t)));
+        mem[0] = l;
+        mem[1] = h;
+        mem += 2;
+        result = reinterpret_cast<const char*>(mem);
+        memcpy(mem, d, l);
+        reinterpret_cast<char*>(mem)[l] = 0;
+        t->m_slots[idx].store(result, std::memory_order_release);
+        ++m_num_entries;
         return result;
     }
 };
@@ -108,9 +186,9 @@ struct internal_symbol_tables {
         dealloc_vect<internal_symbol_table*>(tables, sz);
     }
 
-    char const * get_str(char const * d) {
-        auto* table = tables[string_hash(d, static_cast<unsigned>(strlen(d)), 251) % sz];
-        return table->get_str(d);
+    char const * get_str(char const * d, size_t l) {
+        auto* table = tables[string_hash(d, static_cast<unsigned>(l), 251) % sz];
+        return table->get_str(d, l);
     }
 };
 
@@ -135,11 +213,15 @@ symbol::symbol(char const * d) {
     if (d == nullptr)
         m_data = nullptr;
     else
-        m_data = g_symbol_tables->get_str(d);
+        m_data = g_symbol_tables->get_str(d, strlen(d));
+}
+
+symbol::symbol(char const * d, unsigned len) {
+    m_data = g_symbol_tables->get_str(d, len);
 }
 
 symbol & symbol::operator=(char const * d) {
-    m_data = d ? g_symbol_tables->get_str(d) : nullptr;
+    m_data = d ? g_symbol_tables->get_str(d, strlen(d)) : nullptr;
     return *this;
 }
 
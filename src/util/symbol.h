@@ -54,6 +54,11 @@ public:
         m_data(nullptr) {
     }
     explicit symbol(char const * d);
+    /**
+       \brief Create a symbol from the first len characters of d.
+       d does not need to be zero terminated.
+    */
+    symbol(char const * d, unsigned len);
     explicit symbol(const std::string & str) : symbol(str.c_str()) {}
     explicit symbol(unsigned idx):
         m_data(BOXTAGINT(char const *, idx, 1)) {
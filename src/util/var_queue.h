@@ -75,7 +75,7 @@ public:
     
     var next_var() { SASSERT(!empty()); return m_queue.erase_min(); }
     
-    var min_var() { SASSERT(!empty()); return m_queue.min_value(); }
+    var min_var() const { SASSERT(!empty()); return m_queue.min_value(); }
     
     bool more_active(var v1, var v2) const { return m_queue.less_than(v1, v2); }
 